@@ -0,0 +1,395 @@
+#include "alarm_sim.h"
+#include "alarm_execution.h"
+#include "nvs_host.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "ALARM_SIM";
+
+#define SIM_COST_INITIAL_SAMPLES 4096
+
+static int64_t sim_now_us;                  // virtual clock, microseconds since the epoch
+static time_t sim_end;
+static uint32_t sim_pending_bits;           // notifications not yet taken by a wait
+static json_writer_t *sim_timeline;
+
+// Simulated compositor: the screens posted and the virtual time their TTL ends. Like
+// the real one, it counts a TTL only while the screen is on top, so a cover moves the
+// ends back by the time it lasted.
+static bool sim_screen_shown[DISPLAY_SCREEN_COUNT];
+static int64_t sim_screen_until_us[DISPLAY_SCREEN_COUNT];  // 0 for no time to live
+static bool sim_covered;
+static int64_t sim_covered_at_us;
+
+static alarm_sim_event_t sim_events[ALARM_SIM_MAX_EVENTS];
+static size_t sim_event_count;
+static size_t sim_next_event;
+
+// Cost of each pass: real time between two waits and NVS reads in between.
+static uint32_t *sim_cost_us;
+static uint32_t *sim_cost_reads;
+static uint32_t sim_cycles;
+static uint32_t sim_cost_capacity;
+static int64_t sim_cycle_start_us;
+static uint32_t sim_cycle_start_reads;
+static uint32_t sim_wakeups_notified;
+
+static uint32_t led_rgb[3];
+
+static int64_t real_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t nvs_reads(void)
+{
+    nvs_host_stats_t stats;
+    if (nvs_host_get_stats(NVS_PARTITION, &stats) != ESP_OK) {
+        return 0;
+    }
+    return stats.reads;
+}
+
+/**
+ * @brief Starts a timeline entry: {"t":<epoch>,"local":"<YYYY-MM-DD HH:MM:SS>", ...
+ *
+ * The caller adds its members and closes the object.
+ */
+static void timeline_begin(const char *kind)
+{
+    time_t now = alarm_port_time();
+    struct tm local;
+    char stamp[32];
+    localtime_r(&now, &local);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+    json_write_object_begin(sim_timeline);
+    json_write_key(sim_timeline, "t");
+    json_write_int(sim_timeline, (int)now);
+    json_write_key(sim_timeline, "local");
+    json_write_string(sim_timeline, stamp);
+    json_write_key(sim_timeline, "event");
+    json_write_string(sim_timeline, kind);
+}
+
+//---------------------------------------------------------------------
+// alarm_sim_hw.h
+
+void set_led(uint32_t red, uint32_t green, uint32_t blue)
+{
+    if (led_rgb[0] == red && led_rgb[1] == green && led_rgb[2] == blue) {
+        return;  // the scheduler re-sends "off" on every idle pass
+    }
+    led_rgb[0] = red;
+    led_rgb[1] = green;
+    led_rgb[2] = blue;
+    timeline_begin("led");
+    json_write_key(sim_timeline, "rgb");
+    json_write_array_begin(sim_timeline);
+    for (int i = 0; i < 3; i++) {
+        json_write_int(sim_timeline, (int)led_rgb[i]);
+    }
+    json_write_array_end(sim_timeline);
+    json_write_object_end(sim_timeline);
+}
+
+void alarm_sim_chirp(uint8_t code)
+{
+    timeline_begin("chirp");
+    json_write_key(sim_timeline, "id");
+    json_write_int(sim_timeline, code);
+    json_write_object_end(sim_timeline);
+}
+
+static void timeline_display(const display_content_t *content)
+{
+    timeline_begin("display");
+    json_write_key(sim_timeline, "lines");
+    json_write_array_begin(sim_timeline);
+    for (int i = 0; i < DISPLAY_LINES; i++) {
+        json_write_string(sim_timeline, content->lines[i]);
+    }
+    json_write_array_end(sim_timeline);
+    json_write_object_end(sim_timeline);
+}
+
+esp_err_t display_show(display_screen_t screen, uint8_t priority, uint32_t ttl_ms, const display_content_t *content)
+{
+    sim_screen_shown[screen] = true;
+    sim_screen_until_us[screen] = ttl_ms ? sim_now_us + (int64_t)ttl_ms * 1000 : 0;
+    timeline_display(content);
+    return ESP_OK;
+}
+
+esp_err_t display_update(display_screen_t screen, const display_content_t *content)
+{
+    if (display_screen_active(screen)) {
+        timeline_display(content);
+    }
+    return ESP_OK;
+}
+
+esp_err_t display_remove(display_screen_t screen)
+{
+    sim_screen_shown[screen] = false;
+    return ESP_OK;
+}
+
+bool display_screen_active(display_screen_t screen)
+{
+    if (sim_screen_shown[screen] && sim_screen_until_us[screen] != 0 && !sim_covered &&
+        sim_now_us >= sim_screen_until_us[screen]) {
+        sim_screen_shown[screen] = false;
+    }
+    return sim_screen_shown[screen];
+}
+
+bool display_screen_visible(display_screen_t screen)
+{
+    return display_screen_active(screen) && !sim_covered;
+}
+
+static void set_covered(bool covered)
+{
+    if (covered == sim_covered) {
+        return;
+    }
+    if (covered) {
+        sim_covered_at_us = sim_now_us;
+    } else {
+        for (int i = 0; i < DISPLAY_SCREEN_COUNT; i++) {
+            if (sim_screen_until_us[i] > sim_covered_at_us) {
+                sim_screen_until_us[i] += sim_now_us - sim_covered_at_us;
+            }
+        }
+    }
+    sim_covered = covered;
+}
+
+//---------------------------------------------------------------------
+// alarm_port.h on the virtual clock
+
+time_t alarm_port_time(void)
+{
+    return (time_t)(sim_now_us / 1000000);
+}
+
+struct tm *alarm_port_localtime(time_t t, struct tm *local)
+{
+    return localtime_r(&t, local);
+}
+
+int64_t alarm_port_time_us(void)
+{
+    return sim_now_us;
+}
+
+esp_err_t alarm_port_start(void (*task)(void *))
+{
+    return ESP_OK;  // alarm_sim_run() drives alarm_execution_cycle() itself
+}
+
+void alarm_port_notify(uint32_t bits)
+{
+    sim_pending_bits |= bits;
+}
+
+static void record_cycle_cost(void)
+{
+    if (sim_cycles == sim_cost_capacity) {
+        uint32_t capacity = sim_cost_capacity ? sim_cost_capacity * 2 : SIM_COST_INITIAL_SAMPLES;
+        uint32_t *us = realloc(sim_cost_us, capacity * sizeof(uint32_t));
+        if (us) {
+            sim_cost_us = us;
+        }
+        uint32_t *reads = realloc(sim_cost_reads, capacity * sizeof(uint32_t));
+        if (reads) {
+            sim_cost_reads = reads;
+        }
+        if (!us || !reads) {
+            ESP_LOGE(TAG, "Out of memory for cost samples");
+            return;
+        }
+        sim_cost_capacity = capacity;
+    }
+    sim_cost_us[sim_cycles] = (uint32_t)(real_time_us() - sim_cycle_start_us);
+    sim_cost_reads[sim_cycles] = nvs_reads() - sim_cycle_start_reads;
+    sim_cycles++;
+}
+
+static void run_event(const alarm_sim_event_t *event)
+{
+    timeline_begin("script");
+    json_write_key(sim_timeline, "action");
+    switch (event->action) {
+        case ALARM_SIM_SNOOZE:
+            json_write_string(sim_timeline, "snooze");
+            alarm_execution_snooze();
+            break;
+        case ALARM_SIM_CLOCK_SYNC:
+            json_write_string(sim_timeline, "clock_sync");
+            alarm_execution_wake();
+            break;
+        case ALARM_SIM_DELETE_REMINDER:
+            json_write_string(sim_timeline, "delete_reminder");
+            json_write_key(sim_timeline, "id");
+            json_write_int(sim_timeline, event->id);
+            delete_reminder((uint8_t)event->id);
+            break;
+        case ALARM_SIM_COVER:
+            json_write_string(sim_timeline, "cover");
+            set_covered(true);
+            break;
+        case ALARM_SIM_UNCOVER:
+            json_write_string(sim_timeline, "uncover");
+            set_covered(false);
+            break;
+    }
+    json_write_object_end(sim_timeline);
+}
+
+/**
+ * @brief Advances the virtual clock instead of blocking.
+ *
+ * Scripted events due before the timeout run on the way; if one of them notifies
+ * the scheduler, the wait ends at that event like a real task notification would.
+ */
+uint32_t alarm_port_wait(uint32_t timeout_ms)
+{
+    record_cycle_cost();
+
+    int64_t deadline_us = sim_now_us + (int64_t)(timeout_ms > 0 ? timeout_ms : 1) * 1000;
+    int64_t end_us = (int64_t)sim_end * 1000000;
+    while (sim_pending_bits == 0 && sim_next_event < sim_event_count) {
+        int64_t at_us = (int64_t)sim_events[sim_next_event].at * 1000000;
+        if (at_us > deadline_us || at_us >= end_us) {
+            break;
+        }
+        if (at_us > sim_now_us) {
+            sim_now_us = at_us;
+        }
+        run_event(&sim_events[sim_next_event++]);
+    }
+    uint32_t bits = sim_pending_bits;
+    sim_pending_bits = 0;
+    if (bits) {
+        sim_wakeups_notified++;
+    } else {
+        sim_now_us = deadline_us < end_us ? deadline_us : end_us;
+    }
+
+    sim_cycle_start_us = real_time_us();
+    sim_cycle_start_reads = nvs_reads();
+    return bits;
+}
+
+//---------------------------------------------------------------------
+// Simulator control
+
+esp_err_t alarm_sim_init(time_t start, json_writer_t *timeline)
+{
+    sim_now_us = (int64_t)start * 1000000;
+    sim_timeline = timeline;
+    memset(sim_screen_shown, 0, sizeof(sim_screen_shown));
+    sim_covered = false;
+    return alarm_execution_init(NULL);
+}
+
+static int compare_events(const void *a, const void *b)
+{
+    const alarm_sim_event_t *x = a;
+    const alarm_sim_event_t *y = b;
+    return (x->at > y->at) - (x->at < y->at);
+}
+
+esp_err_t alarm_sim_add_event(const alarm_sim_event_t *event)
+{
+    if (sim_event_count == ALARM_SIM_MAX_EVENTS) {
+        return ESP_ERR_NO_MEM;
+    }
+    sim_events[sim_event_count++] = *event;
+    // Keeps the order of events scheduled for the same second.
+    for (size_t i = sim_event_count - 1; i > 0 && compare_events(&sim_events[i - 1], &sim_events[i]) > 0; i--) {
+        alarm_sim_event_t tmp = sim_events[i];
+        sim_events[i] = sim_events[i - 1];
+        sim_events[i - 1] = tmp;
+    }
+    return ESP_OK;
+}
+
+void alarm_sim_run(time_t end)
+{
+    sim_end = end;
+    sim_cycle_start_us = real_time_us();
+    sim_cycle_start_reads = nvs_reads();
+    while (alarm_port_time() < end) {
+        alarm_execution_cycle();
+    }
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, uint32_t count, uint32_t pct)
+{
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t index = (count * pct + 99) / 100;  // nearest-rank
+    return sorted[index > 0 ? index - 1 : 0];
+}
+
+uint32_t alarm_sim_passes(void)
+{
+    return sim_cycles;
+}
+
+void alarm_sim_write_cost(json_writer_t *w)
+{
+    uint32_t count = sim_cycles;
+    int64_t total_us = 0;
+    uint32_t total_reads = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        total_us += sim_cost_us[i];
+        total_reads += sim_cost_reads[i];
+    }
+    qsort(sim_cost_us, count, sizeof(uint32_t), compare_u32);
+    qsort(sim_cost_reads, count, sizeof(uint32_t), compare_u32);
+
+    json_write_object_begin(w);
+    json_write_key(w, "cycles");
+    json_write_int(w, (int)count);
+    json_write_key(w, "notified_wakeups");
+    json_write_int(w, (int)sim_wakeups_notified);
+    json_write_key(w, "total_us");
+    json_write_int(w, (int)total_us);
+    json_write_key(w, "mean_us");
+    json_write_int(w, count ? (int)(total_us / count) : 0);
+    json_write_key(w, "p50_us");
+    json_write_int(w, (int)percentile(sim_cost_us, count, 50));
+    json_write_key(w, "p99_us");
+    json_write_int(w, (int)percentile(sim_cost_us, count, 99));
+    json_write_key(w, "max_us");
+    json_write_int(w, count ? (int)sim_cost_us[count - 1] : 0);
+    json_write_key(w, "nvs_reads");
+    json_write_int(w, (int)total_reads);
+    json_write_key(w, "nvs_reads_p99");
+    json_write_int(w, (int)percentile(sim_cost_reads, count, 99));
+    json_write_key(w, "nvs_reads_max");
+    json_write_int(w, count ? (int)sim_cost_reads[count - 1] : 0);
+    json_write_object_end(w);
+}
+
+void alarm_sim_deinit(void)
+{
+    free(sim_cost_us);
+    free(sim_cost_reads);
+    sim_cost_us = NULL;
+    sim_cost_reads = NULL;
+    sim_cycles = sim_cost_capacity = 0;
+}
@@ -0,0 +1,57 @@
+#ifndef ALARM_SIM_H
+#define ALARM_SIM_H
+
+/*
+ * Virtual-clock simulator for the alarm scheduler.
+ *
+ * alarm_sim.c implements alarm_port.h on a virtual clock: alarm_port_wait() does not
+ * sleep but advances the clock to the wake-up instant (or to the next scripted
+ * event), so alarm_execution_cycle() runs a simulated year in seconds. The LED,
+ * buzzer and display stand-ins of alarm_sim_hw.h append every output to a timeline,
+ * and each pass is measured in real CPU time and NVS reads.
+ *
+ * Link with main/alarm_execution (without alarm_port.c), main/json_parser and
+ * host/nvs_host.c, built with CONFIG_IDF_TARGET_LINUX (the alarm_sim target of
+ * host/CMakeLists.txt).
+ */
+
+#include <time.h>
+#include "esp_err.h"
+#include "json_writer.h"
+
+typedef enum {
+    ALARM_SIM_SNOOZE,           // button 1 on the notification screen
+    ALARM_SIM_CLOCK_SYNC,       // what wifi_time.c does after an SNTP sync
+    ALARM_SIM_DELETE_REMINDER,  // delete reminder id
+    ALARM_SIM_COVER,            // a screen (the menu) opens over the scheduler's screens
+    ALARM_SIM_UNCOVER,          // and closes again
+} alarm_sim_action_t;
+
+typedef struct {
+    time_t at;
+    alarm_sim_action_t action;
+    int id;
+} alarm_sim_event_t;
+
+#define ALARM_SIM_MAX_EVENTS 256
+
+// Starts the virtual clock at start and initializes alarm_execution. Timeline entries
+// are written to timeline, which must be inside an open JSON array.
+esp_err_t alarm_sim_init(time_t start, json_writer_t *timeline);
+
+// Schedules a scripted event. Events may be added in any order.
+esp_err_t alarm_sim_add_event(const alarm_sim_event_t *event);
+
+// Runs scheduler passes until the virtual clock reaches end.
+void alarm_sim_run(time_t end);
+
+// Scheduler passes run so far.
+uint32_t alarm_sim_passes(void);
+
+// Writes the per-pass cost as a JSON object value.
+void alarm_sim_write_cost(json_writer_t *w);
+
+// Frees the cost samples.
+void alarm_sim_deinit(void);
+
+#endif // ALARM_SIM_H
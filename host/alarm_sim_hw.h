@@ -0,0 +1,23 @@
+#ifndef ALARM_SIM_HW_H
+#define ALARM_SIM_HW_H
+
+/*
+ * Host stand-ins for the hardware modules alarm_execution.c drives: led.h, buzzer.h
+ * and the request side of display_compositor.h. alarm_execution.h includes this
+ * file instead of them when CONFIG_IDF_TARGET_LINUX is set; host/alarm_sim.c
+ * implements the functions by appending to the simulator's firing timeline.
+ *
+ * The simulated display has no other screens: a posted screen is on top from the
+ * moment it is shown until its time to live runs out on the virtual clock.
+ */
+
+#include <stdint.h>
+#include "display_compositor.h"  // types and prototypes; host/alarm_sim.c implements them
+
+void set_led(uint32_t red, uint32_t green, uint32_t blue);
+
+// The chirp queue has no consumer on the host; chirps go straight to the timeline.
+void alarm_sim_chirp(uint8_t code);
+#define SEND_CHIRP(queue, code) alarm_sim_chirp((uint8_t)(code))
+
+#endif // ALARM_SIM_HW_H
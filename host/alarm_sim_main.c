@@ -0,0 +1,385 @@
+/*
+ * Host entry point for the alarm scheduler simulator.
+ *
+ * Built by host/CMakeLists.txt with host/alarm_sim.c, host/nvs_host.c, main/json_parser
+ * and main/alarm_execution (without alarm_port.c). Replays a scenario over simulated
+ * time and writes one JSON document with the firing timeline and the per-pass cost:
+ *   ./alarm_sim scenario.json out.json
+ * The scenarios in host/scenarios come with their expected timeline; ctest compares
+ * them (compare_timeline.cmake).
+ *
+ * Scenario format (times are local, "YYYY-MM-DD HH:MM" or "YYYY-MM-DD HH:MM:SS"):
+ *   {
+ *     "TZ": "CET-1CEST,M3.5.0,M10.5.0/3",
+ *     "Start": "2026-01-01 00:00", "Days": 365,
+ *     "Timetables": [ <timetable JSON, as stored> ],
+ *     "Tasks": [ <task JSON, as stored> ],
+ *     "Reminders": [ {"Task_ID": 1, "Option": 0, "Additional": 0,
+ *                     "Created": "2026-01-01 08:00", "Snoozed": "..." (optional)} ],
+ *     "Events": [ {"At": "2026-01-02 09:01", "Action": "snooze" | "clock_sync" |
+ *                  "delete_reminder" | "cover" | "uncover"},
+ *                 {"At": "2026-01-02 12:00", "Action": "delete_reminder", "ID": 3} ],
+ *     "Max_passes": 5000 (optional)
+ *   }
+ * Timetable 0 is the Do Not Disturb timetable, like on the device. "cover" opens a
+ * screen (the menu) over the notification until "uncover". "snooze" presses the button
+ * on the notification shown at that instant (a no-op without one), so only
+ * "delete_reminder" takes an "ID". With "Max_passes" the run fails when the scheduler
+ * needed more passes, which catches a task that spins.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json_parser.h"
+#include "nvs_host.h"
+#include "alarm_sim.h"
+
+#define SIM_PARTITION_SIZE 0x100000  // MyNvs size from partitions.csv
+
+static bool file_sink(void *ctx, const char *data, size_t len)
+{
+    return fwrite(data, 1, len, (FILE *)ctx) == len;
+}
+
+static char *read_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc((size_t)size + 1);
+    if (buf && fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        buf = NULL;
+    }
+    if (buf) {
+        buf[size] = '\0';
+    }
+    fclose(f);
+    return buf;
+}
+
+// Parses a local "YYYY-MM-DD HH:MM[:SS]" string; returns -1 if it is invalid.
+static time_t parse_local_time(const char *text)
+{
+    struct tm tm = { 0 };
+    int fields = sscanf(text, "%d-%d-%d %d:%d:%d", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min,
+                        &tm.tm_sec);
+    if (fields != 5 && fields != 6) {
+        return (time_t)-1;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    return mktime(&tm);
+}
+
+static time_t read_local_time(json_stream_t *js)
+{
+    char text[32];
+    if (json_stream_peek(js) != JSON_STREAM_STRING) {
+        json_stream_skip(js);
+        return (time_t)-1;
+    }
+    json_stream_read_string(js, text, sizeof(text));
+    return parse_local_time(text);
+}
+
+static int read_int_or(json_stream_t *js, int fallback)
+{
+    int value;
+    if (json_stream_peek(js) != JSON_STREAM_NUMBER) {
+        json_stream_skip(js);
+        return fallback;
+    }
+    return json_stream_read_int(js, &value) ? value : fallback;
+}
+
+/**
+ * @brief Stores every element of the array at text through store_json
+ *        (store_task_json or store_timetable_json), each as its own JSON text.
+ */
+static bool store_json_array(const char *text, esp_err_t (*store_json)(const char *, bool), const char *what)
+{
+    json_stream_t js;
+    json_stream_init(&js, text);
+    if (!json_stream_array_begin(&js)) {
+        fprintf(stderr, "\"%s\" must be an array\n", what);
+        return false;
+    }
+    while (json_stream_next_element(&js)) {
+        const char *begin = js.pos;
+        if (!json_stream_skip(&js)) {
+            break;
+        }
+        size_t len = (size_t)(js.pos - begin);
+        char *json = malloc(len + 1);
+        esp_err_t err = ESP_ERR_NO_MEM;
+        if (json) {
+            memcpy(json, begin, len);
+            json[len] = '\0';
+            err = store_json(json, true);
+            free(json);
+        }
+        if (err != ESP_OK) {
+            fprintf(stderr, "Failed to store %s: %s\n", what, esp_err_to_name(err));
+            return false;
+        }
+    }
+    return !js.error;
+}
+
+static bool store_reminders(const char *text)
+{
+    json_stream_t js;
+    json_stream_init(&js, text);
+    if (!json_stream_array_begin(&js)) {
+        return false;
+    }
+    while (json_stream_next_element(&js)) {
+        int task_id = -1, option = 0, additional = 0;
+        time_t created = (time_t)-1, snoozed = (time_t)-1;
+        char key[JSON_STREAM_KEY_MAX];
+        if (!json_stream_object_begin(&js)) {
+            break;
+        }
+        while (json_stream_next_key(&js, key, sizeof(key))) {
+            if (json_stream_key_equals(key, "Task_ID")) {
+                task_id = read_int_or(&js, -1);
+            } else if (json_stream_key_equals(key, "Option")) {
+                option = read_int_or(&js, 0);
+            } else if (json_stream_key_equals(key, "Additional")) {
+                additional = read_int_or(&js, 0);
+            } else if (json_stream_key_equals(key, "Created")) {
+                created = read_local_time(&js);
+            } else if (json_stream_key_equals(key, "Snoozed")) {
+                snoozed = read_local_time(&js);
+            } else {
+                json_stream_skip(&js);
+            }
+        }
+        task_t task;
+        if (load_task(task_id, &task) != ESP_OK) {
+            fprintf(stderr, "Reminder refers to unknown task %d\n", task_id);
+            return false;
+        }
+        type1_reminder_t reminder;
+        fill_type1_reminder_from_task(&task, &reminder, (uint8_t)option, (uint8_t)additional);
+        reminder.Time_Created = created;
+        reminder.Time_Snoozed = snoozed != (time_t)-1 ? snoozed : 0;
+        if (created == (time_t)-1 || store_type1_reminder(&reminder, 1) <= 0) {
+            fprintf(stderr, "Failed to store a reminder of task %d\n", task_id);
+            return false;
+        }
+    }
+    return !js.error;
+}
+
+static bool add_events(const char *text)
+{
+    static const struct {
+        const char *name;
+        alarm_sim_action_t action;
+    } actions[] = {
+        { "snooze", ALARM_SIM_SNOOZE },
+        { "clock_sync", ALARM_SIM_CLOCK_SYNC },
+        { "delete_reminder", ALARM_SIM_DELETE_REMINDER },
+        { "cover", ALARM_SIM_COVER },
+        { "uncover", ALARM_SIM_UNCOVER },
+    };
+    json_stream_t js;
+    json_stream_init(&js, text);
+    if (!json_stream_array_begin(&js)) {
+        return false;
+    }
+    while (json_stream_next_element(&js)) {
+        alarm_sim_event_t event = { .at = (time_t)-1, .id = -1 };
+        char name[24] = "";
+        char key[JSON_STREAM_KEY_MAX];
+        if (!json_stream_object_begin(&js)) {
+            break;
+        }
+        while (json_stream_next_key(&js, key, sizeof(key))) {
+            if (json_stream_key_equals(key, "At")) {
+                event.at = read_local_time(&js);
+            } else if (json_stream_key_equals(key, "ID")) {
+                event.id = read_int_or(&js, 0);
+            } else if (json_stream_key_equals(key, "Action") && json_stream_peek(&js) == JSON_STREAM_STRING) {
+                json_stream_read_string(&js, name, sizeof(name));
+            } else {
+                json_stream_skip(&js);
+            }
+        }
+        size_t i = 0;
+        while (i < sizeof(actions) / sizeof(actions[0]) && strcmp(name, actions[i].name) != 0) {
+            i++;
+        }
+        if (event.at == (time_t)-1 || i == sizeof(actions) / sizeof(actions[0])) {
+            fprintf(stderr, "Invalid event\n");
+            return false;
+        }
+        event.action = actions[i].action;
+        if ((event.action == ALARM_SIM_DELETE_REMINDER) != (event.id >= 0)) {
+            fprintf(stderr, "Event \"%s\": only delete_reminder takes an \"ID\", and it needs one\n", name);
+            return false;
+        }
+        if (alarm_sim_add_event(&event) != ESP_OK) {
+            fprintf(stderr, "Too many events (max %d)\n", ALARM_SIM_MAX_EVENTS);
+            return false;
+        }
+    }
+    return !js.error;
+}
+
+// Top-level members of a scenario. The arrays are kept as positions in the text
+// and read once the time zone is set, in the order they depend on each other.
+typedef struct {
+    char tz[64];
+    char start[32];
+    int days;
+    int max_passes;  // 0 for no limit
+    const char *timetables;
+    const char *tasks;
+    const char *reminders;
+    const char *events;
+} scenario_t;
+
+static bool read_scenario(const char *text, scenario_t *scenario)
+{
+    static const char empty_array[] = "[]";
+    memset(scenario, 0, sizeof(*scenario));
+    strcpy(scenario->tz, "UTC0");
+    scenario->days = 7;
+    scenario->timetables = scenario->tasks = scenario->reminders = scenario->events = empty_array;
+
+    json_stream_t js;
+    json_stream_init(&js, text);
+    char key[JSON_STREAM_KEY_MAX];
+    if (!json_stream_object_begin(&js)) {
+        return false;
+    }
+    while (json_stream_next_key(&js, key, sizeof(key))) {
+        const char **array = NULL;
+        if (json_stream_key_equals(key, "TZ") && json_stream_peek(&js) == JSON_STREAM_STRING) {
+            json_stream_read_string(&js, scenario->tz, sizeof(scenario->tz));
+        } else if (json_stream_key_equals(key, "Start") && json_stream_peek(&js) == JSON_STREAM_STRING) {
+            json_stream_read_string(&js, scenario->start, sizeof(scenario->start));
+        } else if (json_stream_key_equals(key, "Days")) {
+            scenario->days = read_int_or(&js, 0);
+        } else if (json_stream_key_equals(key, "Max_passes")) {
+            scenario->max_passes = read_int_or(&js, 0);
+        } else if (json_stream_key_equals(key, "Timetables")) {
+            array = &scenario->timetables;
+        } else if (json_stream_key_equals(key, "Tasks")) {
+            array = &scenario->tasks;
+        } else if (json_stream_key_equals(key, "Reminders")) {
+            array = &scenario->reminders;
+        } else if (json_stream_key_equals(key, "Events")) {
+            array = &scenario->events;
+        } else {
+            json_stream_skip(&js);
+        }
+        if (array != NULL) {
+            if (json_stream_peek(&js) != JSON_STREAM_ARRAY) {
+                fprintf(stderr, "\"%s\" must be an array\n", key);
+                return false;
+            }
+            *array = js.pos;
+            json_stream_skip(&js);
+        }
+    }
+    return !js.error;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s scenario.json out.json\n", argv[0]);
+        return 1;
+    }
+    char *text = read_file(argv[1]);
+    scenario_t scenario;
+    if (text == NULL || !read_scenario(text, &scenario)) {
+        fprintf(stderr, "Cannot read scenario %s\n", argv[1]);
+        free(text);
+        return 1;
+    }
+    setenv("TZ", scenario.tz, 1);
+    tzset();
+    time_t start = parse_local_time(scenario.start);
+    int days = scenario.days;
+    if (start == (time_t)-1 || days <= 0) {
+        fprintf(stderr, "Scenario needs \"Start\" and a positive \"Days\"\n");
+        free(text);
+        return 1;
+    }
+
+    if (nvs_host_partition_add(NVS_PARTITION, NULL, SIM_PARTITION_SIZE) != ESP_OK ||
+        nvs_flash_init_partition(NVS_PARTITION) != ESP_OK) {
+        fprintf(stderr, "Failed to set up the host NVS partition\n");
+        free(text);
+        return 1;
+    }
+    if (rfid_map_init() != ESP_OK) {  // store_task_json assigns the task's RFID tag
+        fprintf(stderr, "Failed to load the RFID map\n");
+        free(text);
+        nvs_host_deinit();
+        return 1;
+    }
+    // The scheduler logs every pass; keep a year of them out of the output.
+    esp_log_level_set("*", ESP_LOG_WARN);
+
+    bool ok = store_json_array(scenario.timetables, store_timetable_json, "Timetables") &&
+              store_json_array(scenario.tasks, store_task_json, "Tasks") &&
+              store_reminders(scenario.reminders) &&
+              add_events(scenario.events);
+    free(text);
+    FILE *out = ok ? fopen(argv[2], "w") : NULL;
+    if (out == NULL) {
+        if (ok) {
+            fprintf(stderr, "Cannot open %s\n", argv[2]);
+        }
+        nvs_host_deinit();
+        return 1;
+    }
+
+    char scratch[256];
+    json_writer_t w;
+    json_writer_init_sink(&w, scratch, sizeof(scratch), file_sink, out);
+    json_write_object_begin(&w);
+    json_write_key(&w, "start");
+    json_write_int(&w, (int)start);
+    json_write_key(&w, "days");
+    json_write_int(&w, days);
+    json_write_key(&w, "timeline");
+    json_write_array_begin(&w);
+    // Count the NVS reads of the run, not those of storing the scenario.
+    nvs_host_reset_stats();
+    if (alarm_sim_init(start, &w) != ESP_OK) {
+        fprintf(stderr, "Failed to start the alarm scheduler\n");
+        fclose(out);
+        nvs_host_deinit();
+        return 1;
+    }
+    alarm_sim_run(start + (time_t)days * 86400);
+    json_write_array_end(&w);
+    json_write_key(&w, "cost");
+    alarm_sim_write_cost(&w);
+    json_write_object_end(&w);
+    json_writer_finish(&w);
+    fputc('\n', out);
+    fclose(out);
+
+    uint32_t passes = alarm_sim_passes();
+    alarm_sim_deinit();
+    nvs_host_deinit();
+    if (scenario.max_passes > 0 && passes > (uint32_t)scenario.max_passes) {
+        fprintf(stderr, "The scheduler ran %u passes, more than the %d the scenario allows\n", (unsigned)passes,
+                scenario.max_passes);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+# Runs the alarm simulator on a scenario and compares the "timeline" of its output
+# with the expected timeline (a JSON array). The cost part of the output depends on
+# the machine and is not compared.
+#   cmake -DSIM=<alarm_sim> -DSCENARIO=<x.json> -DEXPECTED=<x.timeline.json> -DOUT=<out.json>
+#         [-DUPDATE=ON] -P compare_timeline.cmake
+# With UPDATE the expected file is rewritten from the output.
+execute_process(COMMAND ${SIM} ${SCENARIO} ${OUT} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "alarm_sim failed on ${SCENARIO} (${result})")
+endif()
+file(READ ${OUT} output)
+string(JSON timeline GET "${output}" timeline)
+
+if(UPDATE)
+    file(WRITE ${EXPECTED} "${timeline}\n")
+    message(STATUS "Wrote ${EXPECTED}")
+    return()
+endif()
+if(NOT EXISTS ${EXPECTED})
+    message(FATAL_ERROR "${EXPECTED} is missing; create it with -DUPDATE=ON and review it")
+endif()
+file(READ ${EXPECTED} expected)
+string(JSON equal EQUAL "${timeline}" "${expected}")
+if(NOT equal)
+    string(JSON actual_count LENGTH "${timeline}")
+    string(JSON expected_count LENGTH "${expected}")
+    set(i 0)
+    while(i LESS actual_count AND i LESS expected_count)
+        string(JSON a GET "${timeline}" ${i})
+        string(JSON e GET "${expected}" ${i})
+        string(JSON same EQUAL "${a}" "${e}")
+        if(NOT same)
+            message(FATAL_ERROR "Timeline differs from ${EXPECTED} at entry ${i}:\nexpected ${e}\nactual   ${a}")
+        endif()
+        math(EXPR i "${i} + 1")
+    endwhile()
+    message(FATAL_ERROR "Timeline has ${actual_count} entries, ${EXPECTED} has ${expected_count}")
+endif()
@@ -0,0 +1,250 @@
+#include "display_host.h"
+#include "clock_service.h"
+#include <stdio.h>
+#include <string.h>
+
+// SH1106 display RAM: 8 pages of 132 columns, one byte per column and page (LSB on
+// top). The 128x64 "noname" panel shows columns 2 to 129.
+#define SH1106_COLUMNS 132
+#define SH1106_PAGES 8
+#define PANEL_X_OFFSET 2
+
+static uint8_t ram[SH1106_PAGES][SH1106_COLUMNS];
+static int ram_page = 0;
+static int ram_column = 0;
+
+// Byte stream decoder. Each transfer starts with a control byte: 0x00 for commands,
+// 0x40 for display data. Commands may take argument bytes, in the same transfer or
+// (older u8x8 CAD variants) in transfers of their own.
+static bool transfer_open = false;
+static bool control_pending = false;
+static bool data_mode = false;
+static int args_pending = 0;
+
+static display_host_stats_t stats;
+
+static int command_args(uint8_t cmd)
+{
+    switch (cmd) {
+        case 0x20:  // addressing mode (ignored by the SH1106, sent by u8x8)
+        case 0x81:  // contrast
+        case 0x8D:  // charge pump
+        case 0xA8:  // multiplex ratio
+        case 0xAD:  // DC-DC control
+        case 0xD3:  // display offset
+        case 0xD5:  // clock divide
+        case 0xD9:  // pre-charge period
+        case 0xDA:  // COM pins
+        case 0xDB:  // VCOM deselect level
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void decode_command(uint8_t cmd)
+{
+    stats.command_bytes++;
+    if (args_pending > 0) {
+        args_pending--;
+        return;
+    }
+    if (cmd <= 0x0F) {
+        ram_column = (ram_column & 0xF0) | cmd;
+    } else if (cmd <= 0x1F) {
+        ram_column = (ram_column & 0x0F) | ((cmd & 0x0F) << 4);
+    } else if (cmd >= 0xB0 && cmd <= 0xB7) {
+        ram_page = cmd & 0x07;
+    } else {
+        args_pending = command_args(cmd);
+    }
+}
+
+static void decode_data(uint8_t data)
+{
+    stats.data_bytes++;
+    // The column address stops at the end of the page.
+    if (ram_column < SH1106_COLUMNS) {
+        ram[ram_page][ram_column++] = data;
+    }
+}
+
+uint8_t display_host_byte_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+    switch (msg) {
+        case U8X8_MSG_BYTE_START_TRANSFER:
+            transfer_open = true;
+            control_pending = true;
+            stats.transfers++;
+            break;
+        case U8X8_MSG_BYTE_SEND: {
+            const uint8_t *bytes = arg_ptr;
+            for (int i = 0; i < arg_int && transfer_open; i++) {
+                if (control_pending) {
+                    control_pending = false;
+                    data_mode = (bytes[i] & 0x40) != 0;
+                } else if (data_mode) {
+                    decode_data(bytes[i]);
+                } else {
+                    decode_command(bytes[i]);
+                }
+            }
+            break;
+        }
+        case U8X8_MSG_BYTE_END_TRANSFER:
+            transfer_open = false;
+            break;
+        default:
+            break;  // U8X8_MSG_BYTE_INIT, U8X8_MSG_BYTE_SET_DC
+    }
+    return 1;
+}
+
+uint8_t display_host_gpio_and_delay_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+    return 1;  // no pins and no delays on the host
+}
+
+bool display_host_pixel(int x, int y)
+{
+    if (x < 0 || y < 0 || x >= DISPLAY_HOST_WIDTH || y >= DISPLAY_HOST_HEIGHT) {
+        return false;
+    }
+    return (ram[y / 8][x + PANEL_X_OFFSET] >> (y % 8)) & 1;
+}
+
+void display_host_get_stats(display_host_stats_t *out)
+{
+    if (out) {
+        *out = stats;
+    }
+}
+
+void display_host_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+esp_err_t display_host_write_pbm(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return ESP_FAIL;
+    }
+    fprintf(f, "P1\n%d %d\n", DISPLAY_HOST_WIDTH, DISPLAY_HOST_HEIGHT);
+    for (int y = 0; y < DISPLAY_HOST_HEIGHT; y++) {
+        for (int x = 0; x < DISPLAY_HOST_WIDTH; x++) {
+            fputc(display_host_pixel(x, y) ? '1' : '0', f);
+        }
+        fputc('\n', f);
+    }
+    return fclose(f) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+// Next character of a PBM file that is not whitespace or part of a comment.
+static int pbm_getc(FILE *f)
+{
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(f)) != EOF && c != '\n') {
+            }
+        } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            return c;
+        }
+    }
+    return EOF;
+}
+
+static int pbm_getint(FILE *f)
+{
+    int c = pbm_getc(f);
+    int value = 0;
+    if (c < '0' || c > '9') {
+        return -1;
+    }
+    while (c >= '0' && c <= '9') {
+        value = value * 10 + (c - '0');
+        c = fgetc(f);
+    }
+    return value;
+}
+
+int display_host_compare_pbm(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+    int diff = -1;
+    if (pbm_getc(f) == 'P' && fgetc(f) == '1' &&
+        pbm_getint(f) == DISPLAY_HOST_WIDTH && pbm_getint(f) == DISPLAY_HOST_HEIGHT) {
+        diff = 0;
+        for (int y = 0; y < DISPLAY_HOST_HEIGHT && diff >= 0; y++) {
+            for (int x = 0; x < DISPLAY_HOST_WIDTH; x++) {
+                int c = pbm_getc(f);
+                if (c != '0' && c != '1') {
+                    diff = -1;
+                    break;
+                }
+                diff += (c == '1') != display_host_pixel(x, y);
+            }
+        }
+    }
+    fclose(f);
+    return diff;
+}
+
+//---------------------------------------------------------------------
+// clock_service.h on a set clock
+
+static time_t host_now = 0;
+
+typedef struct {
+    uint32_t mask;
+    clock_listener_fn fn;
+    void *ctx;
+} host_listener_t;
+
+static host_listener_t listeners[CLOCK_SERVICE_MAX_LISTENERS];
+static int listener_count = 0;
+
+esp_err_t clock_service_subscribe(uint32_t mask, clock_listener_fn listener, void *ctx)
+{
+    if (listener == NULL || mask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (listener_count >= CLOCK_SERVICE_MAX_LISTENERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    listeners[listener_count++] = (host_listener_t){ .mask = mask, .fn = listener, .ctx = ctx };
+    return ESP_OK;
+}
+
+time_t clock_service_now(struct tm *local)
+{
+    if (local != NULL) {
+        localtime_r(&host_now, local);
+    }
+    return host_now;
+}
+
+struct tm *clock_service_localtime(time_t t, struct tm *local)
+{
+    return localtime_r(&t, local);
+}
+
+void display_host_set_time(time_t t)
+{
+    struct tm before, after;
+    localtime_r(&host_now, &before);
+    localtime_r(&t, &after);
+    host_now = t;
+    if (before.tm_yday != after.tm_yday || before.tm_year != after.tm_year) {
+        for (int i = 0; i < listener_count; i++) {
+            if (listeners[i].mask & CLOCK_EVENT_DAY) {
+                listeners[i].fn(CLOCK_EVENT_DAY, &after, listeners[i].ctx);
+            }
+        }
+    }
+}
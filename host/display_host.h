@@ -0,0 +1,54 @@
+#ifndef DISPLAY_HOST_H
+#define DISPLAY_HOST_H
+
+/*
+ * Host backend of the display module.
+ *
+ * display.h includes this file instead of the ESP32 u8g2 HAL when
+ * CONFIG_IDF_TARGET_LINUX is set, and init_ssd1306_display() hands
+ * display_host_byte_cb() to u8g2 instead of the I2C callback. The callback decodes
+ * the SH1106 command and data stream the real bus would carry into a model of the
+ * controller RAM, so what the panel would show can be written out as a PBM image and
+ * compared with golden images. Transfers that skip tiles (display_send_frame())
+ * are decoded the same way, so the image also checks the tile diff.
+ *
+ * display_host.c also implements clock_service.h on a clock set with
+ * display_host_set_time(), so the clock screen renders the same on every run.
+ * Link it instead of main/clock/clock_service.c.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "esp_err.h"
+#include "u8g2.h"
+
+#define DISPLAY_HOST_WIDTH 128
+#define DISPLAY_HOST_HEIGHT 64
+
+typedef struct {
+    uint32_t transfers;         // I2C transfers (start to stop)
+    uint32_t command_bytes;     // controller commands, arguments included
+    uint32_t data_bytes;        // bytes written to the display RAM
+} display_host_stats_t;
+
+uint8_t display_host_byte_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+uint8_t display_host_gpio_and_delay_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+
+// Sets the wall clock the display sees. A new local date is published to the
+// CLOCK_EVENT_DAY subscribers, like clock_service_tick() does on the device.
+void display_host_set_time(time_t t);
+
+// Pixel (x, y) as the panel shows it.
+bool display_host_pixel(int x, int y);
+// Counters of the decoded bus traffic since start (or the last reset).
+void display_host_get_stats(display_host_stats_t *stats);
+void display_host_reset_stats(void);
+
+// Writes the panel as a plain PBM (P1) image.
+esp_err_t display_host_write_pbm(const char *path);
+// Number of pixels in which the panel differs from the PBM image at path, or -1 if
+// the file is missing or not a DISPLAY_HOST_WIDTH x DISPLAY_HOST_HEIGHT PBM.
+int display_host_compare_pbm(const char *path);
+
+#endif // DISPLAY_HOST_H
@@ -0,0 +1,190 @@
+/*
+ * Host entry point for the display golden-image test and frame benchmark.
+ *
+ * Built by host/CMakeLists.txt when the u8g2 sources are found (display_render, and
+ * display_render_paged with DISPLAY_PAGE_BUFFER=1), with main/display (display.c,
+ * display_frame.c, display_widgets.c) and host/display_host.c instead of
+ * main/clock/clock_service.c. Renders every screen of display.c at a fixed time into
+ * the SH1106 model of display_host.c and compares the panel with the PBM images in
+ * the given directory. A missing image is an error; images are only written with
+ * --update (the display_golden_update target), to be reviewed and committed:
+ *   ./display_render golden/            (compare)
+ *   ./display_render golden/ --update   (rewrite all images)
+ *
+ * For each screen it prints the time, bus bytes and buffer passes of the first frame,
+ * and the mean of the following frames (the clock advances by a second per frame),
+ * then the frame RAM. display_render_paged sets the RAM of the page buffer against its
+ * passes; the golden images are the same. Exits with 1 if an image is missing, if a
+ * screen differs from its image or, with the full buffer, if the panel differs from the
+ * u8g2 buffer.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "display.h"
+#include "display_host.h"
+
+#define RENDER_REPEATS 100               // frames after the first one, per screen
+#define RENDER_START_TIME 1772649015     // 2026-03-04 18:30:15 UTC
+
+typedef enum {
+    SCREEN_CLOCK_UNSET,
+    SCREEN_CLOCK,
+    SCREEN_TASK,
+    SCREEN_MESSAGE,
+    SCREEN_LIST,
+    SCREEN_DETAIL,
+} screen_t;
+
+static const char *const screen_names[] = {
+    "clock_unset", "clock", "task_type1", "message", "reminder_list", "reminder_detail",
+};
+
+static u8g2_t u8g2;
+static task_t task;
+static time_t now;
+
+static int64_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void draw_screen(screen_t screen)
+{
+    static const char *const rows[4] = { "1: Water the plants", "2: Laundry", "3: Take out the bins", NULL };
+    switch (screen) {
+        case SCREEN_CLOCK_UNSET:
+        case SCREEN_CLOCK:
+            display_idle_clock_screen(&u8g2, 0, 0);
+            break;
+        case SCREEN_TASK:
+            display_task_type1(0, 0, &task, u8g2);
+            break;
+        case SCREEN_MESSAGE:
+            display_message(&u8g2, 0, 0, "reminder stored", "succesfully", NULL, NULL, 1);
+            break;
+        case SCREEN_LIST:
+            display_list(&u8g2, 0, 0, rows, 1);
+            break;
+        case SCREEN_DETAIL:
+            display_message(&u8g2, 0, 0, "T: Water the plants", "O: in the evening", "Since: 18:02",
+                            "Snoozed 2x", 0);
+            break;
+    }
+}
+
+#if !DISPLAY_PAGE_BUFFER
+// Number of pixels in which the panel differs from the u8g2 buffer.
+static int panel_vs_buffer(void)
+{
+    const uint8_t *buffer = u8g2_GetBufferPtr(&u8g2);
+    int width = u8g2_GetBufferTileWidth(&u8g2) * 8;
+    int diff = 0;
+    for (int y = 0; y < DISPLAY_HOST_HEIGHT; y++) {
+        for (int x = 0; x < DISPLAY_HOST_WIDTH; x++) {
+            bool pixel = (buffer[(y / 8) * width + x] >> (y % 8)) & 1;
+            diff += pixel != display_host_pixel(x, y);
+        }
+    }
+    return diff;
+}
+#endif
+
+static bool run_screen(screen_t screen, const char *dir, bool update)
+{
+    display_frame_stats_t frame;
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.pbm", dir, screen_names[screen]);
+
+    int64_t start = time_us();
+    draw_screen(screen);
+    int64_t first_us = time_us() - start;
+    display_get_frame_stats(&frame);
+    uint32_t first_bytes = frame.last_frame_bytes;
+    uint32_t first_passes = frame.last_frame_passes;
+
+    bool ok = true;
+#if !DISPLAY_PAGE_BUFFER
+    int buffer_diff = panel_vs_buffer();
+    if (buffer_diff != 0) {
+        printf("%-16s panel differs from the u8g2 buffer in %d pixels\n", screen_names[screen], buffer_diff);
+        ok = false;
+    }
+#endif
+    int golden_diff = update ? 0 : display_host_compare_pbm(path);
+    if (update) {
+        if (display_host_write_pbm(path) != ESP_OK) {
+            printf("%-16s cannot write %s\n", screen_names[screen], path);
+            return false;
+        }
+        printf("%-16s wrote %s\n", screen_names[screen], path);
+    } else if (golden_diff < 0) {
+        printf("%-16s missing or unreadable %s (run with --update)\n", screen_names[screen], path);
+        ok = false;
+    } else if (golden_diff > 0) {
+        printf("%-16s differs from %s in %d pixels\n", screen_names[screen], path, golden_diff);
+        ok = false;
+    }
+
+    // Steady state: the same screen again, as the compositor redraws it.
+    uint64_t bytes = 0;
+    uint64_t passes = 0;
+    start = time_us();
+    for (int i = 0; i < RENDER_REPEATS; i++) {
+        if (screen == SCREEN_CLOCK) {
+            display_host_set_time(++now);
+        }
+        draw_screen(screen);
+        display_get_frame_stats(&frame);
+        bytes += frame.last_frame_bytes;
+        passes += frame.last_frame_passes;
+    }
+    double repeat_us = (double)(time_us() - start) / RENDER_REPEATS;
+    printf("%-16s first %6lld us %5u bytes %u passes   then %8.1f us %7.1f bytes %4.2f passes/frame\n",
+           screen_names[screen], (long long)first_us, (unsigned)first_bytes, (unsigned)first_passes, repeat_us,
+           (double)bytes / RENDER_REPEATS, (double)passes / RENDER_REPEATS);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s golden_dir [--update]\n", argv[0]);
+        return 2;
+    }
+    bool update = argc > 2 && strcmp(argv[2], "--update") == 0;
+
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    init_ssd1306_display(&u8g2);
+
+    task.Type = 1;
+    snprintf(task.Name, sizeof(task.Name), "Water the plants");
+    snprintf(task.Options[0].display_text, sizeof(task.Options[0].display_text), "in the morning");
+    snprintf(task.Options[1].display_text, sizeof(task.Options[1].display_text), "in the evening");
+    snprintf(task.Options[2].display_text, sizeof(task.Options[2].display_text), "tomorrow, before breakfast");
+    snprintf(task.Options[3].display_text, sizeof(task.Options[3].display_text), "skip");
+
+    bool ok = true;
+    for (screen_t screen = SCREEN_CLOCK_UNSET; screen <= SCREEN_DETAIL; screen++) {
+        if (screen == SCREEN_CLOCK) {
+            // The clock is unset (1970) until here.
+            now = RENDER_START_TIME;
+            display_host_set_time(now);
+        }
+        ok = run_screen(screen, argv[1], update) && ok;
+    }
+
+    display_frame_stats_t frame;
+    display_get_frame_stats(&frame);
+    printf("frame RAM: %u bytes (DISPLAY_PAGE_BUFFER %d), %u passes for %u frames\n", (unsigned)frame.ram_bytes,
+           DISPLAY_PAGE_BUFFER, (unsigned)frame.passes, (unsigned)frame.frames);
+    display_host_stats_t bus;
+    display_host_get_stats(&bus);
+    printf("bus: %u transfers, %u command bytes, %u data bytes\n", (unsigned)bus.transfers,
+           (unsigned)bus.command_bytes, (unsigned)bus.data_bytes);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+/*
+ * Fixture test of the streaming decoders parse_task_json() and parse_timetable_json()
+ * in main/json_parser: each document is decoded and compared with the struct it must
+ * give, or must be rejected. Covers case-insensitive and duplicate keys (the first
+ * one wins, like cJSON_GetObjectItem), the option count, clamping and narrowing of
+ * values, a non-string RFID_UID, and trailing or broken input. No cJSON needed:
+ *   ./json_decode_test
+ * Exits with 1 on the first difference.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "json_parser.h"
+
+#define CHECK(cond) do {                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            return false;                                                        \
+        }                                                                        \
+    } while (0)
+
+#define EMPTY_OPTION "{\"display_text\":\"\",\"Timeslots\":[],\"priority\":0,\"days_till_em\":0}"
+
+static const char task_json[] =
+    "{\"Type\":1,\"Name\":\"Water plants\",\"ID\":1,\"RFID_UID\":\"AAB4B512\",\"Options\":["
+    "{\"display_text\":\"morning 3D EM\",\"Timeslots\":[1,2],\"priority\":1,\"days_till_em\":3},"
+    "{\"display_text\":\"evening\",\"Timeslots\":[3],\"priority\":2,\"days_till_em\":2},"
+    EMPTY_OPTION "," EMPTY_OPTION "]}";
+
+static const task_t task_expected = {
+    .Type = 1, .Name = "Water plants", .ID = 1, .RFID_UID = "AAB4B512",
+    .Options = {
+        { .display_text = "morning 3D EM", .timeslot_count = 2, .timeslots = { 1, 2 },
+          .priority = 1, .days_till_em = 3 },
+        { .display_text = "evening", .timeslot_count = 1, .timeslots = { 3 },
+          .priority = 2, .days_till_em = 2 },
+    },
+};
+
+// Decodes json into a zeroed task, so untouched members compare equal.
+static bool decode_task(const char *json, task_t *task)
+{
+    memset(task, 0, sizeof(*task));
+    return parse_task_json(json, task);
+}
+
+static bool test_task_fixtures(void)
+{
+    task_t task;
+    CHECK(decode_task(task_json, &task));
+    CHECK(memcmp(&task, &task_expected, sizeof(task)) == 0);  // task_t has no padding
+
+    // Keys in any case, unknown keys (also nested) skipped.
+    CHECK(decode_task(
+        "{\"TYPE\":1,\"name\":\"Water plants\",\"Extra\":{\"a\":[1,{\"b\":null}]},\"id\":1,"
+        "\"rfid_uid\":\"AAB4B512\",\"OPTIONS\":["
+        "{\"Display_Text\":\"morning 3D EM\",\"timeslots\":[1,2],\"PRIORITY\":1,\"Days_till_EM\":3},"
+        "{\"display_text\":\"evening\",\"Timeslots\":[3],\"priority\":2,\"days_till_em\":2,\"x\":true},"
+        EMPTY_OPTION "," EMPTY_OPTION "]}", &task));
+    CHECK(memcmp(&task, &task_expected, sizeof(task)) == 0);
+
+    // Duplicate keys: the first occurrence wins, whatever the later one holds.
+    CHECK(decode_task(
+        "{\"Type\":1,\"Name\":\"Water plants\",\"ID\":1,\"id\":9,\"NAME\":\"Other\",\"RFID_UID\":\"AAB4B512\","
+        "\"Options\":["
+        "{\"display_text\":\"morning 3D EM\",\"Timeslots\":[1,2],\"priority\":1,\"priority\":7,\"days_till_em\":3},"
+        "{\"display_text\":\"evening\",\"Timeslots\":[3],\"priority\":2,\"days_till_em\":2},"
+        EMPTY_OPTION "," EMPTY_OPTION "],\"Options\":\"ignored\",\"Type\":\"ignored\"}", &task));
+    CHECK(memcmp(&task, &task_expected, sizeof(task)) == 0);
+
+    // Trailing bytes after the root object are ignored, as by cJSON_Parse.
+    char trailing[sizeof(task_json) + 32];
+    snprintf(trailing, sizeof(trailing), "%s trailing garbage", task_json);
+    CHECK(decode_task(trailing, &task));
+    CHECK(memcmp(&task, &task_expected, sizeof(task)) == 0);
+
+    // Clamping and narrowing: strings are truncated to their buffers, timeslots beyond
+    // MAX_TASK_TIMESLOTS dropped, numbers truncated toward zero and cast to the member.
+    CHECK(decode_task(
+        "{\"Type\":1.9,\"Name\":\"0123456789012345678901234567890123456789\",\"ID\":300,"
+        "\"RFID_UID\":\"0123456789ABCDEF0123\",\"Options\":["
+        "{\"display_text\":\"Caf\\u00e9 \\\"A\\\"\",\"Timeslots\":[1,2,3,4,5,6,7,8,9,10],"
+        "\"priority\":-1.5,\"days_till_em\":1e10},"
+        EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION "]}", &task));
+    CHECK(task.Type == 1);
+    CHECK(strcmp(task.Name, "01234567890123456789012345678901") == 0);
+    CHECK(task.ID == 44);
+    CHECK(strcmp(task.RFID_UID, "0123456789ABCDEF0") == 0);  // MAX_RFID_UID_LEN
+    CHECK(strcmp(task.Options[0].display_text, "Caf\xc3\xa9 \"A\"") == 0);
+    CHECK(task.Options[0].timeslot_count == MAX_TASK_TIMESLOTS);
+    CHECK(task.Options[0].timeslots[7] == 8);
+    CHECK(task.Options[0].priority == -1);
+    CHECK(task.Options[0].days_till_em == -1);  // INT_MAX, like cJSON's valueint
+
+    // A RFID_UID that is not a string leaves the UID empty.
+    static const char *const rfid_values[] = { "1234", "null", "[\"AAB4B512\"]", "{\"u\":1}" };
+    for (size_t i = 0; i < sizeof(rfid_values) / sizeof(rfid_values[0]); i++) {
+        char json[512];
+        snprintf(json, sizeof(json),
+                 "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"RFID_UID\":%s,\"Options\":["
+                 EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION "]}", rfid_values[i]);
+        CHECK(decode_task(json, &task));
+        CHECK(task.RFID_UID[0] == '\0' && task.ID == 2);
+    }
+    return true;
+}
+
+static const char *const task_rejected[] = {
+    "",
+    "[]",
+    "null",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Options\":[" EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION "]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Options\":[" EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION ","
+        EMPTY_OPTION "," EMPTY_OPTION "]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Options\":{}}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2}",
+    "{\"Type\":\"1\",\"Name\":\"N\",\"ID\":2,\"Options\":[" EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION ","
+        EMPTY_OPTION "]}",
+    "{\"Type\":1,\"Name\":7,\"ID\":2,\"Options\":[" EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION ","
+        EMPTY_OPTION "]}",
+    "{\"Type\":1,\"ID\":2,\"Options\":[" EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION "]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Options\":[{\"display_text\":\"\",\"Timeslots\":[\"1\"],"
+        "\"priority\":0,\"days_till_em\":0}," EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION "]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Options\":[{\"display_text\":\"\",\"Timeslots\":[],"
+        "\"days_till_em\":0}," EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION "]}",
+    // Broken syntax: truncated, missing comma, unbalanced quotes.
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Options\":[" EMPTY_OPTION "," EMPTY_OPTION,
+    "{\"Type\":1 \"Name\":\"N\",\"ID\":2,\"Options\":[" EMPTY_OPTION "," EMPTY_OPTION "," EMPTY_OPTION ","
+        EMPTY_OPTION "]}",
+    "{\"Type\":1,\"Name\":\"N,\"ID\":2}",
+};
+
+static bool test_task_rejected(void)
+{
+    task_t task;
+    for (size_t i = 0; i < sizeof(task_rejected) / sizeof(task_rejected[0]); i++) {
+        if (decode_task(task_rejected[i], &task)) {
+            fprintf(stderr, "task fixture %u accepted: %s\n", (unsigned)i, task_rejected[i]);
+            return false;
+        }
+    }
+    CHECK(!parse_task_json(NULL, &task));
+    return true;
+}
+
+static const char timetable_json[] =
+    "{\"Type\":1,\"Name\":\"Morning\",\"ID\":1,\"Times_active\":["
+    "{\"Start_time\":800,\"End_time\":900},{\"Start_time\":2200,\"End_time\":600,\"Days\":62}],"
+    "\"Exceptions\":[{\"Date\":20261224,\"Active\":0},{\"Date\":20261227,\"Active\":1}]}";
+
+static const timetable_t timetable_expected = {
+    .Type = 1, .Name = "Morning", .ID = 1,
+    .times_count = 2,
+    .Times_active = {
+        { .Start_time = 800, .End_time = 900, .Days = TIMETABLE_EVERY_DAY },
+        { .Start_time = 2200, .End_time = 600, .Days = 62 },
+    },
+    .exception_count = 2,
+    .Exceptions = { { .Date = 20261224, .Active = 0 }, { .Date = 20261227, .Active = 1 } },
+};
+
+// Member-wise, since timetable_t has padding.
+static bool timetable_equal(const timetable_t *a, const timetable_t *b)
+{
+    if (a->Type != b->Type || strcmp(a->Name, b->Name) != 0 || a->ID != b->ID ||
+        a->times_count != b->times_count || a->exception_count != b->exception_count) {
+        return false;
+    }
+    for (int i = 0; i < a->times_count; i++) {
+        if (a->Times_active[i].Start_time != b->Times_active[i].Start_time ||
+            a->Times_active[i].End_time != b->Times_active[i].End_time ||
+            a->Times_active[i].Days != b->Times_active[i].Days) {
+            return false;
+        }
+    }
+    for (int i = 0; i < a->exception_count; i++) {
+        if (a->Exceptions[i].Date != b->Exceptions[i].Date ||
+            a->Exceptions[i].Active != b->Exceptions[i].Active) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool decode_timetable(const char *json, timetable_t *timetable)
+{
+    memset(timetable, 0, sizeof(*timetable));
+    return parse_timetable_json(json, timetable);
+}
+
+static bool test_timetable_fixtures(void)
+{
+    timetable_t timetable;
+    CHECK(decode_timetable(timetable_json, &timetable));
+    CHECK(timetable_equal(&timetable, &timetable_expected));
+
+    CHECK(decode_timetable(
+        "{\"type\":1,\"NAME\":\"Morning\",\"Id\":1,\"times_ACTIVE\":["
+        "{\"start_time\":800,\"END_TIME\":900,\"note\":\"x\"},{\"Start_time\":2200,\"End_time\":600,\"days\":62}],"
+        "\"exceptions\":[{\"date\":20261224,\"active\":0},{\"DATE\":20261227,\"ACTIVE\":1}]} trailing", &timetable));
+    CHECK(timetable_equal(&timetable, &timetable_expected));
+
+    CHECK(decode_timetable(
+        "{\"Type\":1,\"Name\":\"Morning\",\"name\":\"Evening\",\"ID\":1,\"Times_active\":["
+        "{\"Start_time\":800,\"End_time\":900,\"End_time\":1000},"
+        "{\"Start_time\":2200,\"End_time\":600,\"Days\":62,\"Days\":1}],\"Times_active\":[],"
+        "\"Exceptions\":[{\"Date\":20261224,\"Date\":1},{\"Date\":20261227,\"Active\":1,\"Active\":0}],"
+        "\"ID\":5}", &timetable));
+    CHECK(timetable_equal(&timetable, &timetable_expected));
+
+    // Timeslots and exceptions beyond the maximum are dropped; Days keeps 7 bits,
+    // Active is 0 or 1 and defaults to 0, numbers are cast to the member.
+    CHECK(decode_timetable(
+        "{\"Type\":1,\"Name\":\"Full\",\"ID\":4,\"Times_active\":["
+        "{\"Start_time\":70000,\"End_time\":100,\"Days\":255},{\"Start_time\":1,\"End_time\":2},"
+        "{\"Start_time\":3,\"End_time\":4},{\"Start_time\":5,\"End_time\":6},{\"Start_time\":7,\"End_time\":8},"
+        "{\"Start_time\":9,\"End_time\":10},{\"Start_time\":11,\"End_time\":12},{\"Start_time\":13,\"End_time\":14},"
+        "{\"Start_time\":15,\"End_time\":16}],\"Exceptions\":["
+        "{\"Date\":20260101},{\"Date\":20260102,\"Active\":5},{\"Date\":20260103},{\"Date\":20260104},"
+        "{\"Date\":20260105}]}", &timetable));
+    CHECK(timetable.times_count == MAX_TIMESLOTS);
+    CHECK(timetable.Times_active[0].Start_time == (uint16_t)70000 && timetable.Times_active[0].Days == 0x7F);
+    CHECK(timetable.Times_active[7].Start_time == 13 && timetable.Times_active[7].End_time == 14);
+    CHECK(timetable.exception_count == MAX_TIMETABLE_EXCEPTIONS);
+    CHECK(timetable.Exceptions[0].Active == 0 && timetable.Exceptions[1].Active == 1);
+    CHECK(timetable.Exceptions[3].Date == 20260104);
+
+    // Exceptions are optional.
+    CHECK(decode_timetable("{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":[]}", &timetable));
+    CHECK(timetable.times_count == 0 && timetable.exception_count == 0);
+    return true;
+}
+
+static const char *const timetable_rejected[] = {
+    "",
+    "[]",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":{}}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":[{\"Start_time\":800}]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":[800]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":[{\"Start_time\":800,\"End_time\":900,\"Days\":\"x\"}]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":[],\"Exceptions\":{}}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":[],\"Exceptions\":[{\"Active\":1}]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":\"2\",\"Times_active\":[]}",
+    "{\"Name\":\"N\",\"ID\":2,\"Times_active\":[]}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":[{\"Start_time\":800,\"End_time\":900}",
+    "{\"Type\":1,\"Name\":\"N\",\"ID\":2,\"Times_active\":[],}",
+};
+
+static bool test_timetable_rejected(void)
+{
+    timetable_t timetable;
+    for (size_t i = 0; i < sizeof(timetable_rejected) / sizeof(timetable_rejected[0]); i++) {
+        if (decode_timetable(timetable_rejected[i], &timetable)) {
+            fprintf(stderr, "timetable fixture %u accepted: %s\n", (unsigned)i, timetable_rejected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void)
+{
+    if (!test_task_fixtures() || !test_task_rejected() || !test_timetable_fixtures() ||
+        !test_timetable_rejected()) {
+        return 1;
+    }
+    printf("JSON decode fixtures OK\n");
+    return 0;
+}
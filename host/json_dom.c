@@ -0,0 +1,255 @@
+#include "json_dom.h"
+#include "cJSON.h"
+
+static const char *TAG = "JSON_DOM";
+
+/**
+ * @brief cJSON DOM version of parse_task_json.
+ *
+ * Builds the full cJSON tree before copying the fields.
+ */
+bool parse_task_json_dom(const char *json_str, task_t *task)
+{
+    if (!json_str || !task) {
+        ESP_LOGE(TAG, "Invalid input to parse_task_json_dom");
+        return false;
+    }
+    cJSON *root = cJSON_Parse(json_str);
+    if (!root) {
+        ESP_LOGE(TAG, "Failed to parse task JSON string");
+        return false;
+    }
+
+    // Parse "Type"
+    cJSON *type = cJSON_GetObjectItem(root, "Type");
+    if (cJSON_IsNumber(type))
+        task->Type = (uint8_t)type->valueint;
+    else {
+        ESP_LOGE(TAG, "Missing or invalid 'Type'");
+        cJSON_Delete(root);
+        return false;
+    }
+
+    // Parse "Name"
+    cJSON *name = cJSON_GetObjectItem(root, "Name");
+    if (cJSON_IsString(name)) {
+        strncpy(task->Name, name->valuestring, MAX_TASK_NAME_LEN);
+        task->Name[MAX_TASK_NAME_LEN] = '\0';
+    } else {
+        ESP_LOGE(TAG, "Missing or invalid 'Name'");
+        cJSON_Delete(root);
+        return false;
+    }
+
+    // Parse "ID"
+    cJSON *id = cJSON_GetObjectItem(root, "ID");
+    if (cJSON_IsNumber(id))
+        task->ID = (uint8_t)id->valueint;
+    else {
+        ESP_LOGE(TAG, "Missing or invalid 'ID'");
+        cJSON_Delete(root);
+        return false;
+    }
+
+    // Parse "RFID_UID"
+    cJSON *rfid = cJSON_GetObjectItem(root, "RFID_UID");
+    if (cJSON_IsString(rfid)) {
+        strncpy(task->RFID_UID, rfid->valuestring, MAX_RFID_UID_LEN);
+        task->RFID_UID[MAX_RFID_UID_LEN] = '\0';
+    } else {
+        // If missing, set to empty string
+        task->RFID_UID[0] = '\0';
+    }
+
+    // Parse "Options" array. Expect exactly 4.
+    cJSON *options = cJSON_GetObjectItem(root, "Options");
+    if (!cJSON_IsArray(options) || (cJSON_GetArraySize(options) != TASK_MAX_OPTIONS)) {
+        ESP_LOGE(TAG, "'Options' must be an array of exactly %d items", TASK_MAX_OPTIONS);
+        cJSON_Delete(root);
+        return false;
+    }
+
+    for (int i = 0; i < TASK_MAX_OPTIONS; i++) {
+        cJSON *option = cJSON_GetArrayItem(options, i);
+        if (!option) {
+            ESP_LOGE(TAG, "Missing option at index %d", i);
+            cJSON_Delete(root);
+            return false;
+        }
+
+        // Parse "display_text"
+        cJSON *disp = cJSON_GetObjectItem(option, "display_text");
+        if (cJSON_IsString(disp)) {
+            strncpy(task->Options[i].display_text, disp->valuestring, MAX_OPTION_DISPLAY_LEN);
+            task->Options[i].display_text[MAX_OPTION_DISPLAY_LEN] = '\0';
+        } else {
+            ESP_LOGE(TAG, "Missing or invalid 'display_text' in option %d", i);
+            cJSON_Delete(root);
+            return false;
+        }
+
+        // Parse "Timeslots" array (can be empty)
+        cJSON *ts_array = cJSON_GetObjectItem(option, "Timeslots");
+        if (ts_array && cJSON_IsArray(ts_array)) {
+            int ts_count = cJSON_GetArraySize(ts_array);
+            if (ts_count > MAX_TASK_TIMESLOTS)
+                ts_count = MAX_TASK_TIMESLOTS;
+            task->Options[i].timeslot_count = (uint8_t)ts_count;
+            for (int j = 0; j < ts_count; j++) {
+                cJSON *ts_item = cJSON_GetArrayItem(ts_array, j);
+                if (cJSON_IsNumber(ts_item))
+                    task->Options[i].timeslots[j] = (uint8_t)ts_item->valueint;
+                else {
+                    ESP_LOGE(TAG, "Invalid timeslot in option %d index %d", i, j);
+                    cJSON_Delete(root);
+                    return false;
+                }
+            }
+        } else {
+            // if not present, set count to 0.
+            task->Options[i].timeslot_count = 0;
+        }
+
+        // Parse "priority"
+        cJSON *priority = cJSON_GetObjectItem(option, "priority");
+        if (cJSON_IsNumber(priority))
+            task->Options[i].priority = (int8_t)priority->valueint;
+        else {
+            ESP_LOGE(TAG, "Missing or invalid 'priority' in option %d", i);
+            cJSON_Delete(root);
+            return false;
+        }
+
+        // Parse "days_till_em"
+        cJSON *days = cJSON_GetObjectItem(option, "days_till_em");
+        if (cJSON_IsNumber(days))
+            task->Options[i].days_till_em = (int8_t)days->valueint;
+        else {
+            ESP_LOGE(TAG, "Missing or invalid 'days_till_em' in option %d", i);
+            cJSON_Delete(root);
+            return false;
+        }
+    }
+
+    cJSON_Delete(root);
+    return true;
+}
+
+/**
+ * @brief cJSON DOM version of parse_timetable_json.
+ *
+ * Builds the full cJSON tree before copying the fields.
+ */
+bool parse_timetable_json_dom(const char *json_str, timetable_t *timetable)
+{
+    // Validate input pointers.
+    if (!json_str || !timetable) {
+        ESP_LOGE(TAG, "Invalid input: json_str or timetable pointer is NULL");
+        return false;
+    }
+
+    // Parse the JSON string.
+    cJSON *root = cJSON_Parse(json_str);
+    if (!root) {
+        ESP_LOGE(TAG, "Failed to parse JSON string");
+        return false;
+    }
+
+    // Get the "Type" field.
+    cJSON *type = cJSON_GetObjectItem(root, "Type");
+    if (cJSON_IsNumber(type))
+        timetable->Type = (uint8_t)type->valueint;
+    else {
+        ESP_LOGE(TAG, "Invalid or missing 'Type' field in JSON");
+        cJSON_Delete(root);
+        return false;
+    }
+
+    // Get the "Name" field.
+    cJSON *name = cJSON_GetObjectItem(root, "Name");
+    if (cJSON_IsString(name)) {
+        strncpy(timetable->Name, name->valuestring, MAX_NAME_LEN);
+        timetable->Name[MAX_NAME_LEN] = '\0';  // Ensure null termination.
+    } else {
+        ESP_LOGE(TAG, "Invalid or missing 'Name' field in JSON");
+        cJSON_Delete(root);
+        return false;
+    }
+
+    // Get the "ID" field.
+    cJSON *id = cJSON_GetObjectItem(root, "ID");
+    if (cJSON_IsNumber(id))
+        timetable->ID = (uint8_t)id->valueint;
+    else {
+        ESP_LOGE(TAG, "Invalid or missing 'ID' field in JSON");
+        cJSON_Delete(root);
+        return false;
+    }
+
+    // Get the "Times_active" array.
+    cJSON *times_active = cJSON_GetObjectItem(root, "Times_active");
+    if (cJSON_IsArray(times_active)) {
+        int slot_count = cJSON_GetArraySize(times_active);
+        if (slot_count > MAX_TIMESLOTS)
+            slot_count = MAX_TIMESLOTS;
+        timetable->times_count = (uint8_t)slot_count;
+
+        // Iterate through each timeslot object.
+        for (int i = 0; i < slot_count; i++) {
+            cJSON *slot = cJSON_GetArrayItem(times_active, i);
+            if (slot) {
+                cJSON *start_time = cJSON_GetObjectItem(slot, "Start_time");
+                cJSON *end_time = cJSON_GetObjectItem(slot, "End_time");
+                cJSON *days = cJSON_GetObjectItem(slot, "Days");
+                if (cJSON_IsNumber(start_time) && cJSON_IsNumber(end_time) &&
+                    (days == NULL || cJSON_IsNumber(days))) {
+                    timetable->Times_active[i].Start_time = (uint16_t)start_time->valueint;
+                    timetable->Times_active[i].End_time = (uint16_t)end_time->valueint;
+                    timetable->Times_active[i].Days = days ? (uint8_t)(days->valueint & 0x7F) : TIMETABLE_EVERY_DAY;
+                } else {
+                    ESP_LOGE(TAG, "Invalid or missing 'Start_time' or 'End_time' in timeslot %d", i);
+                    cJSON_Delete(root);
+                    return false;
+                }
+            } else {
+                ESP_LOGE(TAG, "Missing timeslot at index %d", i);
+                cJSON_Delete(root);
+                return false;
+            }
+        }
+    } else {
+        ESP_LOGE(TAG, "Invalid or missing 'Times_active' array in JSON");
+        cJSON_Delete(root);
+        return false;
+    }
+
+    // Optional "Exceptions" array.
+    timetable->exception_count = 0;
+    cJSON *exceptions = cJSON_GetObjectItem(root, "Exceptions");
+    if (exceptions != NULL) {
+        if (!cJSON_IsArray(exceptions)) {
+            ESP_LOGE(TAG, "Invalid 'Exceptions' array in JSON");
+            cJSON_Delete(root);
+            return false;
+        }
+        int exception_count = cJSON_GetArraySize(exceptions);
+        if (exception_count > MAX_TIMETABLE_EXCEPTIONS)
+            exception_count = MAX_TIMETABLE_EXCEPTIONS;
+        for (int i = 0; i < exception_count; i++) {
+            cJSON *exception = cJSON_GetArrayItem(exceptions, i);
+            cJSON *date = cJSON_GetObjectItem(exception, "Date");
+            cJSON *active = cJSON_GetObjectItem(exception, "Active");
+            if (!cJSON_IsNumber(date) || (active != NULL && !cJSON_IsNumber(active))) {
+                ESP_LOGE(TAG, "Invalid or missing 'Date' in exception %d", i);
+                cJSON_Delete(root);
+                return false;
+            }
+            timetable->Exceptions[i].Date = (uint32_t)date->valueint;
+            timetable->Exceptions[i].Active = active ? active->valueint != 0 : 0;
+        }
+        timetable->exception_count = (uint8_t)exception_count;
+    }
+
+    cJSON_Delete(root);
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef JSON_DOM_H
+#define JSON_DOM_H
+
+/*
+ * cJSON DOM decoders for tasks and timetables, the way json_parser decoded them
+ * before the streaming decoders (json_stream). The firmware no longer links cJSON;
+ * these are kept on the host as the reference for the decoder benchmark.
+ */
+
+#include <stdbool.h>
+#include "json_parser.h"
+
+// Same as parse_task_json, but goes through a cJSON DOM.
+bool parse_task_json_dom(const char *json_str, task_t *task);
+
+// Same as parse_timetable_json, but goes through a cJSON DOM.
+bool parse_timetable_json_dom(const char *json_str, timetable_t *timetable);
+
+#endif // JSON_DOM_H
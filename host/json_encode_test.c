@@ -0,0 +1,245 @@
+/*
+ * Golden-string test of the JSON output of main/json_parser: json_writer, task_to_json(),
+ * timetable_to_json() and export_config_json() must produce these exact texts, which
+ * are what cJSON_PrintUnformatted printed for the same documents (escaping, %d numbers,
+ * member order), so fingerprints of stored JSON stay valid. No cJSON needed:
+ *   ./json_encode_test /tmp/json_encode_test.bin
+ * The partition file holds the configuration exported by export_config_json().
+ * Exits with 1 on the first difference.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "json_parser.h"
+#include "nvs_host.h"
+
+#define TEST_PARTITION_SIZE (16 * 4096)
+
+#define CHECK(cond) do {                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            return false;                                                        \
+        }                                                                        \
+    } while (0)
+
+// Compares text with golden and prints both on a difference.
+static bool same_text(const char *text, const char *golden)
+{
+    if (text == NULL || strcmp(text, golden) != 0) {
+        fprintf(stderr, "got:      %s\nexpected: %s\n", text ? text : "(null)", golden);
+        return false;
+    }
+    return true;
+}
+
+typedef struct {
+    char text[2048];
+    size_t len;
+    int chunks;
+    int fail_at;            // chunk the sink refuses, 0 = none
+} collect_t;
+
+static bool collect_sink(void *ctx, const char *data, size_t len)
+{
+    collect_t *out = ctx;
+    if (++out->chunks == out->fail_at || out->len + len >= sizeof(out->text)) {
+        return false;
+    }
+    memcpy(out->text + out->len, data, len);
+    out->len += len;
+    out->text[out->len] = '\0';
+    return true;
+}
+
+// Every value kind, nested containers and the strings cJSON escapes: quote, backslash,
+// the short escapes, other control bytes as lower-case \u00xx; '/', DEL and UTF-8 as is.
+static void write_sample(json_writer_t *w)
+{
+    json_write_object_begin(w);
+    json_write_key(w, "s");
+    json_write_string(w, "q\"b\\s/ \b\f\n\r\t \x01\x1f\x7f caf\xc3\xa9");
+    json_write_key(w, "n");
+    json_write_array_begin(w);
+    json_write_int(w, 0);
+    json_write_int(w, -1);
+    json_write_int(w, INT_MAX);
+    json_write_int(w, INT_MIN);
+    json_write_array_end(w);
+    json_write_key(w, "e");
+    json_write_array_begin(w);
+    json_write_object_begin(w);
+    json_write_object_end(w);
+    json_write_array_begin(w);
+    json_write_array_end(w);
+    json_write_string(w, NULL);
+    json_write_array_end(w);
+    json_write_key(w, "k\"\n");
+    json_write_string(w, "");
+    json_write_object_end(w);
+}
+
+static const char sample_golden[] =
+    "{\"s\":\"q\\\"b\\\\s/ \\b\\f\\n\\r\\t \\u0001\\u001f\x7f caf\xc3\xa9\","
+    "\"n\":[0,-1,2147483647,-2147483648],\"e\":[{},[],\"\"],\"k\\\"\\n\":\"\"}";
+
+static bool test_writer(void)
+{
+    char buf[256];
+    json_writer_t w;
+    json_writer_init_buffer(&w, buf, sizeof(buf));
+    write_sample(&w);
+    CHECK(json_writer_finish(&w) == strlen(sample_golden));
+    CHECK(same_text(buf, sample_golden));
+
+    // NULL buffer: exact length only. Short buffer: truncated and terminated.
+    json_writer_init_buffer(&w, NULL, 0);
+    write_sample(&w);
+    CHECK(json_writer_finish(&w) == strlen(sample_golden));
+    char small[10];
+    json_writer_init_buffer(&w, small, sizeof(small));
+    write_sample(&w);
+    CHECK(json_writer_finish(&w) == strlen(sample_golden));
+    CHECK(memcmp(small, sample_golden, sizeof(small) - 1) == 0 && small[sizeof(small) - 1] == '\0');
+
+    // Sink mode gives the same text whatever the chunk size, and stops when refused.
+    for (size_t scratch_size = 1; scratch_size <= 64; scratch_size *= 4) {
+        char scratch[64];
+        collect_t out = { .len = 0 };
+        json_writer_init_sink(&w, scratch, scratch_size, collect_sink, &out);
+        write_sample(&w);
+        CHECK(json_writer_finish(&w) == strlen(sample_golden) && !w.error);
+        CHECK(same_text(out.text, sample_golden));
+    }
+    char scratch[8];
+    collect_t out = { .fail_at = 2 };
+    json_writer_init_sink(&w, scratch, sizeof(scratch), collect_sink, &out);
+    write_sample(&w);
+    json_writer_finish(&w);
+    CHECK(w.error && out.chunks == 2 && out.len == sizeof(scratch));
+    return true;
+}
+
+static task_t test_task(void)
+{
+    task_t task;
+    memset(&task, 0, sizeof(task));
+    task.Type = 1;
+    task.ID = 255;
+    snprintf(task.Name, sizeof(task.Name), "Water \"the\" plants\\");
+    snprintf(task.RFID_UID, sizeof(task.RFID_UID), "AAB4B512");
+    snprintf(task.Options[0].display_text, sizeof(task.Options[0].display_text), "morning\t3D");
+    task.Options[0].timeslot_count = 2;
+    task.Options[0].timeslots[0] = 1;
+    task.Options[0].timeslots[1] = 16;
+    task.Options[0].priority = 1;
+    task.Options[0].days_till_em = 3;
+    task.Options[1].priority = -1;
+    task.Options[1].days_till_em = -128;
+    return task;
+}
+
+static const char task_golden[] =
+    "{\"Type\":1,\"Name\":\"Water \\\"the\\\" plants\\\\\",\"ID\":255,\"RFID_UID\":\"AAB4B512\","
+    "\"Options\":[{\"display_text\":\"morning\\t3D\",\"Timeslots\":[1,16],\"priority\":1,\"days_till_em\":3},"
+    "{\"display_text\":\"\",\"Timeslots\":[],\"priority\":-1,\"days_till_em\":-128},"
+    "{\"display_text\":\"\",\"Timeslots\":[],\"priority\":0,\"days_till_em\":0},"
+    "{\"display_text\":\"\",\"Timeslots\":[],\"priority\":0,\"days_till_em\":0}]}";
+
+static timetable_t test_timetable(bool extended)
+{
+    timetable_t timetable;
+    memset(&timetable, 0, sizeof(timetable));
+    timetable.Type = 1;
+    timetable.ID = 3;
+    snprintf(timetable.Name, sizeof(timetable.Name), extended ? "Night/Weekdays" : "Morning");
+    timetable.times_count = 2;
+    timetable.Times_active[0] = (timeslot_t){ .Start_time = 800, .End_time = 900 };
+    timetable.Times_active[1] = (timeslot_t){ .Start_time = 2200, .End_time = 600 };
+    if (extended) {
+        timetable.Times_active[1].Days = 62;
+        timetable.exception_count = 2;
+        timetable.Exceptions[0] = (timetable_exception_t){ .Date = 20261224, .Active = 0 };
+        timetable.Exceptions[1] = (timetable_exception_t){ .Date = 20261227, .Active = 1 };
+    }
+    return timetable;
+}
+
+// A daily timetable without exceptions keeps the text of the old cJSON version.
+static const char timetable_golden[] =
+    "{\"Type\":1,\"Name\":\"Morning\",\"ID\":3,\"Times_active\":["
+    "{\"Start_time\":800,\"End_time\":900},{\"Start_time\":2200,\"End_time\":600}]}";
+
+static const char timetable_extended_golden[] =
+    "{\"Type\":1,\"Name\":\"Night/Weekdays\",\"ID\":3,\"Times_active\":["
+    "{\"Start_time\":800,\"End_time\":900},{\"Start_time\":2200,\"End_time\":600,\"Days\":62}],"
+    "\"Exceptions\":[{\"Date\":20261224,\"Active\":0},{\"Date\":20261227,\"Active\":1}]}";
+
+static bool test_records(void)
+{
+    task_t task = test_task();
+    char *json = task_to_json(&task);
+    bool same = same_text(json, task_golden);
+    free(json);
+    CHECK(same);
+    CHECK(task_to_json_buf(&task, NULL, 0) == strlen(task_golden));
+
+    timetable_t timetable = test_timetable(false);
+    json = timetable_to_json(&timetable);
+    same = same_text(json, timetable_golden);
+    free(json);
+    CHECK(same);
+
+    timetable = test_timetable(true);
+    json = timetable_to_json(&timetable);
+    same = same_text(json, timetable_extended_golden);
+    free(json);
+    CHECK(same);
+    return true;
+}
+
+static bool test_export(const char *path)
+{
+    remove(path);
+    CHECK(nvs_host_partition_add(NVS_PARTITION, path, TEST_PARTITION_SIZE) == ESP_OK);
+    CHECK(nvs_flash_init_partition(NVS_PARTITION) == ESP_OK);
+    CHECK(rfid_map_init() == ESP_OK);  // store_task maps the task's RFID_UID
+
+    collect_t out = { .len = 0 };
+    CHECK(export_config_json(collect_sink, &out) == ESP_OK);
+    CHECK(same_text(out.text, "{\"Timetables\":[],\"Tasks\":[]}"));
+
+    CHECK(store_timetable_json(timetable_extended_golden, true) == ESP_OK);
+    CHECK(store_timetable_json("{\"Type\":1,\"Name\":\"Morning\",\"ID\":1,\"Times_active\":["
+                               "{\"Start_time\":800,\"End_time\":900}]}", true) == ESP_OK);
+    task_t task = test_task();
+    CHECK(store_task(&task, true) == ESP_OK);
+
+    memset(&out, 0, sizeof(out));
+    CHECK(export_config_json(collect_sink, &out) == ESP_OK);
+    char golden[1024];
+    snprintf(golden, sizeof(golden), "{\"Timetables\":[%s,%s],\"Tasks\":[%s]}",
+             "{\"Type\":1,\"Name\":\"Morning\",\"ID\":1,\"Times_active\":[{\"Start_time\":800,\"End_time\":900}]}",
+             timetable_extended_golden, task_golden);
+    CHECK(same_text(out.text, golden));
+    CHECK(out.chunks == (int)((strlen(golden) + CONFIG_EXPORT_CHUNK_SIZE - 1) / CONFIG_EXPORT_CHUNK_SIZE));
+
+    memset(&out, 0, sizeof(out));
+    out.fail_at = 1;
+    CHECK(export_config_json(collect_sink, &out) == ESP_FAIL);
+    nvs_host_deinit();
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s partition_file\n", argv[0]);
+        return 2;
+    }
+    if (!test_writer() || !test_records() || !test_export(argv[1])) {
+        return 1;
+    }
+    printf("JSON encode goldens OK\n");
+    return 0;
+}
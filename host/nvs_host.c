@@ -0,0 +1,932 @@
+#include "nvs_host.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FILE_MAGIC   0x4853564Eu  // "NVSH"
+#define FILE_VERSION 1
+
+typedef enum {
+    PAGE_FREE = 0,
+    PAGE_ACTIVE,
+    PAGE_FULL,
+} page_state_t;
+
+typedef struct {
+    page_state_t state;
+    uint16_t used;    // entries programmed since the last erase
+    uint16_t erased;  // entries among `used` that no longer hold live data
+} host_page_t;
+
+typedef struct {
+    uint16_t page;
+    uint16_t span;
+} placement_t;
+
+// Namespace records are items of namespace 0, like in NVS.
+typedef struct {
+    uint8_t ns;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_type_t type;
+    uint8_t *data;
+    size_t len;
+    placement_t *placements;
+    size_t placement_count;
+} host_item_t;
+
+typedef struct {
+    bool in_use;
+    bool initialized;
+    char label[32];
+    char path[256];
+    size_t page_count;
+    host_page_t *pages;
+    int active_page;
+    host_item_t *items;
+    size_t item_count;
+    size_t item_capacity;
+    nvs_host_stats_t stats;
+} host_partition_t;
+
+typedef struct {
+    bool in_use;
+    host_partition_t *partition;
+    uint8_t ns;
+    bool read_only;
+} host_handle_t;
+
+struct nvs_opaque_iterator_t {
+    host_partition_t *partition;
+    int ns;           // -1 for all namespaces
+    nvs_type_t type;
+    size_t index;
+};
+
+static host_partition_t partitions[NVS_HOST_MAX_PARTITIONS];
+static host_handle_t handles[NVS_HOST_MAX_HANDLES];
+
+static host_partition_t *find_partition(const char *label)
+{
+    for (int i = 0; i < NVS_HOST_MAX_PARTITIONS; i++) {
+        if (partitions[i].in_use && strcmp(partitions[i].label, label) == 0) {
+            return &partitions[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t nvs_host_partition_add(const char *label, const char *path, size_t size)
+{
+    if (!label || strlen(label) >= sizeof(partitions[0].label) ||
+        (path && strlen(path) >= sizeof(partitions[0].path))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t page_count = size / NVS_HOST_PAGE_SIZE;
+    if (page_count < 2) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (find_partition(label)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (int i = 0; i < NVS_HOST_MAX_PARTITIONS; i++) {
+        host_partition_t *p = &partitions[i];
+        if (!p->in_use) {
+            memset(p, 0, sizeof(*p));
+            p->in_use = true;
+            strcpy(p->label, label);
+            if (path) {
+                strcpy(p->path, path);
+            }
+            p->page_count = page_count;
+            p->active_page = -1;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+static size_t entries_for_data(size_t len)
+{
+    return 1 + (len + NVS_HOST_ENTRY_SIZE - 1) / NVS_HOST_ENTRY_SIZE;
+}
+
+static size_t free_page_count(const host_partition_t *p)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < p->page_count; i++) {
+        if (p->pages[i].state == PAGE_FREE) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Compacts the full page with the most erased entries into the reserved page.
+ */
+static esp_err_t collect_garbage(host_partition_t *p)
+{
+    int victim = -1;
+    uint16_t most_erased = 0;
+    int spare = -1;
+    for (size_t i = 0; i < p->page_count; i++) {
+        if (p->pages[i].state == PAGE_FULL && p->pages[i].erased > most_erased) {
+            most_erased = p->pages[i].erased;
+            victim = (int)i;
+        }
+        if (p->pages[i].state == PAGE_FREE && spare < 0) {
+            spare = (int)i;
+        }
+    }
+    if (victim < 0 || spare < 0) {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+
+    host_page_t *target = &p->pages[spare];
+    target->state = PAGE_ACTIVE;
+    for (size_t i = 0; i < p->item_count; i++) {
+        host_item_t *item = &p->items[i];
+        for (size_t c = 0; c < item->placement_count; c++) {
+            if (item->placements[c].page == victim) {
+                item->placements[c].page = (uint16_t)spare;
+                target->used += item->placements[c].span;
+                p->stats.entries_written += item->placements[c].span;
+            }
+        }
+    }
+    p->pages[victim].state = PAGE_FREE;
+    p->pages[victim].used = 0;
+    p->pages[victim].erased = 0;
+    p->stats.page_erases++;
+    p->active_page = spare;
+    return ESP_OK;
+}
+
+/**
+ * @brief Reserves span consecutive entries in one page, running GC when needed.
+ */
+static esp_err_t place_entries(host_partition_t *p, uint16_t span, placement_t *out)
+{
+    if (span > NVS_HOST_ENTRIES_PER_PAGE) {
+        return ESP_ERR_NVS_VALUE_TOO_LONG;
+    }
+    // Each GC round either frees room or closes a page; bound the rounds.
+    for (size_t round = 0; round <= 2 * p->page_count; round++) {
+        if (p->active_page >= 0) {
+            host_page_t *page = &p->pages[p->active_page];
+            if (NVS_HOST_ENTRIES_PER_PAGE - page->used >= span) {
+                out->page = (uint16_t)p->active_page;
+                out->span = span;
+                page->used += span;
+                p->stats.entries_written += span;
+                return ESP_OK;
+            }
+            // Items never span pages: the tail of the page stays unused until it is erased.
+            page->erased += NVS_HOST_ENTRIES_PER_PAGE - page->used;
+            page->used = NVS_HOST_ENTRIES_PER_PAGE;
+            page->state = PAGE_FULL;
+            p->active_page = -1;
+        }
+        // One free page is always kept in reserve for garbage collection.
+        if (free_page_count(p) > 1) {
+            for (size_t i = 0; i < p->page_count; i++) {
+                if (p->pages[i].state == PAGE_FREE) {
+                    p->pages[i].state = PAGE_ACTIVE;
+                    p->active_page = (int)i;
+                    break;
+                }
+            }
+            continue;
+        }
+        esp_err_t err = collect_garbage(p);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+}
+
+static void release_placements(host_partition_t *p, placement_t *placements, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        p->pages[placements[i].page].erased += placements[i].span;
+    }
+}
+
+/**
+ * @brief Lays out an item the way NVS does and reserves its entries.
+ */
+static esp_err_t place_item(host_partition_t *p, nvs_type_t type, size_t len,
+                            placement_t **out, size_t *out_count)
+{
+    size_t count;
+    if (type == NVS_TYPE_STR) {
+        count = 1;
+    } else if (type == NVS_TYPE_BLOB) {
+        // index entry + data chunks
+        count = 1 + (len + NVS_HOST_MAX_BLOB_CHUNK - 1) / NVS_HOST_MAX_BLOB_CHUNK;
+        if (len == 0) {
+            count = 2;
+        }
+    } else {
+        count = 1;
+    }
+    placement_t *placements = calloc(count, sizeof(placement_t));
+    if (!placements) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = ESP_OK;
+    size_t placed = 0;
+    if (type == NVS_TYPE_STR) {
+        err = place_entries(p, (uint16_t)entries_for_data(len), &placements[0]);
+        placed = (err == ESP_OK);
+    } else if (type == NVS_TYPE_BLOB) {
+        size_t remaining = len;
+        for (size_t c = 1; c < count && err == ESP_OK; c++) {
+            size_t chunk = remaining < NVS_HOST_MAX_BLOB_CHUNK ? remaining : NVS_HOST_MAX_BLOB_CHUNK;
+            err = place_entries(p, (uint16_t)entries_for_data(chunk), &placements[placed]);
+            if (err == ESP_OK) {
+                placed++;
+                remaining -= chunk;
+            }
+        }
+        if (err == ESP_OK) {
+            err = place_entries(p, 1, &placements[placed]);
+            placed += (err == ESP_OK);
+        }
+    } else {
+        err = place_entries(p, 1, &placements[0]);
+        placed = (err == ESP_OK);
+    }
+
+    if (err != ESP_OK) {
+        // Entries already programmed stay behind as garbage, as on flash.
+        release_placements(p, placements, placed);
+        free(placements);
+        return err;
+    }
+    *out = placements;
+    *out_count = count;
+    return ESP_OK;
+}
+
+static host_item_t *find_item(host_partition_t *p, uint8_t ns, const char *key)
+{
+    for (size_t i = 0; i < p->item_count; i++) {
+        if (p->items[i].ns == ns && strcmp(p->items[i].key, key) == 0) {
+            return &p->items[i];
+        }
+    }
+    return NULL;
+}
+
+static void remove_item(host_partition_t *p, host_item_t *item)
+{
+    release_placements(p, item->placements, item->placement_count);
+    free(item->placements);
+    free(item->data);
+    *item = p->items[--p->item_count];
+}
+
+/**
+ * @brief Writes (or replaces) an item. Identical data is not rewritten.
+ */
+static esp_err_t store_item(host_partition_t *p, uint8_t ns, const char *key, nvs_type_t type,
+                            const void *data, size_t len)
+{
+    host_item_t *existing = find_item(p, ns, key);
+    if (existing && existing->type == type && existing->len == len &&
+        (len == 0 || memcmp(existing->data, data, len) == 0)) {
+        p->stats.writes_skipped++;
+        return ESP_OK;
+    }
+
+    placement_t *placements;
+    size_t placement_count;
+    esp_err_t err = place_item(p, type, len, &placements, &placement_count);
+    if (err != ESP_OK) {
+        return err;
+    }
+    uint8_t *copy = malloc(len ? len : 1);
+    if (!copy) {
+        release_placements(p, placements, placement_count);
+        free(placements);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, data, len);
+
+    // The new item is written before the old one is erased, as in NVS.
+    existing = find_item(p, ns, key);
+    if (existing) {
+        remove_item(p, existing);
+    }
+    if (p->item_count == p->item_capacity) {
+        size_t capacity = p->item_capacity ? p->item_capacity * 2 : 64;
+        host_item_t *items = realloc(p->items, capacity * sizeof(host_item_t));
+        if (!items) {
+            release_placements(p, placements, placement_count);
+            free(placements);
+            free(copy);
+            return ESP_ERR_NO_MEM;
+        }
+        p->items = items;
+        p->item_capacity = capacity;
+    }
+    host_item_t *item = &p->items[p->item_count++];
+    memset(item, 0, sizeof(*item));
+    item->ns = ns;
+    strcpy(item->key, key);
+    item->type = type;
+    item->data = copy;
+    item->len = len;
+    item->placements = placements;
+    item->placement_count = placement_count;
+
+    p->stats.writes++;
+    p->stats.bytes_written += (uint32_t)len;
+    return ESP_OK;
+}
+
+static int find_namespace(host_partition_t *p, const char *name)
+{
+    host_item_t *item = find_item(p, 0, name);
+    return item ? item->data[0] : -1;
+}
+
+static esp_err_t create_namespace(host_partition_t *p, const char *name, uint8_t *out_ns)
+{
+    bool used[NVS_HOST_MAX_NAMESPACES + 1] = {false};
+    for (size_t i = 0; i < p->item_count; i++) {
+        if (p->items[i].ns == 0) {
+            used[p->items[i].data[0]] = true;
+        }
+    }
+    for (int ns = 1; ns <= NVS_HOST_MAX_NAMESPACES; ns++) {
+        if (!used[ns]) {
+            uint8_t value = (uint8_t)ns;
+            esp_err_t err = store_item(p, 0, name, NVS_TYPE_U8, &value, 1);
+            if (err == ESP_OK) {
+                *out_ns = value;
+            }
+            return err;
+        }
+    }
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+}
+
+static void free_items(host_partition_t *p)
+{
+    for (size_t i = 0; i < p->item_count; i++) {
+        free(p->items[i].placements);
+        free(p->items[i].data);
+    }
+    free(p->items);
+    p->items = NULL;
+    p->item_count = 0;
+    p->item_capacity = 0;
+}
+
+static esp_err_t save_partition(host_partition_t *p)
+{
+    if (p->path[0] == '\0') {
+        return ESP_OK;
+    }
+    char tmp_path[sizeof(p->path) + 4];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", p->path);
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) {
+        return ESP_FAIL;
+    }
+    uint32_t header[3] = { FILE_MAGIC, FILE_VERSION, (uint32_t)p->item_count };
+    bool ok = fwrite(header, sizeof(header), 1, f) == 1;
+    for (size_t i = 0; ok && i < p->item_count; i++) {
+        const host_item_t *item = &p->items[i];
+        uint32_t fields[3] = { item->ns, (uint32_t)item->type, (uint32_t)item->len };
+        ok = fwrite(fields, sizeof(fields), 1, f) == 1 &&
+             fwrite(item->key, sizeof(item->key), 1, f) == 1 &&
+             (item->len == 0 || fwrite(item->data, item->len, 1, f) == 1);
+    }
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp_path, p->path) != 0) {
+        remove(tmp_path);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Loads the items saved in the partition file. They are laid out afresh,
+ * so a loaded partition starts without erased entries.
+ */
+static esp_err_t load_partition(host_partition_t *p)
+{
+    if (p->path[0] == '\0') {
+        return ESP_OK;
+    }
+    FILE *f = fopen(p->path, "rb");
+    if (!f) {
+        return ESP_OK;  // new partition
+    }
+    uint32_t header[3];
+    esp_err_t err = ESP_OK;
+    if (fread(header, sizeof(header), 1, f) != 1 || header[0] != FILE_MAGIC || header[1] != FILE_VERSION) {
+        err = ESP_ERR_NVS_NEW_VERSION_FOUND;
+    }
+    for (uint32_t i = 0; err == ESP_OK && i < header[2]; i++) {
+        uint32_t fields[3];
+        char key[NVS_KEY_NAME_MAX_SIZE];
+        if (fread(fields, sizeof(fields), 1, f) != 1 || fread(key, sizeof(key), 1, f) != 1 ||
+            fields[2] > NVS_HOST_MAX_BLOB_CHUNK * 128u) {
+            err = ESP_ERR_NVS_CORRUPT_KEY_PART;
+            break;
+        }
+        key[NVS_KEY_NAME_MAX_SIZE - 1] = '\0';
+        uint8_t *data = malloc(fields[2] ? fields[2] : 1);
+        if (!data) {
+            err = ESP_ERR_NO_MEM;
+            break;
+        }
+        if (fields[2] > 0 && fread(data, fields[2], 1, f) != 1) {
+            free(data);
+            err = ESP_ERR_NVS_CORRUPT_KEY_PART;
+            break;
+        }
+        err = store_item(p, (uint8_t)fields[0], key, (nvs_type_t)fields[1], data, fields[2]);
+        free(data);
+    }
+    fclose(f);
+    return err;
+}
+
+esp_err_t nvs_flash_init_partition(const char *partition_label)
+{
+    if (!partition_label) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_partition_t *p = find_partition(partition_label);
+    if (!p) {
+        esp_err_t err = nvs_host_partition_add(partition_label, NULL, NVS_HOST_DEFAULT_PARTITION_SIZE);
+        if (err != ESP_OK) {
+            return err;
+        }
+        p = find_partition(partition_label);
+    }
+    if (p->initialized) {
+        return ESP_OK;
+    }
+    p->pages = calloc(p->page_count, sizeof(host_page_t));
+    if (!p->pages) {
+        return ESP_ERR_NO_MEM;
+    }
+    p->active_page = -1;
+    esp_err_t err = load_partition(p);
+    if (err != ESP_OK) {
+        free_items(p);
+        free(p->pages);
+        p->pages = NULL;
+        return err;
+    }
+    memset(&p->stats, 0, sizeof(p->stats));
+    p->initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_init(void)
+{
+    return nvs_flash_init_partition(NVS_DEFAULT_PART_NAME);
+}
+
+esp_err_t nvs_flash_deinit_partition(const char *partition_label)
+{
+    host_partition_t *p = partition_label ? find_partition(partition_label) : NULL;
+    if (!p || !p->initialized) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    for (int i = 0; i < NVS_HOST_MAX_HANDLES; i++) {
+        if (handles[i].in_use && handles[i].partition == p) {
+            handles[i].in_use = false;
+        }
+    }
+    free_items(p);
+    free(p->pages);
+    p->pages = NULL;
+    p->initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_deinit(void)
+{
+    return nvs_flash_deinit_partition(NVS_DEFAULT_PART_NAME);
+}
+
+esp_err_t nvs_flash_erase_partition(const char *part_name)
+{
+    host_partition_t *p = part_name ? find_partition(part_name) : NULL;
+    if (!p) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (p->initialized) {
+        nvs_flash_deinit_partition(part_name);
+    }
+    if (p->path[0] != '\0') {
+        remove(p->path);
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    return nvs_flash_erase_partition(NVS_DEFAULT_PART_NAME);
+}
+
+esp_err_t nvs_open_from_partition(const char *part_name, const char *namespace_name,
+                                  nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    if (!part_name || !namespace_name || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_partition_t *p = find_partition(part_name);
+    if (!p || !p->initialized) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    if (strlen(namespace_name) >= NVS_NS_NAME_MAX_SIZE) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    int ns = find_namespace(p, namespace_name);
+    if (ns < 0) {
+        if (open_mode == NVS_READONLY) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+        uint8_t created;
+        esp_err_t err = create_namespace(p, namespace_name, &created);
+        if (err != ESP_OK) {
+            return err;
+        }
+        ns = created;
+    }
+    for (int i = 0; i < NVS_HOST_MAX_HANDLES; i++) {
+        if (!handles[i].in_use) {
+            handles[i].in_use = true;
+            handles[i].partition = p;
+            handles[i].ns = (uint8_t)ns;
+            handles[i].read_only = (open_mode == NVS_READONLY);
+            *out_handle = (nvs_handle_t)(i + 1);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    return nvs_open_from_partition(NVS_DEFAULT_PART_NAME, namespace_name, open_mode, out_handle);
+}
+
+static host_handle_t *get_handle(nvs_handle_t handle)
+{
+    if (handle == 0 || handle > NVS_HOST_MAX_HANDLES || !handles[handle - 1].in_use) {
+        return NULL;
+    }
+    return &handles[handle - 1];
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+    host_handle_t *h = get_handle(handle);
+    if (h) {
+        h->in_use = false;
+    }
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    host_handle_t *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    h->partition->stats.commits++;
+    return save_partition(h->partition);
+}
+
+static esp_err_t set_value(nvs_handle_t handle, const char *key, nvs_type_t type, const void *data, size_t len)
+{
+    host_handle_t *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (h->read_only) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    if (!key || key[0] == '\0') {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    if (type == NVS_TYPE_STR && len > NVS_HOST_MAX_STR_LEN) {
+        return ESP_ERR_NVS_VALUE_TOO_LONG;
+    }
+    // NVS keeps at most half of the pages worth of blob chunks for one blob.
+    if (type == NVS_TYPE_BLOB && len > (h->partition->page_count / 2) * NVS_HOST_MAX_BLOB_CHUNK) {
+        return ESP_ERR_NVS_VALUE_TOO_LONG;
+    }
+    return store_item(h->partition, h->ns, key, type, data, len);
+}
+
+/**
+ * @brief Looks up an item for a get call; copies it out when out is not NULL.
+ *
+ * @param length in: size of out, out: stored size (variable-length types only).
+ */
+static esp_err_t get_value(nvs_handle_t handle, const char *key, nvs_type_t type, void *out, size_t *length)
+{
+    host_handle_t *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (!key) {
+        return ESP_ERR_NVS_INVALID_NAME;
+    }
+    host_partition_t *p = h->partition;
+    p->stats.reads++;
+    host_item_t *item = find_item(p, h->ns, key);
+    if (!item) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (item->type != type) {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    if (out == NULL) {
+        *length = item->len;
+        return ESP_OK;
+    }
+    if (*length < item->len) {
+        *length = item->len;
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(out, item->data, item->len);
+    *length = item->len;
+    p->stats.bytes_read += (uint32_t)item->len;
+    return ESP_OK;
+}
+
+#define NVS_HOST_INTEGER_ACCESSORS(suffix, c_type, nvs_type)                              \
+    esp_err_t nvs_set_##suffix(nvs_handle_t handle, const char *key, c_type value)         \
+    {                                                                                      \
+        return set_value(handle, key, nvs_type, &value, sizeof(value));                    \
+    }                                                                                      \
+    esp_err_t nvs_get_##suffix(nvs_handle_t handle, const char *key, c_type *out_value)    \
+    {                                                                                      \
+        if (!out_value) {                                                                  \
+            return ESP_ERR_INVALID_ARG;                                                    \
+        }                                                                                  \
+        size_t length = sizeof(*out_value);                                                \
+        return get_value(handle, key, nvs_type, out_value, &length);                       \
+    }
+
+NVS_HOST_INTEGER_ACCESSORS(u8, uint8_t, NVS_TYPE_U8)
+NVS_HOST_INTEGER_ACCESSORS(i8, int8_t, NVS_TYPE_I8)
+NVS_HOST_INTEGER_ACCESSORS(u16, uint16_t, NVS_TYPE_U16)
+NVS_HOST_INTEGER_ACCESSORS(i16, int16_t, NVS_TYPE_I16)
+NVS_HOST_INTEGER_ACCESSORS(u32, uint32_t, NVS_TYPE_U32)
+NVS_HOST_INTEGER_ACCESSORS(i32, int32_t, NVS_TYPE_I32)
+NVS_HOST_INTEGER_ACCESSORS(u64, uint64_t, NVS_TYPE_U64)
+NVS_HOST_INTEGER_ACCESSORS(i64, int64_t, NVS_TYPE_I64)
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value)
+{
+    if (!value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return set_value(handle, key, NVS_TYPE_STR, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length)
+{
+    if (!length) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return get_value(handle, key, NVS_TYPE_STR, out_value, length);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    if (!value && length > 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return set_value(handle, key, NVS_TYPE_BLOB, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    if (!length) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return get_value(handle, key, NVS_TYPE_BLOB, out_value, length);
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    host_handle_t *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (h->read_only) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    host_item_t *item = key ? find_item(h->partition, h->ns, key) : NULL;
+    if (!item) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    remove_item(h->partition, item);
+    h->partition->stats.writes++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle)
+{
+    host_handle_t *h = get_handle(handle);
+    if (!h) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    if (h->read_only) {
+        return ESP_ERR_NVS_READ_ONLY;
+    }
+    host_partition_t *p = h->partition;
+    for (size_t i = 0; i < p->item_count;) {
+        if (p->items[i].ns == h->ns) {
+            remove_item(p, &p->items[i]);  // moves the last item into slot i
+            p->stats.writes++;
+        } else {
+            i++;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_used_entry_count(nvs_handle_t handle, size_t *used_entries)
+{
+    host_handle_t *h = get_handle(handle);
+    if (!h || !used_entries) {
+        return h ? ESP_ERR_INVALID_ARG : ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < h->partition->item_count; i++) {
+        const host_item_t *item = &h->partition->items[i];
+        if (item->ns == h->ns) {
+            for (size_t c = 0; c < item->placement_count; c++) {
+                count += item->placements[c].span;
+            }
+        }
+    }
+    *used_entries = count;
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_stats(const char *part_name, nvs_stats_t *nvs_stats)
+{
+    host_partition_t *p = find_partition(part_name ? part_name : NVS_DEFAULT_PART_NAME);
+    if (!nvs_stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!p || !p->initialized) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    size_t used = 0;
+    size_t namespaces = 0;
+    for (size_t i = 0; i < p->item_count; i++) {
+        for (size_t c = 0; c < p->items[i].placement_count; c++) {
+            used += p->items[i].placements[c].span;
+        }
+        namespaces += (p->items[i].ns == 0);
+    }
+    size_t total = p->page_count * NVS_HOST_ENTRIES_PER_PAGE;
+    nvs_stats->used_entries = used;
+    nvs_stats->free_entries = total - used;
+    nvs_stats->available_entries = (total - NVS_HOST_ENTRIES_PER_PAGE) > used ?
+                                   (total - NVS_HOST_ENTRIES_PER_PAGE) - used : 0;
+    nvs_stats->total_entries = total;
+    nvs_stats->namespace_count = namespaces;
+    return ESP_OK;
+}
+
+static bool iterator_matches(const struct nvs_opaque_iterator_t *it, const host_item_t *item)
+{
+    return item->ns != 0 && (it->ns < 0 || item->ns == it->ns) &&
+           (it->type == NVS_TYPE_ANY || item->type == it->type);
+}
+
+/**
+ * @brief Moves the iterator to the first matching item at or after it->index.
+ */
+static bool iterator_settle(struct nvs_opaque_iterator_t *it)
+{
+    host_partition_t *p = it->partition;
+    while (it->index < p->item_count && !iterator_matches(it, &p->items[it->index])) {
+        it->index++;
+    }
+    return it->index < p->item_count;
+}
+
+esp_err_t nvs_entry_find(const char *part_name, const char *namespace_name, nvs_type_t type,
+                         nvs_iterator_t *output_iterator)
+{
+    if (!part_name || !output_iterator) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *output_iterator = NULL;
+    host_partition_t *p = find_partition(part_name);
+    if (!p || !p->initialized) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    int ns = -1;
+    if (namespace_name) {
+        ns = find_namespace(p, namespace_name);
+        if (ns < 0) {
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+    struct nvs_opaque_iterator_t *it = calloc(1, sizeof(*it));
+    if (!it) {
+        return ESP_ERR_NO_MEM;
+    }
+    it->partition = p;
+    it->ns = ns;
+    it->type = type;
+    if (!iterator_settle(it)) {
+        free(it);
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *output_iterator = it;
+    return ESP_OK;
+}
+
+esp_err_t nvs_entry_next(nvs_iterator_t *iterator)
+{
+    if (!iterator || !*iterator) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    (*iterator)->index++;
+    if (!iterator_settle(*iterator)) {
+        free(*iterator);
+        *iterator = NULL;
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_entry_info(const nvs_iterator_t iterator, nvs_entry_info_t *out_info)
+{
+    if (!iterator || !out_info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_partition_t *p = iterator->partition;
+    const host_item_t *item = &p->items[iterator->index];
+    memset(out_info, 0, sizeof(*out_info));
+    for (size_t i = 0; i < p->item_count; i++) {
+        if (p->items[i].ns == 0 && p->items[i].data[0] == item->ns) {
+            strncpy(out_info->namespace_name, p->items[i].key, sizeof(out_info->namespace_name) - 1);
+            break;
+        }
+    }
+    strncpy(out_info->key, item->key, sizeof(out_info->key) - 1);
+    out_info->type = item->type;
+    return ESP_OK;
+}
+
+void nvs_release_iterator(nvs_iterator_t iterator)
+{
+    free(iterator);
+}
+
+esp_err_t nvs_host_get_stats(const char *label, nvs_host_stats_t *stats)
+{
+    host_partition_t *p = label ? find_partition(label) : NULL;
+    if (!p || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *stats = p->stats;
+    return ESP_OK;
+}
+
+void nvs_host_reset_stats(void)
+{
+    for (int i = 0; i < NVS_HOST_MAX_PARTITIONS; i++) {
+        memset(&partitions[i].stats, 0, sizeof(partitions[i].stats));
+    }
+}
+
+void nvs_host_deinit(void)
+{
+    for (int i = 0; i < NVS_HOST_MAX_PARTITIONS; i++) {
+        if (partitions[i].in_use && partitions[i].initialized) {
+            nvs_flash_deinit_partition(partitions[i].label);
+        }
+        partitions[i].in_use = false;
+    }
+    memset(handles, 0, sizeof(handles));
+}
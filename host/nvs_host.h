@@ -0,0 +1,64 @@
+#ifndef NVS_HOST_H
+#define NVS_HOST_H
+
+/*
+ * File-backed host (Linux) implementation of the NVS API subset used by json_parser:
+ * nvs_flash_init/_partition, nvs_open/_from_partition, get/set of integers, strings
+ * and blobs, erase_key/erase_all, commit, close, entry iterators and nvs_get_stats.
+ *
+ * Link nvs_host.c instead of the nvs_flash component to run task.c, timetable.c,
+ * reminder.c, rfid_map.c and storage.c on a build machine. It compiles against the
+ * IDF signatures in host/shims (nvs.h, nvs_flash.h), so the storage code builds
+ * unchanged; host/CMakeLists.txt builds it, and nvs_host_test.c checks a round trip
+ * through the partition file.
+ *
+ * Flash layout is modelled the way NVS stores items: 4 KiB pages of 126 entries of
+ * 32 bytes, integers take one entry, strings one header entry plus their data entries,
+ * blobs an index entry plus chunks that never span pages. Overwriting or erasing an
+ * item only marks its entries erased; when the last free page is needed, the full page
+ * with the most erased entries is compacted into the reserved page and erased. Writes
+ * of identical data are skipped like in NVS. Running out of space returns
+ * ESP_ERR_NVS_NOT_ENOUGH_SPACE.
+ *
+ * Items are saved to the partition's file on nvs_commit() and loaded again by
+ * nvs_flash_init_partition(). Changes that were never committed are lost when the
+ * process exits - stricter than real NVS, which makes missing commits visible in tests.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define NVS_HOST_PAGE_SIZE              4096
+#define NVS_HOST_ENTRY_SIZE             32
+#define NVS_HOST_ENTRIES_PER_PAGE       126
+#define NVS_HOST_MAX_STR_LEN            4000   // including the terminator
+#define NVS_HOST_MAX_BLOB_CHUNK         ((NVS_HOST_ENTRIES_PER_PAGE - 1) * NVS_HOST_ENTRY_SIZE)
+#define NVS_HOST_MAX_NAMESPACES         254
+#define NVS_HOST_MAX_PARTITIONS         4
+#define NVS_HOST_MAX_HANDLES            64
+#define NVS_HOST_DEFAULT_PARTITION_SIZE 0x6000 // used for labels that were not added explicitly
+
+typedef struct {
+    uint32_t reads;             // get calls
+    uint32_t bytes_read;        // bytes copied out by get calls
+    uint32_t writes;            // set/erase calls that changed flash
+    uint32_t writes_skipped;    // set calls with data identical to the stored item
+    uint32_t bytes_written;     // payload bytes of the writes
+    uint32_t entries_written;   // 32-byte entries programmed, including GC relocation
+    uint32_t commits;           // nvs_commit calls
+    uint32_t page_erases;       // pages erased by garbage collection
+} nvs_host_stats_t;
+
+// Registers a partition before nvs_flash_init_partition(). path may be NULL for a
+// purely in-memory partition. size is rounded down to whole pages (at least 2).
+esp_err_t nvs_host_partition_add(const char *label, const char *path, size_t size);
+
+// Counters of one partition since it was initialized or nvs_host_reset_stats().
+esp_err_t nvs_host_get_stats(const char *label, nvs_host_stats_t *stats);
+void nvs_host_reset_stats(void);
+
+// Frees all partitions and handles (files are kept).
+void nvs_host_deinit(void);
+
+#endif // NVS_HOST_H
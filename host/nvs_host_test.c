@@ -0,0 +1,150 @@
+/*
+ * Round-trip test of host/nvs_host.c: values written through the NVS API and through
+ * the storage modules of main/json_parser (task.c, reminder.c, rfid_map.c, storage.c)
+ * are committed to the partition file (change notifications of a session arrive after
+ * its end), the partition is closed and loaded again, and
+ * everything is read back:
+ *   ./nvs_host_test /tmp/nvs_host_test.bin
+ * Exits with 1 on the first difference.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "json_parser.h"
+#include "nvs_host.h"
+
+#define TEST_PARTITION_SIZE (16 * 4096)
+
+#define CHECK(cond) do {                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            return false;                                                        \
+        }                                                                        \
+    } while (0)
+
+static const uint8_t test_uid[4] = { 0xAA, 0xB4, 0xB5, 0x12 };
+static uint8_t test_blob[1000];
+static int task_changes = 0;
+
+static void count_task_change(storage_change_t change, int id, void *ctx)
+{
+    task_changes += change == STORAGE_CHANGE_TASK && id == 7;
+}
+
+static bool open_partition(const char *path)
+{
+    return nvs_host_partition_add(NVS_PARTITION, path, TEST_PARTITION_SIZE) == ESP_OK &&
+           nvs_flash_init_partition(NVS_PARTITION) == ESP_OK;
+}
+
+static bool write_all(void)
+{
+    nvs_handle_t handle;
+    CHECK(nvs_open_from_partition(NVS_PARTITION, "test", NVS_READWRITE, &handle) == ESP_OK);
+    CHECK(nvs_set_u8(handle, "u8", 0xA5) == ESP_OK);
+    CHECK(nvs_set_i32(handle, "i32", -123456) == ESP_OK);
+    CHECK(nvs_set_u64(handle, "u64", 0x0123456789ABCDEFull) == ESP_OK);
+    CHECK(nvs_set_str(handle, "str", "hello host") == ESP_OK);
+    for (size_t i = 0; i < sizeof(test_blob); i++) {
+        test_blob[i] = (uint8_t)(i * 7);
+    }
+    CHECK(nvs_set_blob(handle, "blob", test_blob, sizeof(test_blob)) == ESP_OK);
+    CHECK(nvs_set_str(handle, "gone", "erased before the commit") == ESP_OK);
+    CHECK(nvs_erase_key(handle, "gone") == ESP_OK);
+    CHECK(nvs_commit(handle) == ESP_OK);
+    nvs_close(handle);
+
+    task_t task;
+    memset(&task, 0, sizeof(task));
+    task.Type = 1;
+    task.ID = 7;
+    snprintf(task.Name, sizeof(task.Name), "Round trip");
+    snprintf(task.Options[0].display_text, sizeof(task.Options[0].display_text), "morning");
+    task.Options[0].timeslots[0] = 1;
+    task.Options[0].priority = 2;
+    task.Options[0].days_till_em = 3;
+    // Inside a session the change is only sent once the session ends.
+    CHECK(storage_add_listener(count_task_change, NULL) == ESP_OK);
+    CHECK(storage_session_begin() == ESP_OK);
+    CHECK(store_task(&task, true) == ESP_OK);
+    CHECK(task_changes == 0);
+    CHECK(storage_session_end() == ESP_OK);
+    CHECK(task_changes == 1);
+
+    type1_reminder_t reminder;
+    memset(&reminder, 0, sizeof(reminder));
+    reminder.Reminder_Type = 1;
+    reminder.Task_ID = 7;
+    reminder.Task_Type = 1;
+    reminder.Time_Created = 1772649015;
+    CHECK(store_type1_reminder(&reminder, 1) > 0);
+
+    CHECK(rfid_map_init() == ESP_OK);
+    CHECK(assign_rfid_uid_to_task(test_uid, sizeof(test_uid), 7) == ESP_OK);
+    return true;
+}
+
+static bool read_all(void)
+{
+    nvs_handle_t handle;
+    CHECK(nvs_open_from_partition(NVS_PARTITION, "missing", NVS_READONLY, &handle) == ESP_ERR_NVS_NOT_FOUND);
+    CHECK(nvs_open_from_partition(NVS_PARTITION, "test", NVS_READONLY, &handle) == ESP_OK);
+    uint8_t u8 = 0;
+    int32_t i32 = 0;
+    uint64_t u64 = 0;
+    CHECK(nvs_get_u8(handle, "u8", &u8) == ESP_OK && u8 == 0xA5);
+    CHECK(nvs_get_i32(handle, "i32", &i32) == ESP_OK && i32 == -123456);
+    CHECK(nvs_get_u64(handle, "u64", &u64) == ESP_OK && u64 == 0x0123456789ABCDEFull);
+    CHECK(nvs_get_u32(handle, "u8", (uint32_t *)&i32) == ESP_ERR_NVS_TYPE_MISMATCH);
+
+    char str[32];
+    size_t len = 4;
+    CHECK(nvs_get_str(handle, "str", str, &len) == ESP_ERR_NVS_INVALID_LENGTH && len == sizeof("hello host"));
+    len = sizeof(str);
+    CHECK(nvs_get_str(handle, "str", str, &len) == ESP_OK && strcmp(str, "hello host") == 0);
+
+    static uint8_t blob[sizeof(test_blob)];
+    len = 0;
+    CHECK(nvs_get_blob(handle, "blob", NULL, &len) == ESP_OK && len == sizeof(test_blob));
+    CHECK(nvs_get_blob(handle, "blob", blob, &len) == ESP_OK && memcmp(blob, test_blob, len) == 0);
+    CHECK(nvs_get_str(handle, "gone", NULL, &len) == ESP_ERR_NVS_NOT_FOUND);
+    CHECK(nvs_set_u8(handle, "u8", 0) == ESP_ERR_NVS_READ_ONLY);
+    nvs_close(handle);
+
+    task_t task;
+    CHECK(load_task(7, &task) == ESP_OK);
+    CHECK(task.ID == 7 && strcmp(task.Name, "Round trip") == 0);
+    CHECK(strcmp(task.Options[0].display_text, "morning") == 0 && task.Options[0].priority == 2);
+    CHECK(load_task(8, &task) == ESP_ERR_NVS_NOT_FOUND);
+
+    type1_reminder_t reminders[4];
+    CHECK(get_all_type1_reminders(reminders, 4) == 1);
+    CHECK(reminders[0].Task_ID == 7 && reminders[0].Time_Created == 1772649015);
+
+    CHECK(rfid_map_init() == ESP_OK);
+    CHECK(rfid_map_count() == 1);
+    CHECK(get_task_id_by_rfid_uid(test_uid, sizeof(test_uid)) == 7);
+    CHECK(get_task_id_by_rfid("AAB4B512") == 7);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s partition_file\n", argv[0]);
+        return 2;
+    }
+    remove(argv[1]);
+    if (!open_partition(argv[1]) || !write_all()) {
+        return 1;
+    }
+    nvs_host_deinit();
+    if (!open_partition(argv[1]) || !read_all()) {
+        return 1;
+    }
+    nvs_host_stats_t stats;
+    nvs_host_get_stats(NVS_PARTITION, &stats);
+    printf("round trip OK: %u reads, %u commits, %u page erases\n", (unsigned)stats.reads,
+           (unsigned)stats.commits, (unsigned)stats.page_erases);
+    nvs_host_deinit();
+    return 0;
+}
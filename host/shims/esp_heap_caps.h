@@ -0,0 +1,16 @@
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+// Free bytes of a notional heap of HOST_HEAP_SIZE, computed from the bytes the C
+// library has handed out (mallinfo2). Differences between two calls are exact,
+// which is what the benchmarks use.
+#define HOST_HEAP_SIZE (512 * 1024)
+size_t heap_caps_get_free_size(uint32_t caps);
+
+#endif // HOST_ESP_HEAP_CAPS_H
@@ -0,0 +1,289 @@
+/*
+ * Host implementations of the ESP-IDF and FreeRTOS functions declared by the
+ * headers in this directory.
+ */
+#include <malloc.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+//---------------------------------------------------------------------
+// esp_err.h
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+#define ESP_ERR_NAME(name) case name: return #name;
+        ESP_ERR_NAME(ESP_OK)
+        ESP_ERR_NAME(ESP_FAIL)
+        ESP_ERR_NAME(ESP_ERR_NO_MEM)
+        ESP_ERR_NAME(ESP_ERR_INVALID_ARG)
+        ESP_ERR_NAME(ESP_ERR_INVALID_STATE)
+        ESP_ERR_NAME(ESP_ERR_INVALID_SIZE)
+        ESP_ERR_NAME(ESP_ERR_NOT_FOUND)
+        ESP_ERR_NAME(ESP_ERR_NOT_SUPPORTED)
+        ESP_ERR_NAME(ESP_ERR_TIMEOUT)
+        ESP_ERR_NAME(ESP_ERR_INVALID_RESPONSE)
+        ESP_ERR_NAME(ESP_ERR_INVALID_CRC)
+        ESP_ERR_NAME(ESP_ERR_INVALID_VERSION)
+        ESP_ERR_NAME(ESP_ERR_NVS_NOT_INITIALIZED)
+        ESP_ERR_NAME(ESP_ERR_NVS_NOT_FOUND)
+        ESP_ERR_NAME(ESP_ERR_NVS_TYPE_MISMATCH)
+        ESP_ERR_NAME(ESP_ERR_NVS_READ_ONLY)
+        ESP_ERR_NAME(ESP_ERR_NVS_NOT_ENOUGH_SPACE)
+        ESP_ERR_NAME(ESP_ERR_NVS_INVALID_NAME)
+        ESP_ERR_NAME(ESP_ERR_NVS_INVALID_HANDLE)
+        ESP_ERR_NAME(ESP_ERR_NVS_REMOVE_FAILED)
+        ESP_ERR_NAME(ESP_ERR_NVS_KEY_TOO_LONG)
+        ESP_ERR_NAME(ESP_ERR_NVS_PAGE_FULL)
+        ESP_ERR_NAME(ESP_ERR_NVS_INVALID_STATE)
+        ESP_ERR_NAME(ESP_ERR_NVS_INVALID_LENGTH)
+        ESP_ERR_NAME(ESP_ERR_NVS_NO_FREE_PAGES)
+        ESP_ERR_NAME(ESP_ERR_NVS_VALUE_TOO_LONG)
+        ESP_ERR_NAME(ESP_ERR_NVS_PART_NOT_FOUND)
+        ESP_ERR_NAME(ESP_ERR_NVS_NEW_VERSION_FOUND)
+        ESP_ERR_NAME(ESP_ERR_NVS_CORRUPT_KEY_PART)
+#undef ESP_ERR_NAME
+        default:
+            return "UNKNOWN ERROR";
+    }
+}
+
+//---------------------------------------------------------------------
+// esp_log.h
+
+static esp_log_level_t log_level = ESP_LOG_INFO;
+
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+    (void)tag;
+    log_level = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    static const char letters[] = "NEWIDV";
+    if (level > log_level) {
+        return;
+    }
+    fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(esp_timer_get_time() / 1000), tag);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+//---------------------------------------------------------------------
+// esp_timer.h, esp_heap_caps.h
+
+int64_t esp_timer_get_time(void)
+{
+    static int64_t start_us = -1;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    int64_t now_us = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+    if (start_us < 0) {
+        start_us = now_us;
+    }
+    return now_us - start_us;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    (void)caps;
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - info.uordblks : 0;
+}
+
+//---------------------------------------------------------------------
+// freertos/task.h: a single task, the process itself
+
+static int current_task;
+static uint32_t notify_bits;
+static bool notify_pending;
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char *name, uint32_t stack_depth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created_task)
+{
+    ESP_LOGE("FREERTOS_HOST", "Cannot create task %s: no tasks on the host", name);
+    return pdFAIL;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = { .tv_sec = ticks / configTICK_RATE_HZ,
+                           .tv_nsec = (long)(ticks % configTICK_RATE_HZ) * (1000000000L / configTICK_RATE_HZ) };
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / (1000000 / configTICK_RATE_HZ));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &current_task;
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    if (action == eSetBits) {
+        notify_bits |= value;
+    } else if (action == eIncrement) {
+        notify_bits++;
+    } else if (action != eNoAction) {
+        notify_bits = value;
+    }
+    notify_pending = true;
+    return pdPASS;
+}
+
+// Returns at once: nothing else can notify while the only task waits.
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t *value, TickType_t ticks)
+{
+    if (!notify_pending) {
+        notify_bits &= ~clear_on_entry;
+        return pdFALSE;
+    }
+    if (value) {
+        *value = notify_bits;
+    }
+    notify_bits &= ~clear_on_exit;
+    notify_pending = false;
+    return pdTRUE;
+}
+
+//---------------------------------------------------------------------
+// freertos/semphr.h
+
+struct host_semaphore {
+    pthread_mutex_t mutex;
+};
+
+static SemaphoreHandle_t semaphore_create(int type)
+{
+    SemaphoreHandle_t semaphore = malloc(sizeof(*semaphore));
+    if (semaphore == NULL) {
+        return NULL;
+    }
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, type);
+    pthread_mutex_init(&semaphore->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(PTHREAD_MUTEX_NORMAL);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return semaphore_create(PTHREAD_MUTEX_RECURSIVE);
+}
+
+static BaseType_t semaphore_take(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    if (ticks == portMAX_DELAY) {
+        return pthread_mutex_lock(&semaphore->mutex) == 0 ? pdTRUE : pdFALSE;
+    }
+    return pthread_mutex_trylock(&semaphore->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    return semaphore_take(semaphore, ticks);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    return semaphore_take(semaphore, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    return pthread_mutex_unlock(&semaphore->mutex) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore)
+{
+    return xSemaphoreGive(semaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    if (semaphore) {
+        pthread_mutex_destroy(&semaphore->mutex);
+        free(semaphore);
+    }
+}
+
+//---------------------------------------------------------------------
+// freertos/queue.h
+
+struct host_queue {
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t items[];
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    QueueHandle_t queue = calloc(1, sizeof(*queue) + (size_t)length * item_size);
+    if (queue) {
+        queue->length = length;
+        queue->item_size = item_size;
+    }
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    if (queue->count == queue->length) {
+        return pdFALSE;
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(&queue->items[(size_t)tail * queue->item_size], item, queue->item_size);
+    queue->count++;
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    if (queue->count == 0) {
+        return pdFALSE;
+    }
+    memcpy(item, &queue->items[(size_t)queue->head * queue->item_size], queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+    return queue->count;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+    free(queue);
+}
@@ -0,0 +1,474 @@
+#include "storage_bench.h"
+#include "json_parser.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "nvs_host.h"
+#if STORAGE_BENCH_JSON
+#include "cJSON.h"
+#include "json_dom.h"
+#endif
+
+static const char *TAG = "STORAGE_BENCH";
+
+// Same shape as the default tasks, all four options filled.
+static const char *bench_task_json = "{"
+    "\"Type\": 1,"
+    "\"Name\": \"Benchmark Task\","
+    "\"ID\": 200,"
+    "\"RFID_UID\": \"0011223344556677\","
+    "\"Options\": ["
+        "{\"display_text\": \"breakfast 1D EM\", \"Timeslots\": [1,2], \"priority\": 1, \"days_till_em\": 1},"
+        "{\"display_text\": \"dinner 1D EM\", \"Timeslots\": [3], \"priority\": 2, \"days_till_em\": 1},"
+        "{\"display_text\": \"wholeday priority2\", \"Timeslots\": [2], \"priority\": 2, \"days_till_em\": 2},"
+        "{\"display_text\": \"wholeday priority3\", \"Timeslots\": [2,3,1], \"priority\": 3, \"days_till_em\": 3}"
+    "]"
+"}";
+
+#if STORAGE_BENCH_JSON
+/**
+ * @brief Benchmark task load latency and stored size: JSON string vs binary record.
+ *
+ * Both formats are written to the scratch namespace "Bench", loaded `iterations`
+ * times each, and the namespace is erased afterwards.
+ *
+ * @param iterations Number of loads per format.
+ */
+void storage_bench_task_load(uint32_t iterations)
+{
+    if (iterations == 0) {
+        return;
+    }
+
+    task_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.version = TASK_RECORD_VERSION;
+    if (!parse_task_json(bench_task_json, &record.task)) {
+        ESP_LOGE(TAG, "Failed to parse benchmark task");
+        return;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, STORAGE_BENCH_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open namespace '%s': %s", STORAGE_BENCH_NAMESPACE, esp_err_to_name(err));
+        return;
+    }
+    err = nvs_set_str(handle, "J", bench_task_json);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, "B", &record, sizeof(record));
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write benchmark records: %s", esp_err_to_name(err));
+        nvs_close(handle);
+        return;
+    }
+
+    // JSON path: what get_task_by_id did before the binary records (cJSON decoder).
+    uint32_t json_failures = 0;
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        size_t required_size = 0;
+        task_t task;
+        char *json_str = NULL;
+        if (nvs_get_str(handle, "J", NULL, &required_size) != ESP_OK ||
+            (json_str = malloc(required_size)) == NULL ||
+            nvs_get_str(handle, "J", json_str, &required_size) != ESP_OK ||
+            !parse_task_json_dom(json_str, &task)) {
+            json_failures++;
+        }
+        free(json_str);
+    }
+    int64_t json_us = esp_timer_get_time() - start;
+
+    // Binary path: what load_task does.
+    uint32_t blob_failures = 0;
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        task_record_t loaded;
+        size_t required_size = sizeof(loaded);
+        if (nvs_get_blob(handle, "B", &loaded, &required_size) != ESP_OK ||
+            loaded.version != TASK_RECORD_VERSION) {
+            blob_failures++;
+        }
+    }
+    int64_t blob_us = esp_timer_get_time() - start;
+
+    nvs_erase_all(handle);
+    nvs_commit(handle);
+    nvs_close(handle);
+
+    ESP_LOGI(TAG, "Task load x%u: JSON %lld us/load (%u B stored, %u failed), binary %lld us/load (%u B stored, %u failed)",
+             (unsigned)iterations,
+             (long long)(json_us / iterations), (unsigned)(strlen(bench_task_json) + 1), (unsigned)json_failures,
+             (long long)(blob_us / iterations), (unsigned)sizeof(record), (unsigned)blob_failures);
+}
+
+// Heap accounting for the cJSON path, installed with cJSON_InitHooks while the
+// decoder benchmark runs. Peak usage is sampled after every allocation.
+static size_t bench_heap_free_at_start;
+static size_t bench_heap_min_free;
+static uint32_t bench_heap_allocations;
+
+static void *bench_malloc(size_t size)
+{
+    void *ptr = malloc(size);
+    bench_heap_allocations++;
+    size_t free_now = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    if (free_now < bench_heap_min_free) {
+        bench_heap_min_free = free_now;
+    }
+    return ptr;
+}
+
+static void bench_heap_reset(void)
+{
+    bench_heap_allocations = 0;
+    bench_heap_free_at_start = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    bench_heap_min_free = bench_heap_free_at_start;
+}
+
+/**
+ * @brief Benchmark the task decoders: json_stream (parse_task_json) vs cJSON DOM.
+ *
+ * Decodes the benchmark task `iterations` times with each decoder and logs parses
+ * per second, heap allocations per parse and peak heap use of one parse.
+ *
+ * @param iterations Number of parses per decoder.
+ */
+void storage_bench_json_decode(uint32_t iterations)
+{
+    if (iterations == 0) {
+        return;
+    }
+    task_t task;
+
+    // Peak heap of a single parse, measured in isolation.
+    cJSON_Hooks hooks = { .malloc_fn = bench_malloc, .free_fn = free };
+    cJSON_InitHooks(&hooks);
+    bench_heap_reset();
+    bool dom_ok = parse_task_json_dom(bench_task_json, &task);
+    size_t dom_peak = bench_heap_free_at_start - bench_heap_min_free;
+    uint32_t dom_allocations = bench_heap_allocations;
+    cJSON_InitHooks(NULL);
+
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    bool stream_ok = parse_task_json(bench_task_json, &task);
+    // the streaming decoder never allocates, so a drop here would be a bug
+    size_t stream_leak = free_before - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+
+    if (!dom_ok || !stream_ok) {
+        ESP_LOGE(TAG, "Benchmark task failed to parse (dom=%d stream=%d)", dom_ok, stream_ok);
+        return;
+    }
+
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        parse_task_json_dom(bench_task_json, &task);
+    }
+    int64_t dom_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        parse_task_json(bench_task_json, &task);
+    }
+    int64_t stream_us = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "Task decode x%u: cJSON %lld parses/s (%u allocations, %u B peak heap), "
+             "stream %lld parses/s (0 allocations, %u B heap change)",
+             (unsigned)iterations,
+             (long long)(dom_us > 0 ? iterations * 1000000LL / dom_us : 0),
+             (unsigned)dom_allocations, (unsigned)dom_peak,
+             (long long)(stream_us > 0 ? iterations * 1000000LL / stream_us : 0),
+             (unsigned)stream_leak);
+}
+#endif // STORAGE_BENCH_JSON
+
+#define BENCH_SCALE_TASKS        200
+#define BENCH_SCALE_TIMETABLES   200
+#define BENCH_SCALE_LOOKUPS      1000
+#define BENCH_SCALE_LIST_RUNS    50
+#define BENCH_SCALE_MAX_SAMPLES  BENCH_SCALE_LOOKUPS
+
+typedef struct {
+    const char *name;
+    uint32_t samples[BENCH_SCALE_MAX_SAMPLES];  // latency per call, us
+    uint32_t count;
+    uint32_t failures;
+    int64_t total_us;
+    uint32_t commits_start;
+    uint32_t entries_start;
+} bench_op_t;
+
+static bench_op_t bench_op;  // one operation is measured at a time; too big for the stack
+
+/**
+ * @brief Flash entries written so far, as counted by the host emulator.
+ */
+static uint32_t bench_flash_entries_written(void)
+{
+    nvs_host_stats_t host_stats;
+    nvs_host_get_stats(NVS_PARTITION, &host_stats);
+    return host_stats.entries_written;
+}
+
+static uint32_t bench_commits(void)
+{
+    storage_stats_t stats;
+    storage_get_stats(&stats);
+    return stats.commits_performed;
+}
+
+static void bench_op_begin(const char *name)
+{
+    memset(&bench_op, 0, sizeof(bench_op));
+    bench_op.name = name;
+    bench_op.commits_start = bench_commits();
+    bench_op.entries_start = bench_flash_entries_written();
+}
+
+static void bench_op_sample(int64_t start_us, bool ok)
+{
+    int64_t elapsed = esp_timer_get_time() - start_us;
+    if (bench_op.count < BENCH_SCALE_MAX_SAMPLES) {
+        bench_op.samples[bench_op.count++] = (uint32_t)elapsed;
+    }
+    bench_op.total_us += elapsed;
+    if (!ok) {
+        bench_op.failures++;
+    }
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, uint32_t count, uint32_t pct)
+{
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t index = (count * pct + 99) / 100;  // nearest-rank
+    return sorted[index > 0 ? index - 1 : 0];
+}
+
+/**
+ * @brief Writes the result of the operation measured since bench_op_begin().
+ */
+static void bench_op_end(json_writer_t *w)
+{
+    uint32_t commits = bench_commits() - bench_op.commits_start;
+    uint32_t entries = bench_flash_entries_written() - bench_op.entries_start;
+    qsort(bench_op.samples, bench_op.count, sizeof(uint32_t), compare_u32);
+    uint32_t count = bench_op.count;
+
+    json_write_object_begin(w);
+    json_write_key(w, "name");
+    json_write_string(w, bench_op.name);
+    json_write_key(w, "count");
+    json_write_int(w, (int)count);
+    json_write_key(w, "failures");
+    json_write_int(w, (int)bench_op.failures);
+    json_write_key(w, "ops_per_s");
+    json_write_int(w, bench_op.total_us > 0 ? (int)(count * 1000000LL / bench_op.total_us) : 0);
+    json_write_key(w, "mean_us");
+    json_write_int(w, count ? (int)(bench_op.total_us / count) : 0);
+    json_write_key(w, "p50_us");
+    json_write_int(w, (int)percentile(bench_op.samples, count, 50));
+    json_write_key(w, "p99_us");
+    json_write_int(w, (int)percentile(bench_op.samples, count, 99));
+    json_write_key(w, "max_us");
+    json_write_int(w, count ? (int)bench_op.samples[count - 1] : 0);
+    json_write_key(w, "flash_entries_written");
+    json_write_int(w, (int)entries);
+    json_write_key(w, "commits");
+    json_write_int(w, (int)commits);
+    json_write_object_end(w);
+}
+
+static void bench_fill_reminder(type1_reminder_t *reminder, int n)
+{
+    memset(reminder, 0, sizeof(*reminder));
+    reminder->Reminder_Type = 1;
+    reminder->Task_ID = (uint8_t)(n % BENCH_SCALE_TASKS);
+    reminder->Task_Type = 1;
+    reminder->Task_Option_Selected = (uint8_t)(n / BENCH_SCALE_TASKS);
+    reminder->Time_Created = 1700000000 + n;
+}
+
+static void bench_rfid_uid(int n, uint8_t uid[4])
+{
+    uid[0] = 0xB0;
+    uid[1] = (uint8_t)(n >> 8);
+    uid[2] = (uint8_t)n;
+    uid[3] = (uint8_t)(n * 37);
+}
+
+/**
+ * @brief Storage benchmark at production scale, results as one JSON document.
+ *
+ * Fills the namespaces to their limits (REMINDER_MAX_ID reminders,
+ * BENCH_SCALE_TASKS tasks, BENCH_SCALE_TIMETABLES timetables, RFID_MAP_MAX_ENTRIES
+ * tags) and measures store_type1_reminder, get_all_type1_reminders,
+ * update_type1_reminder (a snooze), get_task_by_id, get_task_id_by_rfid and
+ * delete_reminder: throughput, latency percentiles, flash entries written and commits.
+ *
+ * The fill overwrites the default tasks and timetables and leaves the RFID map full,
+ * so it only runs on an empty partition: a scratch partition of host/nvs_host.c, as
+ * host/storage_bench_main.c sets up.
+ *
+ * @param sink Receives the JSON document.
+ * @param ctx Passed through to sink.
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if the partition holds data.
+ */
+esp_err_t storage_bench_scale(json_sink_fn sink, void *ctx)
+{
+    nvs_iterator_t it = NULL;
+    if (nvs_entry_find(NVS_PARTITION, NULL, NVS_TYPE_ANY, &it) == ESP_OK) {
+        nvs_release_iterator(it);
+        ESP_LOGE(TAG, "Partition '%s' holds data, the benchmark only runs on an empty one", NVS_PARTITION);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    type1_reminder_t *reminders = malloc(sizeof(type1_reminder_t) * REMINDER_MAX_ID);
+    if (!reminders) {
+        ESP_LOGE(TAG, "Not enough memory for the reminder list");
+        return ESP_ERR_NO_MEM;
+    }
+    char scratch[128];
+    json_writer_t w;
+    json_writer_init_sink(&w, scratch, sizeof(scratch), sink, ctx);
+
+    // Fill tasks, timetables and the RFID map in one session each.
+    int64_t fill_start = esp_timer_get_time();
+    storage_session_begin();
+    for (int id = 0; id < BENCH_SCALE_TASKS; id++) {
+        task_t task;
+        memset(&task, 0, sizeof(task));
+        if (!parse_task_json(bench_task_json, &task)) {
+            break;
+        }
+        task.ID = (uint8_t)id;
+        task.RFID_UID[0] = '\0';
+        snprintf(task.Name, sizeof(task.Name), "Bench task %d", id);
+        store_task(&task, true);
+    }
+    storage_session_end();
+    storage_session_begin();
+    for (int id = 0; id < BENCH_SCALE_TIMETABLES; id++) {
+        timetable_t timetable;
+        memset(&timetable, 0, sizeof(timetable));
+        timetable.Type = 1;
+        timetable.ID = (uint8_t)id;
+        snprintf(timetable.Name, sizeof(timetable.Name), "Bench timetable %d", id);
+        timetable.times_count = 2;
+        timetable.Times_active[0].Start_time = 800;
+        timetable.Times_active[0].End_time = 900;
+        timetable.Times_active[1].Start_time = 1800;
+        timetable.Times_active[1].End_time = 1900;
+        char json_buf[256];
+        if (timetable_to_json_buf(&timetable, json_buf, sizeof(json_buf)) < sizeof(json_buf)) {
+            store_timetable_json(json_buf, true);
+        }
+    }
+    storage_session_end();
+    storage_session_begin();
+    for (int n = 0; n < RFID_MAP_MAX_ENTRIES; n++) {
+        uint8_t uid[4];
+        bench_rfid_uid(n, uid);
+        assign_rfid_uid_to_task(uid, sizeof(uid), (uint8_t)(n % BENCH_SCALE_TASKS));
+    }
+    storage_session_end();
+    int64_t fill_us = esp_timer_get_time() - fill_start;
+
+    json_write_object_begin(&w);
+    json_write_key(&w, "benchmark");
+    json_write_string(&w, "storage_scale");
+    json_write_key(&w, "fill");
+    json_write_object_begin(&w);
+    json_write_key(&w, "tasks");
+    json_write_int(&w, BENCH_SCALE_TASKS);
+    json_write_key(&w, "timetables");
+    json_write_int(&w, BENCH_SCALE_TIMETABLES);
+    json_write_key(&w, "rfid_entries");
+    json_write_int(&w, (int)rfid_map_count());
+    json_write_key(&w, "fill_ms");
+    json_write_int(&w, (int)(fill_us / 1000));
+    json_write_object_end(&w);
+
+    json_write_key(&w, "operations");
+    json_write_array_begin(&w);
+
+    bench_op_begin("store_type1_reminder");
+    for (int n = 0; n < REMINDER_MAX_ID; n++) {
+        type1_reminder_t reminder;
+        bench_fill_reminder(&reminder, n);
+        int64_t start = esp_timer_get_time();
+        int id = store_type1_reminder(&reminder, 0);
+        bench_op_sample(start, id > 0);
+    }
+    bench_op_end(&w);
+
+    bench_op_begin("get_all_type1_reminders");
+    for (int run = 0; run < BENCH_SCALE_LIST_RUNS; run++) {
+        int64_t start = esp_timer_get_time();
+        size_t count = get_all_type1_reminders(reminders, REMINDER_MAX_ID);
+        bench_op_sample(start, count == REMINDER_MAX_ID);
+    }
+    bench_op_end(&w);
+
+    bench_op_begin("update_type1_reminder");
+    size_t stored = get_all_type1_reminders(reminders, REMINDER_MAX_ID);
+    for (size_t i = 0; i < stored; i++) {
+        reminders[i].Time_Snoozed = reminders[i].Time_Created + 600;  // what a snooze writes
+        int64_t start = esp_timer_get_time();
+        esp_err_t err = update_type1_reminder(&reminders[i]);
+        bench_op_sample(start, err == ESP_OK);
+    }
+    bench_op_end(&w);
+
+    bench_op_begin("get_task_by_id");
+    uint32_t rng = 12345;
+    for (int n = 0; n < BENCH_SCALE_LOOKUPS; n++) {
+        rng = rng * 1103515245u + 12345u;
+        int id = (int)((rng >> 16) % BENCH_SCALE_TASKS);
+        int64_t start = esp_timer_get_time();
+        task_t *task = get_task_by_id(id);
+        bench_op_sample(start, task != NULL);
+        free(task);
+    }
+    bench_op_end(&w);
+
+    bench_op_begin("get_task_id_by_rfid");
+    for (int n = 0; n < BENCH_SCALE_LOOKUPS; n++) {
+        rng = rng * 1103515245u + 12345u;
+        uint8_t uid[4];
+        bench_rfid_uid((int)((rng >> 16) % RFID_MAP_MAX_ENTRIES), uid);
+        char hex[2 * sizeof(uid) + 1];
+        snprintf(hex, sizeof(hex), "%02X%02X%02X%02X", uid[0], uid[1], uid[2], uid[3]);
+        int64_t start = esp_timer_get_time();
+        int task_id = get_task_id_by_rfid(hex);
+        bench_op_sample(start, task_id >= 0);
+    }
+    bench_op_end(&w);
+
+    bench_op_begin("delete_reminder");
+    size_t count = get_all_type1_reminders(reminders, REMINDER_MAX_ID);
+    for (size_t i = 0; i < count; i++) {
+        int64_t start = esp_timer_get_time();
+        esp_err_t err = delete_reminder(reminders[i].Reminder_ID);
+        bench_op_sample(start, err == ESP_OK);
+    }
+    bench_op_end(&w);
+
+    json_write_array_end(&w);
+    json_write_object_end(&w);
+    json_writer_finish(&w);
+    free(reminders);
+    return ESP_OK;
+}
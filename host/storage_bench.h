@@ -0,0 +1,32 @@
+#ifndef STORAGE_BENCH_H
+#define STORAGE_BENCH_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "json_writer.h"
+
+// Set to 1 (the host CMake project does when it finds cJSON) to build the decoder
+// benchmarks, which use the cJSON DOM decoders of json_dom.c as the baseline.
+#ifndef STORAGE_BENCH_JSON
+#define STORAGE_BENCH_JSON 0
+#endif
+#define STORAGE_BENCH_NAMESPACE "Bench" // scratch namespace, erased after each run
+
+#if STORAGE_BENCH_JSON
+// Compares loading a task from a JSON string (nvs_get_str + parse_task_json_dom)
+// against loading the binary task_record_t (one nvs_get_blob).
+// Logs the average load latency and the bytes stored for both formats.
+void storage_bench_task_load(uint32_t iterations);
+
+// Compares the streaming task decoder (parse_task_json) against the cJSON DOM
+// decoder (parse_task_json_dom). Logs parses per second and heap use for both.
+void storage_bench_json_decode(uint32_t iterations);
+#endif
+
+// Production-scale storage benchmark: fills reminders, tasks, timetables and the
+// RFID map to their limits and reports throughput, latency percentiles and flash
+// writes of the main storage operations as one JSON document sent to sink.
+// Runs only on an empty (scratch) partition, ESP_ERR_INVALID_STATE otherwise.
+esp_err_t storage_bench_scale(json_sink_fn sink, void *ctx);
+
+#endif // STORAGE_BENCH_H
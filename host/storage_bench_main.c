@@ -0,0 +1,54 @@
+/*
+ * Host entry point for the production-scale storage benchmark, built by
+ * host/CMakeLists.txt. Writes one JSON document to the given file, or to stdout
+ * (where it is mixed with the log output):
+ *   ./storage_bench bench.json
+ *   ./storage_bench bench.json /tmp/bench_nvs.bin   (keep the partition in a file)
+ * The partition is a scratch one: in memory, or a file that must not exist yet. The
+ * benchmark refuses to run on a partition with data.
+ * With STORAGE_BENCH_JSON (cJSON found, host/json_dom.c linked) the task load and
+ * decoder benchmarks run first and log their results.
+ */
+#include <stdio.h>
+#include "json_parser.h"
+#include "storage_bench.h"
+#include "nvs_host.h"
+
+#define BENCH_PARTITION_SIZE 0x100000  // MyNvs size from partitions.csv
+
+static bool file_sink(void *ctx, const char *data, size_t len)
+{
+    return fwrite(data, 1, len, (FILE *)ctx) == len;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *out = stdout;
+    if (argc > 1 && (out = fopen(argv[1], "w")) == NULL) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    const char *nvs_path = argc > 2 ? argv[2] : NULL;
+    if (nvs_host_partition_add(NVS_PARTITION, nvs_path, BENCH_PARTITION_SIZE) != ESP_OK ||
+        nvs_flash_init_partition(NVS_PARTITION) != ESP_OK) {
+        fprintf(stderr, "Failed to set up the host NVS partition\n");
+        return 1;
+    }
+    if (rfid_map_init() != ESP_OK) {
+        fprintf(stderr, "Failed to load the RFID map\n");
+        return 1;
+    }
+#if STORAGE_BENCH_JSON
+    storage_bench_task_load(100);
+    storage_bench_json_decode(1000);
+#endif
+    esp_err_t err = storage_bench_scale(file_sink, out);
+    if (err == ESP_OK) {
+        fputc('\n', out);
+    }
+    if (out != stdout) {
+        fclose(out);
+    }
+    nvs_host_deinit();
+    return err == ESP_OK ? 0 : 1;
+}
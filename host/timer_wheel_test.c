@@ -0,0 +1,230 @@
+/*
+ * Unit test of main/alarm_execution/timer_wheel.c: deadlines around the level
+ * boundaries fire at their exact second, whether the wheel is advanced one second at
+ * a time, in one jump or from one timer_wheel_next_expiry() to the next, and
+ * cancelling, re-adding and re-arming from the callback work across a cascade:
+ *   ./timer_wheel_test
+ * Exits with 1 on the first difference.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "timer_wheel.h"
+
+#define CHECK(cond) do {                                                         \
+        if (!(cond)) {                                                           \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            return false;                                                        \
+        }                                                                        \
+    } while (0)
+
+#define TEST_START   1767603610u   // 2026-01-05 09:00:10 UTC, not aligned to any level
+#define TEST_SPAN    (1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_LEVEL_BITS))
+#define MAX_FIRED    16
+
+typedef struct {
+    timer_wheel_t *wheel;
+    int fired;
+    uint32_t fired_at[MAX_FIRED];
+    timer_wheel_entry_t *fired_entry[MAX_FIRED];
+    bool late;              // an entry fired at another second than its deadline
+    int rearm;              // re-arms left for rearm_fn
+    uint32_t rearm_delay;
+} fired_log_t;
+
+static void log_fn(timer_wheel_entry_t *entry, void *ctx)
+{
+    fired_log_t *log = ctx;
+    if (entry->expires != log->wheel->now) {
+        log->late = true;
+    }
+    if (log->fired < MAX_FIRED) {
+        log->fired_at[log->fired] = log->wheel->now;
+        log->fired_entry[log->fired] = entry;
+    }
+    log->fired++;
+}
+
+static void rearm_fn(timer_wheel_entry_t *entry, void *ctx)
+{
+    fired_log_t *log = ctx;
+    log_fn(entry, ctx);
+    if (log->rearm > 0) {
+        log->rearm--;
+        timer_wheel_add(log->wheel, entry, log->wheel->now + log->rearm_delay);
+    }
+}
+
+static void start(timer_wheel_t *wheel, fired_log_t *log, timer_wheel_fn fn)
+{
+    memset(log, 0, sizeof(*log));
+    log->wheel = wheel;
+    timer_wheel_init(wheel, TEST_START, fn, log);
+}
+
+// Offsets from TEST_START just below, at and above the level boundaries, plus the
+// snooze time (600 s, level 1).
+static const uint32_t offsets[] = {
+    1, 2, 63, 64, 65, 600, 4095, 4096, 4097, 262143, 262144, 262145,
+    TEST_SPAN - 1,
+};
+
+static bool test_step(uint32_t offset)
+{
+    timer_wheel_t wheel;
+    fired_log_t log;
+    timer_wheel_entry_t entry = { 0 };
+    start(&wheel, &log, log_fn);
+    timer_wheel_add(&wheel, &entry, TEST_START + offset);
+    for (uint32_t t = TEST_START + 1; t < TEST_START + offset; t++) {
+        timer_wheel_advance(&wheel, t);
+        CHECK(log.fired == 0);
+    }
+    timer_wheel_advance(&wheel, TEST_START + offset);
+    CHECK(log.fired == 1 && !log.late);
+    CHECK(!timer_wheel_pending(&entry));
+    CHECK(timer_wheel_next_expiry(&wheel) == TIMER_WHEEL_NONE);
+    return true;
+}
+
+static bool test_jump(uint32_t offset)
+{
+    timer_wheel_t wheel;
+    fired_log_t log;
+    timer_wheel_entry_t entry = { 0 };
+    start(&wheel, &log, log_fn);
+    timer_wheel_add(&wheel, &entry, TEST_START + offset);
+    timer_wheel_advance(&wheel, TEST_START + offset - 1);
+    CHECK(log.fired == 0 && timer_wheel_pending(&entry));
+    timer_wheel_advance(&wheel, TEST_START + offset + 100);
+    CHECK(log.fired == 1 && !log.late);
+    return true;
+}
+
+// Sleeps from one next expiry to the next, like the alarm task does.
+static bool test_next_expiry(uint32_t offset)
+{
+    timer_wheel_t wheel;
+    fired_log_t log;
+    timer_wheel_entry_t entry = { 0 };
+    start(&wheel, &log, log_fn);
+    timer_wheel_add(&wheel, &entry, TEST_START + offset);
+    int wakeups = 0;
+    while (log.fired == 0) {
+        time_t next = timer_wheel_next_expiry(&wheel);
+        CHECK(next != TIMER_WHEEL_NONE && (uint32_t)next > wheel.now);
+        CHECK((uint32_t)next <= TEST_START + offset);   // early, never late
+        if (offset < TEST_SPAN) {
+            CHECK((uint32_t)next == TEST_START + offset);  // exact within the span
+        }
+        timer_wheel_advance(&wheel, next);
+        CHECK(++wakeups <= TIMER_WHEEL_LEVELS);
+    }
+    CHECK(log.fired == 1 && !log.late && log.fired_at[0] == TEST_START + offset);
+    return true;
+}
+
+static bool test_order(void)
+{
+    timer_wheel_t wheel;
+    fired_log_t log;
+    timer_wheel_entry_t entries[5] = { 0 };
+    static const uint32_t deadlines[5] = { 4097, 65, 600, 64, 262145 };
+    start(&wheel, &log, log_fn);
+    for (int i = 0; i < 5; i++) {
+        timer_wheel_add(&wheel, &entries[i], TEST_START + deadlines[i]);
+    }
+    timer_wheel_advance(&wheel, TEST_START + 300000);
+    CHECK(log.fired == 5 && !log.late);
+    CHECK(log.fired_entry[0] == &entries[3] && log.fired_entry[1] == &entries[1] &&
+          log.fired_entry[2] == &entries[2] && log.fired_entry[3] == &entries[0] &&
+          log.fired_entry[4] == &entries[4]);
+    return true;
+}
+
+static bool test_past_deadline(void)
+{
+    timer_wheel_t wheel;
+    fired_log_t log;
+    timer_wheel_entry_t entry = { 0 };
+    start(&wheel, &log, log_fn);
+    timer_wheel_add(&wheel, &entry, TEST_START - 50);
+    CHECK(timer_wheel_next_expiry(&wheel) == (time_t)TEST_START + 1);
+    timer_wheel_advance(&wheel, TEST_START + 1);
+    CHECK(log.fired == 1 && log.fired_at[0] == TEST_START + 1);
+    return true;
+}
+
+// An entry cancelled after its bucket cascaded to level 0, and one re-added to a
+// later deadline after its first cascade, fire at their new time only.
+static bool test_cancel_across_cascade(void)
+{
+    timer_wheel_t wheel;
+    fired_log_t log;
+    timer_wheel_entry_t cancelled = { 0 }, moved = { 0 };
+    start(&wheel, &log, log_fn);
+    timer_wheel_add(&wheel, &cancelled, TEST_START + 600);
+    timer_wheel_add(&wheel, &moved, TEST_START + 5000);
+    timer_wheel_advance(&wheel, TEST_START + 590);      // both cascaded at least once
+    CHECK(log.fired == 0);
+    timer_wheel_cancel(&wheel, &cancelled);
+    CHECK(!timer_wheel_pending(&cancelled));
+    timer_wheel_cancel(&wheel, &cancelled);             // cancelling twice is harmless
+    timer_wheel_add(&wheel, &moved, TEST_START + 700);
+    CHECK(timer_wheel_next_expiry(&wheel) == (time_t)TEST_START + 700);
+    timer_wheel_advance(&wheel, TEST_START + 10000);
+    CHECK(log.fired == 1 && !log.late && log.fired_entry[0] == &moved);
+    CHECK(log.fired_at[0] == TEST_START + 700);
+    return true;
+}
+
+// A callback re-arming its entry one snooze later, repeatedly, across cascades.
+static bool test_rearm(void)
+{
+    timer_wheel_t wheel;
+    fired_log_t log;
+    timer_wheel_entry_t entry = { 0 };
+    start(&wheel, &log, rearm_fn);
+    log.rearm = 5;
+    log.rearm_delay = 600;
+    timer_wheel_add(&wheel, &entry, TEST_START + 10);
+    while (timer_wheel_next_expiry(&wheel) != TIMER_WHEEL_NONE) {
+        timer_wheel_advance(&wheel, timer_wheel_next_expiry(&wheel));
+    }
+    CHECK(log.fired == 6 && !log.late);
+    for (int i = 0; i < 6; i++) {
+        CHECK(log.fired_at[i] == TEST_START + 10 + (uint32_t)i * 600);
+    }
+    return true;
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+        if ((offsets[i] <= 4097 && !test_step(offsets[i])) || !test_jump(offsets[i]) ||
+            !test_next_expiry(offsets[i])) {
+            fprintf(stderr, "offset %u failed\n", (unsigned)offsets[i]);
+            return 1;
+        }
+    }
+    // Deadlines on a bucket boundary of each level, which cascade at their own second.
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        uint32_t size = 1u << (level * TIMER_WHEEL_LEVEL_BITS);
+        uint32_t offset = 2 * size - (TEST_START & (size - 1));
+        if ((offset <= 4097 && !test_step(offset)) || !test_jump(offset) ||
+            !test_next_expiry(offset)) {
+            fprintf(stderr, "aligned offset %u failed\n", (unsigned)offset);
+            return 1;
+        }
+    }
+    // Beyond the span the deadline waits in the last level and is placed again.
+    if (!test_jump(TEST_SPAN + 1000) || !test_next_expiry(TEST_SPAN + 1000)) {
+        fprintf(stderr, "offset beyond the span failed\n");
+        return 1;
+    }
+    if (!test_order() || !test_past_deadline() || !test_cancel_across_cascade() ||
+        !test_rearm()) {
+        return 1;
+    }
+    printf("timer wheel OK\n");
+    return 0;
+}
@@ -0,0 +1,397 @@
+#include "alarm_eval.h"
+#include "timer_wheel.h"
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "alarm_eval";
+
+#define EVAL_SLOTS (REMINDER_MAX_ID + 1)
+#define ID_BITMAP_WORDS ((UINT8_MAX + 1) / 32)
+
+// Resolved state of one reminder; indexed by Reminder_ID.
+typedef struct {
+    bool valid;                     // the reminder exists
+    bool usable;                    // its task and option resolved
+    bool active;                    // in a timeslot or in emergency at the last evaluation
+    bool in_emergency;              // emergency deadline reached
+    bool snoozed;                   // Time_Snoozed not reached yet
+    uint8_t priority;               // option priority
+    uint8_t effective_priority;     // priority, or EMERGENCY_PRIORITY in emergency
+    uint8_t timetable_count;
+    uint8_t timetable_ids[MAX_TASK_TIMESLOTS];
+    alarm_eval_reminder_t reminder;
+    time_t emergency_at;            // ALARM_NO_CHANGE if the option never escalates
+    time_t next_change;             // re-evaluate at or after this instant
+#if ALARM_STATS_ENABLED
+    time_t active_since;            // due instant of the current activity
+#endif
+    timer_wheel_entry_t emergency_timer;
+    timer_wheel_entry_t snooze_timer;
+} reminder_eval_t;
+
+static reminder_eval_t evals[EVAL_SLOTS];
+// Pending emergency deadlines and snooze expiries of all reminders.
+static timer_wheel_t deadlines;
+
+// Pending marks, written by the storage listener in the writer's task.
+static portMUX_TYPE mark_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t pending_reminders[ID_BITMAP_WORDS];
+static uint32_t pending_tasks[ID_BITMAP_WORDS];
+static uint32_t pending_timetables[ID_BITMAP_WORDS];
+static bool pending_any = true;     // so the first run applies pending_all
+static bool pending_all = true;     // first run loads everything
+
+// Aggregate of the last run, valid until next_change or the next mark.
+static alarm_eval_result_t cached_result;
+static bool cached_valid = false;
+
+static inline void bit_set(uint32_t *bitmap, int id)
+{
+    bitmap[id / 32] |= 1u << (id % 32);
+}
+
+static inline bool bit_test(const uint32_t *bitmap, int id)
+{
+    return (bitmap[id / 32] >> (id % 32)) & 1u;
+}
+
+void alarm_eval_mark(storage_change_t change, int id)
+{
+    if (id < 0 || id > UINT8_MAX) {
+        return;
+    }
+    taskENTER_CRITICAL(&mark_lock);
+    switch (change) {
+        case STORAGE_CHANGE_REMINDER:  bit_set(pending_reminders, id); break;
+        case STORAGE_CHANGE_TASK:      bit_set(pending_tasks, id); break;
+        case STORAGE_CHANGE_TIMETABLE: bit_set(pending_timetables, id); break;
+    }
+    pending_any = true;
+    taskEXIT_CRITICAL(&mark_lock);
+}
+
+void alarm_eval_mark_all(void)
+{
+    taskENTER_CRITICAL(&mark_lock);
+    pending_all = true;
+    pending_any = true;
+    taskEXIT_CRITICAL(&mark_lock);
+}
+
+/**
+ * @brief Wheel callback: a reminder's emergency deadline or snooze expiry is due.
+ */
+static void on_deadline(timer_wheel_entry_t *entry, void *ctx)
+{
+    reminder_eval_t *eval = &evals[((char *)entry - (char *)evals) / sizeof(reminder_eval_t)];
+    if (entry == &eval->emergency_timer) {
+        eval->in_emergency = true;
+        ESP_LOGI(TAG, "Reminder %d reached its emergency deadline", eval->reminder.Reminder_ID);
+    } else {
+        eval->snoozed = false;
+        ESP_LOGI(TAG, "Reminder %d snooze expired", eval->reminder.Reminder_ID);
+    }
+    // Any instant up to now makes this run evaluate it; the deadline itself keeps
+    // the due time for the lateness statistics.
+    eval->next_change = (time_t)entry->expires;
+}
+
+static void clear_eval(reminder_eval_t *eval)
+{
+    timer_wheel_cancel(&deadlines, &eval->emergency_timer);
+    timer_wheel_cancel(&deadlines, &eval->snooze_timer);
+    memset(eval, 0, sizeof(*eval));
+}
+
+/**
+ * @brief Resolves the time-independent part of a reminder: its task option, and
+ *        arms its emergency deadline and snooze expiry in the timer wheel.
+ *
+ * Takes the task from the object cache, so it costs at most one task load.
+ */
+static void resolve_reminder(reminder_eval_t *eval, const type1_reminder_t *reminder, time_t now)
+{
+    clear_eval(eval);
+    eval->valid = true;
+    eval->reminder.Reminder_ID = reminder->Reminder_ID;
+    eval->reminder.Task_ID = reminder->Task_ID;
+    eval->reminder.Task_Option_Selected = reminder->Task_Option_Selected;
+    eval->reminder.Task_Additional_Option_Selected = reminder->Task_Additional_Option_Selected;
+    eval->next_change = 0;  // evaluate on the next run
+    if (reminder->Time_Snoozed > now) {
+        eval->snoozed = true;
+        timer_wheel_add(&deadlines, &eval->snooze_timer, reminder->Time_Snoozed);
+    }
+
+    task_t task;
+    uint8_t option = reminder->Task_Option_Selected;
+    if (option >= TASK_MAX_OPTIONS || cache_get_task(reminder->Task_ID, &task) != ESP_OK) {
+        ESP_LOGW(TAG, "Task id %d for reminder %d not found", reminder->Task_ID, reminder->Reminder_ID);
+        return;
+    }
+    const task_option_t *opt = &task.Options[option];
+    eval->usable = true;
+    eval->priority = (uint8_t)opt->priority;
+    eval->timetable_count = opt->timeslot_count < MAX_TASK_TIMESLOTS ? opt->timeslot_count : MAX_TASK_TIMESLOTS;
+    memcpy(eval->timetable_ids, opt->timeslots, eval->timetable_count);
+    // A negative threshold never escalates (the old unsigned comparison never held).
+    eval->emergency_at = opt->days_till_em >= 0 ?
+                         reminder->Time_Created + (time_t)opt->days_till_em * 86400 : ALARM_NO_CHANGE;
+    // Reminders without timetables are never evaluated, so they never escalate either.
+    if (eval->emergency_at != ALARM_NO_CHANGE && eval->timetable_count > 0) {
+        if (now >= eval->emergency_at) {
+            eval->in_emergency = true;
+        } else {
+            timer_wheel_add(&deadlines, &eval->emergency_timer, eval->emergency_at);
+        }
+    }
+    ESP_LOGI(TAG, "Reminder %d resolved: %d timetable(s), priority %d, emergency threshold %d",
+             reminder->Reminder_ID, eval->timetable_count, eval->priority, opt->days_till_em);
+}
+
+static void reload_all(time_t now)
+{
+    // Restarting the wheel drops every entry, so the table can be cleared wholesale.
+    timer_wheel_init(&deadlines, now, on_deadline, NULL);
+    memset(evals, 0, sizeof(evals));
+    size_t num = get_num_of_reminders();
+    if (num == 0) {
+        return;
+    }
+    type1_reminder_t *all = malloc(num * sizeof(type1_reminder_t));
+    if (all == NULL) {
+        ESP_LOGE(TAG, "Memory allocation failed for reminders");
+        return;
+    }
+    num = get_all_type1_reminders(all, num);
+    for (size_t i = 0; i < num; i++) {
+        resolve_reminder(&evals[all[i].Reminder_ID], &all[i], now);
+    }
+    free(all);
+    ESP_LOGI(TAG, "Loaded %d reminder(s)", (int)num);
+}
+
+static void reload_reminder(int id, time_t now)
+{
+    type1_reminder_t reminder;
+    if (id > 0 && id <= REMINDER_MAX_ID && get_reminder_by_id((uint8_t)id, &reminder) == ESP_OK) {
+        resolve_reminder(&evals[id], &reminder, now);
+    } else if (id < EVAL_SLOTS) {
+        clear_eval(&evals[id]);  // deleted
+    }
+}
+
+static bool uses_pending_timetable(const reminder_eval_t *eval, const uint32_t *timetables)
+{
+    for (int j = 0; j < eval->timetable_count; j++) {
+        if (bit_test(timetables, eval->timetable_ids[j])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Takes the pending marks and applies them to the state table.
+ */
+static void apply_marks(time_t now)
+{
+    uint32_t reminders[ID_BITMAP_WORDS], tasks[ID_BITMAP_WORDS], timetables[ID_BITMAP_WORDS];
+    taskENTER_CRITICAL(&mark_lock);
+    bool all = pending_all;
+    memcpy(reminders, pending_reminders, sizeof(reminders));
+    memcpy(tasks, pending_tasks, sizeof(tasks));
+    memcpy(timetables, pending_timetables, sizeof(timetables));
+    memset(pending_reminders, 0, sizeof(pending_reminders));
+    memset(pending_tasks, 0, sizeof(pending_tasks));
+    memset(pending_timetables, 0, sizeof(pending_timetables));
+    pending_all = false;
+    pending_any = false;
+    taskEXIT_CRITICAL(&mark_lock);
+
+    if (all) {
+        reload_all(now);
+        return;
+    }
+    for (int id = 0; id < EVAL_SLOTS; id++) {
+        reminder_eval_t *eval = &evals[id];
+        if (bit_test(reminders, id) || (eval->valid && bit_test(tasks, eval->reminder.Task_ID))) {
+            // The reminder itself or its task changed: resolve again.
+            reload_reminder(id, now);
+        } else if (eval->valid && uses_pending_timetable(eval, timetables)) {
+            eval->next_change = 0;
+        }
+    }
+}
+
+/**
+ * @brief Evaluates the time-dependent part of one reminder at now.
+ *
+ * Timetable schedules come from the object cache, so this reads NVS only on a miss.
+ * Emergency and snooze changes are not looked for here: the timer wheel reports them.
+ */
+static void evaluate_reminder(reminder_eval_t *eval, time_t now, const struct tm *local)
+{
+    if (eval->snoozed) {
+        // Nothing to do until the snooze timer fires.
+        eval->active = false;
+        eval->next_change = ALARM_NO_CHANGE;
+        ESP_LOGI(TAG, "Reminder %d is snoozed", eval->reminder.Reminder_ID);
+        return;
+    }
+    bool in_timeslot = false;
+    time_t next_change = ALARM_NO_CHANGE;
+    for (int j = 0; j < eval->timetable_count; j++) {
+        timetable_schedule_t schedule;
+        if (cache_get_timetable_schedule(eval->timetable_ids[j], &schedule) != ESP_OK) {
+            ESP_LOGW(TAG, "Timetable %d not loaded for reminder %d", eval->timetable_ids[j], eval->reminder.Reminder_ID);
+            continue;
+        }
+        in_timeslot |= timetable_schedule_is_active(&schedule, local);
+        time_t change = timetable_schedule_next_change(&schedule, now, local);
+        if (change != ALARM_NO_CHANGE && (next_change == ALARM_NO_CHANGE || change < next_change)) {
+            next_change = change;
+        }
+    }
+    bool in_emergency = eval->in_emergency;
+#if ALARM_STATS_ENABLED
+    if ((in_timeslot || in_emergency) && !eval->active) {
+        // The instant this evaluation was scheduled for; 0 after a reload or a mark.
+        eval->active_since = eval->next_change > 0 ? eval->next_change : now;
+    }
+#endif
+    eval->active = in_timeslot || in_emergency;
+    eval->effective_priority = in_emergency ? EMERGENCY_PRIORITY : eval->priority;
+    eval->next_change = next_change;
+    ESP_LOGI(TAG, "Reminder %d is %s%s", eval->reminder.Reminder_ID, eval->active ? "active" : "inactive",
+             in_emergency ? " (emergency)" : "");
+}
+
+/**
+ * @brief True if a ranks before b: higher priority, then lower Reminder_ID.
+ */
+static inline bool ranks_before(const alarm_eval_entry_t *a, const alarm_eval_entry_t *b)
+{
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    return a->reminder.Reminder_ID < b->reminder.Reminder_ID;
+}
+
+// Bounded heap of the best entries seen so far; the root is the worst of them.
+typedef struct {
+    uint8_t size;
+    alarm_eval_entry_t items[ALARM_EVAL_TOP_K];
+} top_k_heap_t;
+
+static void heap_sift_down(top_k_heap_t *heap, int i)
+{
+    while (1) {
+        int worst = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < heap->size && ranks_before(&heap->items[worst], &heap->items[left])) {
+            worst = left;
+        }
+        if (right < heap->size && ranks_before(&heap->items[worst], &heap->items[right])) {
+            worst = right;
+        }
+        if (worst == i) {
+            return;
+        }
+        alarm_eval_entry_t tmp = heap->items[i];
+        heap->items[i] = heap->items[worst];
+        heap->items[worst] = tmp;
+        i = worst;
+    }
+}
+
+static void heap_offer(top_k_heap_t *heap, const alarm_eval_entry_t *entry)
+{
+    if (heap->size < ALARM_EVAL_TOP_K) {
+        int i = heap->size++;
+        heap->items[i] = *entry;
+        // Sift up while the parent ranks before the new entry.
+        while (i > 0 && ranks_before(&heap->items[(i - 1) / 2], &heap->items[i])) {
+            alarm_eval_entry_t tmp = heap->items[i];
+            heap->items[i] = heap->items[(i - 1) / 2];
+            heap->items[(i - 1) / 2] = tmp;
+            i = (i - 1) / 2;
+        }
+    } else if (ranks_before(entry, &heap->items[0])) {
+        heap->items[0] = *entry;
+        heap_sift_down(heap, 0);
+    }
+}
+
+/**
+ * @brief Empties the heap into ranked, best first.
+ */
+static uint8_t heap_drain(top_k_heap_t *heap, alarm_eval_entry_t *ranked)
+{
+    uint8_t count = heap->size;
+    while (heap->size > 0) {
+        ranked[heap->size - 1] = heap->items[0];
+        heap->items[0] = heap->items[--heap->size];
+        heap_sift_down(heap, 0);
+    }
+    return count;
+}
+
+void alarm_eval_run(time_t now, const struct tm *local, alarm_eval_result_t *result)
+{
+    taskENTER_CRITICAL(&mark_lock);
+    bool marked = pending_any;
+    taskEXIT_CRITICAL(&mark_lock);
+
+    if (!marked && cached_valid &&
+        (cached_result.next_change == ALARM_NO_CHANGE || now < cached_result.next_change)) {
+        *result = cached_result;
+        ALARM_STATS_RECORD(ALARM_STATS_EVALUATED, 0);
+        return;
+    }
+    if (marked) {
+        apply_marks(now);
+    }
+    timer_wheel_advance(&deadlines, now);
+
+    alarm_eval_result_t out = { .count = 0, .next_change = ALARM_NO_CHANGE };
+    top_k_heap_t heap = { .size = 0 };
+    int evaluated = 0;
+    for (int id = 0; id < EVAL_SLOTS; id++) {
+        reminder_eval_t *eval = &evals[id];
+        if (!eval->valid || !eval->usable) {
+            continue;
+        }
+        if (eval->next_change != ALARM_NO_CHANGE && now >= eval->next_change) {
+            evaluate_reminder(eval, now, local);
+            evaluated++;
+        }
+        if (eval->next_change != ALARM_NO_CHANGE &&
+            (out.next_change == ALARM_NO_CHANGE || eval->next_change < out.next_change)) {
+            out.next_change = eval->next_change;
+        }
+        // Priority 0 never fired before ranking (strict comparison against 0).
+        if (eval->active && eval->effective_priority > 0) {
+            alarm_eval_entry_t entry = { .priority = eval->effective_priority, .reminder = eval->reminder };
+#if ALARM_STATS_ENABLED
+            entry.active_since = eval->active_since;
+#endif
+            heap_offer(&heap, &entry);
+        }
+    }
+    out.count = heap_drain(&heap, out.ranked);
+    ALARM_STATS_RECORD(ALARM_STATS_EVALUATED, evaluated);
+    time_t deadline = timer_wheel_next_expiry(&deadlines);
+    if (deadline != TIMER_WHEEL_NONE && (out.next_change == ALARM_NO_CHANGE || deadline < out.next_change)) {
+        out.next_change = deadline;
+    }
+    if (evaluated > 0) {
+        ESP_LOGI(TAG, "Evaluated %d reminder(s)", evaluated);
+        cache_log_stats();
+    }
+    cached_result = out;
+    cached_valid = true;
+    *result = out;
+}
@@ -0,0 +1,69 @@
+#ifndef ALARM_EVAL_H
+#define ALARM_EVAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include "json_parser.h"   // for type1_reminder_t, storage_change_t
+#include "alarm_stats.h"
+
+#define EMERGENCY_PRIORITY 3 // Priority level for emergency reminders
+#define ALARM_NO_CHANGE    TIMETABLE_NO_CHANGE  // no state change ahead
+#define ALARM_EVAL_TOP_K   4    // active reminders ranked per run
+
+/*
+ * Incremental reminder evaluation.
+ *
+ * Every reminder keeps its resolved evaluation state in RAM: task option priority,
+ * emergency deadline (Time_Created + days_till_em days), the timetable ids of the
+ * selected option, and its current activity with the instant that activity can next
+ * change. Mutations only mark what they touched (a reminder, a task or a timetable);
+ * the next alarm_eval_run() re-resolves just the reminders affected by them and
+ * re-evaluates only those whose next change has passed.
+ *
+ * Emergency deadlines and snooze expiries (Time_Snoozed) sit in a timer wheel (see
+ * timer_wheel.h) from the moment a reminder is resolved; they cost nothing until the
+ * wheel fires them, which flags the reminder and re-evaluates it on that run. A
+ * snoozed reminder is inactive and skips its timetables until the snooze expires.
+ *
+ * A run with nothing marked and no change due returns the cached result in O(1),
+ * without reading NVS. The state table is static: (REMINDER_MAX_ID + 1) * 72 bytes
+ * on the target (80 with ALARM_STATS_ENABLED), plus about 1 KB of wheel buckets.
+ *
+ * Each run ranks the active reminders in the same pass over the state table, keeping
+ * the best ALARM_EVAL_TOP_K in a bounded heap: highest priority first, ties to the
+ * lowest Reminder_ID.
+ */
+
+// Snapshot of the reminder fields the action needs, so firing does not read NVS.
+typedef struct {
+    uint8_t Reminder_ID;
+    uint8_t Task_ID;
+    uint8_t Task_Option_Selected;
+    uint8_t Task_Additional_Option_Selected;
+} alarm_eval_reminder_t;
+
+typedef struct {
+    uint8_t priority;               // EMERGENCY_PRIORITY when in emergency
+    alarm_eval_reminder_t reminder;
+#if ALARM_STATS_ENABLED
+    time_t active_since;            // instant the reminder became due (lateness statistics)
+#endif
+} alarm_eval_entry_t;
+
+typedef struct {
+    uint8_t count;                  // active reminders in ranked, 0 if none
+    alarm_eval_entry_t ranked[ALARM_EVAL_TOP_K];  // best first
+    time_t next_change;             // next instant any reminder can change state, or ALARM_NO_CHANGE
+} alarm_eval_result_t;
+
+// Records a storage change. Non-blocking, safe from any task (storage listener).
+void alarm_eval_mark(storage_change_t change, int id);
+// Forces a full rebuild from NVS on the next run (start-up, clock jumps).
+void alarm_eval_mark_all(void);
+
+// Brings the evaluation state up to date for now (local time local) and returns the
+// best ranked active reminders. Must only be called from one task.
+void alarm_eval_run(time_t now, const struct tm *local, alarm_eval_result_t *result);
+
+#endif // ALARM_EVAL_H
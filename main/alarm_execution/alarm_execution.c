@@ -4,11 +4,20 @@
 static const char *TAG = "alarm_execution";
 
 
+//---------------------------------------------------------------------
+// Scheduler configuration.
+#define ALARM_MAX_SLEEP_S 3600          // longest sleep without a known next change
+#define ALARM_DISPLAY_MS 30000          // screen time of one notification
+#define ALARM_ACTION_POLL_MS 1000       // check period of a covered notification
+#define ALARM_ROTATE_MS 5000            // time per reminder when several are active
+
+// Task notification bits of the alarm task.
+#define ALARM_NOTIFY_EVALUATE (1u << 0)  // storage change or clock sync
+#define ALARM_NOTIFY_SNOOZE   (1u << 1)  // snooze the notification's reminders
+
 //---------------------------------------------------------------------
 // Module-level static pointers set during initialization.
 static QueueHandle_t my_chirpQueue    = NULL;
-static SemaphoreHandle_t my_display_mutex = NULL;
-static u8g2_t *my_u8g2_ptr           = NULL;
 
 //---------------------------------------------------------------------
 // Priority configuration structure for LED/chirp/display settings.
@@ -42,183 +51,226 @@ static const priority_config_t* get_priority_configs(void)
 //---------------------------------------------------------------------
 // Helper functions assume that timetable_t and type1_reminder_t are defined in json_parser.h.
 
-// Checks if the given timetable has any active timeslot for the current time.
-static bool check_timeslot_active(const timetable_t *timetable)
+// Lowers *next_change to candidate if candidate is an earlier future instant.
+static void note_change(time_t *next_change, time_t candidate)
 {
-    if(timetable == NULL) return false;
-    time_t now = time(NULL);
-    struct tm *tm_info = localtime(&now);
-    if(tm_info == NULL) return false;
-    int current_time = tm_info->tm_hour * 100 + tm_info->tm_min;
-    for (int i = 0; i < timetable->times_count; i++) {
-        if (current_time >= timetable->Times_active[i].Start_time &&
-            current_time < timetable->Times_active[i].End_time) {
-            ESP_LOGI(TAG, "Current time (%d) within timeslot [%d, %d]", current_time,
-                     timetable->Times_active[i].Start_time, timetable->Times_active[i].End_time);
-            return true;
-        }
+    if (next_change != NULL && candidate != ALARM_NO_CHANGE &&
+        (*next_change == ALARM_NO_CHANGE || candidate < *next_change)) {
+        *next_change = candidate;
     }
-    return false;
 }
 
 /**
- * Loads a timetable using retrieve_timetable_json and parse_timetable_json.
+ * Loads the compiled weekly schedule of a timetable through the object cache
+ * (NVS is only read and the schedule only compiled on a miss).
  *
- * @param id        Timetable id.
- * @param timetable Pointer to timetable_t to fill.
+ * @param id       Timetable id.
+ * @param schedule Pointer to timetable_schedule_t to fill.
  * @return true on success, false otherwise.
  */
-static bool load_timetable(int id, timetable_t *timetable)
+static bool load_schedule_cached(int id, timetable_schedule_t *schedule)
 {
-    ESP_LOGI(TAG, "Loading timetable for id %d", id);
-    char *json_str = retrieve_timetable_json(id);
-    if (json_str == NULL) {
+    esp_err_t err = cache_get_timetable_schedule(id, schedule);
+    if (err != ESP_OK) {
         ESP_LOGW(TAG, "No timetable found for id %d", id);
         return false;
     }
-    bool res = parse_timetable_json(json_str, timetable);
-    free(json_str);
-    ESP_LOGI(TAG, "Timetable id %d loaded: %s", id, res ? "success" : "failure");
-    return res;
+    return true;
 }
 
+//---------------------------------------------------------------------
+// Notification action state machine.
+//
+// An action sets the LED, sends the chirp and posts the notification screen to the
+// display compositor with ALARM_DISPLAY_MS of screen time. The compositor owns the
+// display: user screens cover the notification, whose time only runs while it is on
+// top, and it comes back by itself when they are gone. The alarm task never waits
+// for the display.
+//
+// With several reminders active, the screen rotates through the ranked pages every
+// ALARM_ROTATE_MS while it is visible. All pages are formatted when the action
+// starts, so the rotation itself never touches storage.
+typedef enum {
+    ACTION_IDLE,        // nothing to show
+    ACTION_ACTIVE,      // notification posted, screen time left
+} action_state_t;
+
+typedef struct {
+    action_state_t state;
+    uint8_t page_count;     // ranked reminders on the screen
+    uint8_t page;           // page currently posted
+    uint8_t page_ids[ALARM_EVAL_TOP_K];  // Reminder_ID of each page
+    display_content_t pages[ALARM_EVAL_TOP_K];
+    bool visible;           // on top at the last step
+    int64_t remaining_us;   // screen time left, as far as the alarm task has seen
+    int64_t stepped_at_us;  // alarm_port_time_us() at the last step
+    int64_t page_shown_us;  // screen time of the current page
+#if ALARM_STATS_ENABLED
+    bool seen;              // has been on top at least once
+    int64_t posted_at_us;   // alarm_port_time_us() when the notification was posted
+#endif
+} alarm_action_t;
+
+static alarm_action_t action = { .state = ACTION_IDLE };
+
+// Scheduler state carried from one pass to the next.
+static time_t quiet_until = 0;  // no new action before this instant (display interval)
+static uint32_t notified = 0;   // notification bits received by the last wait
+#if ALARM_STATS_ENABLED
+static time_t dnd_until = 0;    // end of the last Do Not Disturb period seen
+
 /**
- * Checks all reminders and returns the highest priority active reminder.
- *
- * For each reminder, its associated task is loaded using get_task_by_id.
- * Using the reminder’s Task_Option_Selected, the emergency threshold (days_till_em)
- * and the option priority are loaded.
- * A reminder is active if its timetable is active or if the elapsed days have reached
- * the emergency threshold. If the reminder is in emergency status it is assigned
- * the EMERGENCY_PRIORITY.
- *
- * @param active_priority Output: highest active priority (lower value means higher priority).
- *                        Set to 0 if none active.
- * @param active_reminder Output: first active reminder with the highest priority.
- * @return true if an active reminder is found, false otherwise.
+ * Instant the notification for eval was first owed: when its earliest ranked
+ * reminder became due, but not before the display interval or Do Not Disturb ended.
  */
-static bool check_active_reminders(uint8_t *active_priority, type1_reminder_t *active_reminder)
+static time_t action_due(const alarm_eval_result_t *eval, time_t quiet)
 {
-    task_t *task = NULL;
-    ESP_LOGI(TAG, "Checking active reminders");
-    size_t num = get_num_of_reminders();
-    if(num == 0) {
-        ESP_LOGI(TAG, "No reminders found");
-        return false;
+    time_t due = eval->ranked[0].active_since;
+    for (int i = 1; i < eval->count; i++) {
+        if (eval->ranked[i].active_since < due) {
+            due = eval->ranked[i].active_since;
+        }
+    }
+    if (quiet > due) {
+        due = quiet;
     }
+    return dnd_until > due ? dnd_until : due;
+}
+#endif
 
-    type1_reminder_t *all = malloc(num * sizeof(type1_reminder_t));
-    if(all == NULL) {
-        ESP_LOGE(TAG, "Memory allocation failed for reminders");
-        return false;
+/**
+ * Builds the notification text for one ranked reminder (page of page_count).
+ */
+static void format_reminder_lines(const alarm_eval_reminder_t *active_reminder, int page, int page_count,
+                                  display_content_t *content)
+{
+    char (*lines)[DISPLAY_LINE_LEN] = content->lines;
+    content->layout = DISPLAY_LAYOUT_MESSAGE;
+    content->center = true;
+    content->selected = -1;
+    //active reminder id
+    if (page_count > 1) {
+        snprintf(lines[0], DISPLAY_LINE_LEN, "Reminder %d (%d/%d)", active_reminder->Reminder_ID, page + 1, page_count);
+    } else {
+        snprintf(lines[0], DISPLAY_LINE_LEN, "Reminder %d active", active_reminder->Reminder_ID);
     }
-    num = get_all_type1_reminders(all, num);
-    ESP_LOGI(TAG, "Found %d reminder(s)", (int)num);
-
-    const priority_config_t *default_configs = get_priority_configs();
-    bool found = false;
-    uint8_t current_best_priority = 0;
-    time_t now = time(NULL);
-
-    for (size_t i = 0; i < num; i++) {
-        ESP_LOGI(TAG, "Processing reminder with ID %d", all[i].Reminder_ID);
-        //get task from reminder
-        uint8_t task_option_selected = all[i].Task_Option_Selected;
-        task = get_task_by_id(all[i].Task_ID);
-
-        //get number of timetables
-        uint8_t num_timetables = task->Options[task_option_selected].timeslot_count;
-        ESP_LOGI(TAG, "Reminder %d has %d timetables", all[i].Reminder_ID, num_timetables);
-        //go through all timetables to find 1 that is active
-        for(uint8_t j = 0; j < num_timetables; j++) {
-            uint8_t timetableID = task->Options[task_option_selected].timeslots[j];
-            ESP_LOGI(TAG, "Reminder %d timetable %d: %d", all[i].Reminder_ID, j, timetableID);
-            timetable_t timetable;
-            bool timetable_loaded = load_timetable(timetableID, &timetable);
-
-            bool active_in_timeslot = timetable_loaded && check_timeslot_active(&timetable);
-            if (!timetable_loaded) {
-                ESP_LOGW(TAG, "Timetable not loaded for reminder %d", all[i].Reminder_ID);
-            }
-            // If the timetable is loaded, additionally log the active timeslot(s) for this reminder.
-            if(timetable_loaded) {
-                struct tm *tm_info = localtime(&now);
-                if(tm_info != NULL) {
-                    int current_time = tm_info->tm_hour * 100 + tm_info->tm_min;
-                    for (int j = 0; j < timetable.times_count; j++) {
-                        if (current_time >= timetable.Times_active[j].Start_time &&
-                            current_time < timetable.Times_active[j].End_time) {
-                            ESP_LOGI(TAG, "Reminder %d active timeslot: [%d, %d]",
-                                     all[i].Reminder_ID,
-                                     timetable.Times_active[j].Start_time,
-                                     timetable.Times_active[j].End_time);
-                        }
-                        else {
-                            ESP_LOGI(TAG, "Reminder %d inactive timeslot: [%d, %d]",
-                                     all[i].Reminder_ID,
-                                     timetable.Times_active[j].Start_time,
-                                     timetable.Times_active[j].End_time);
-                        }
-                    }
-                }
-            }
+    //reminder task name
+    task_t task_buffer;
+    task_t *task = (cache_get_task(active_reminder->Task_ID, &task_buffer) == ESP_OK) ? &task_buffer : NULL;
+    if(task != NULL) {
+        snprintf(lines[1], DISPLAY_LINE_LEN, "T: %s", task->Name);
+    } else {
+        snprintf(lines[1], DISPLAY_LINE_LEN, "Task ID: %d", active_reminder->Task_ID);
+    }
+    //reminder task option text
+    if(task != NULL && active_reminder->Task_Option_Selected < TASK_MAX_OPTIONS) {
+        snprintf(lines[2], DISPLAY_LINE_LEN, "O: %s",
+                 task->Options[active_reminder->Task_Option_Selected].display_text);
+    } else {
+        snprintf(lines[2], DISPLAY_LINE_LEN, "Option: %d", active_reminder->Task_Option_Selected);
+    }
+    //aditional options number
+    snprintf(lines[3], DISPLAY_LINE_LEN, "Add. Options: %d", active_reminder->Task_Additional_Option_Selected);
+}
 
-            int option_threshold = 0; //treshold of days til emergency
-            int option_priority = 255;
-            if (task != NULL) {
-                int opt_index = all[i].Task_Option_Selected;
-                if(opt_index >= 0 && opt_index < TASK_MAX_OPTIONS) {
-                    option_threshold = task->Options[opt_index].days_till_em;
-                    option_priority = task->Options[opt_index].priority;
-                    ESP_LOGI(TAG, "Reminder %d task option emergency threshold: %d, priority: %d",
-                            all[i].Reminder_ID, option_threshold, option_priority);
-                }
-
-            } else {
-                ESP_LOGW(TAG, "Task id %d for reminder %d not found", all[i].Task_ID, all[i].Reminder_ID);
-            }
+/**
+ * Takes the notification off the display.
+ */
+static void action_release(void)
+{
+    if (action.state == ACTION_IDLE) {
+        return;
+    }
+    display_remove(DISPLAY_SCREEN_NOTIFICATION);
+    action.state = ACTION_IDLE;
+}
 
-            double diff_seconds = difftime(now, all[i].Time_Created);
-            uint32_t diff_days = diff_seconds / 86400;
-            bool is_emergency = diff_days >= (uint32_t)option_threshold;
-            ESP_LOGI(TAG, "Reminder %d: diff_days=%d, is_emergency=%s",
-                    (int)all[i].Reminder_ID, (int)diff_days, is_emergency ? "true" : "false");
-
-            if (active_in_timeslot || is_emergency) {
-                uint8_t prio = is_emergency ? EMERGENCY_PRIORITY : (uint8_t)option_priority;
-                if (prio > current_best_priority) {
-                    current_best_priority = prio;
-                    if(active_reminder != NULL) {
-                        *active_reminder = all[i];
-                    }
-                    found = true;
-                    ESP_LOGI(TAG, "Active reminder found: ID %d with priority %d",
-                            all[i].Reminder_ID, prio);
-                }
-            }
+/**
+ * Follows the notification on the compositor: notices its end, rotates to the next
+ * page and keeps track of the screen time it had.
+ */
+static void action_step(void)
+{
+    if (action.state != ACTION_ACTIVE) {
+        return;
+    }
+    int64_t now_us = alarm_port_time_us();
+    if (!display_screen_active(DISPLAY_SCREEN_NOTIFICATION)) {
+#if ALARM_STATS_ENABLED
+        if (!action.seen) {
+            // Ran its time between two steps; it was on top at least then.
+            ALARM_STATS_RECORD(ALARM_STATS_DISPLAY_WAIT_US, action.visible ? 0 : now_us - action.posted_at_us);
         }
+#endif
+        action.state = ACTION_IDLE;
+        ESP_LOGI(TAG, "Action execution completed for %d reminder(s), first: %s",
+                 action.page_count, action.pages[0].lines[1]);
+        return;
+    }
+    if (action.visible) {
+        action.remaining_us -= now_us - action.stepped_at_us;
+        action.page_shown_us += now_us - action.stepped_at_us;
+    }
+    action.stepped_at_us = now_us;
+
+    bool visible = display_screen_visible(DISPLAY_SCREEN_NOTIFICATION);
+#if ALARM_STATS_ENABLED
+    if (visible && !action.seen) {
+        action.seen = true;
+        // On top at the first look: it did not wait for the display.
+        ALARM_STATS_RECORD(ALARM_STATS_DISPLAY_WAIT_US, action.visible ? 0 : now_us - action.posted_at_us);
+    } else if (!visible) {
+        ALARM_STATS_COUNT(action.seen && action.visible ? ALARM_STATS_PREEMPTIONS : ALARM_STATS_DISPLAY_BUSY);
+    }
+#endif
+    if (!visible && action.visible) {
+        ESP_LOGI(TAG, "Notification covered, %lld ms left", (long long)(action.remaining_us / 1000));
+    }
+    action.visible = visible;
+
+    if (visible && action.page_count > 1 && action.page_shown_us >= (int64_t)ALARM_ROTATE_MS * 1000) {
+        action.page = (uint8_t)((action.page + 1) % action.page_count);
+        action.page_shown_us = 0;
+        display_update(DISPLAY_SCREEN_NOTIFICATION, &action.pages[action.page]);
     }
-    if(task != NULL) free(task);
-    free(all);
-    if(found && active_priority) {
-        *active_priority = current_best_priority;
-        ESP_LOGI(TAG, "Highest active priority set to %d", current_best_priority);
+}
+
+/**
+ * Milliseconds until the action needs the task again, or -1 if it does not.
+ */
+static int64_t action_timeout_ms(void)
+{
+    if (action.state != ACTION_ACTIVE) {
+        return -1;
+    }
+    if (!action.visible || action.remaining_us <= 0) {
+        // Covered, or the compositor has not dropped it yet: check back later.
+        return ALARM_ACTION_POLL_MS;
+    }
+    int64_t left_us = action.remaining_us;
+    if (action.page_count > 1) {
+        int64_t to_rotate_us = (int64_t)ALARM_ROTATE_MS * 1000 - action.page_shown_us;
+        if (to_rotate_us < left_us) {
+            left_us = to_rotate_us;
+        }
     }
-    return found;
+    return left_us > 0 ? (left_us + 999) / 1000 : 0;
 }
 
 /**
- * Executes configured actions for an active reminder.
+ * Starts the configured actions for the active reminders.
  *
- * Sets the LED (using default values from configuration),
- * sends a chirp, and displays a reminder message for 30 seconds.
+ * Sets the LED (using default values from configuration for the best ranked
+ * reminder), sends a chirp and posts the ranked reminders to the display compositor
+ * with ALARM_DISPLAY_MS of screen time. Returns immediately.
  *
- * @param priority     The active reminder's priority (from task option; 1 is highest).
- * @param reminder_msg The message to display.
+ * @param eval Evaluation result with at least one active reminder.
  */
-static void execute_priority_action(uint8_t priority, const char *reminder_msg_line1,const char *reminder_msg_line2,const char *reminder_msg_line3,const char *reminder_msg_line4)
+static void start_priority_action(const alarm_eval_result_t *eval)
 {
-    ESP_LOGI(TAG, "Executing action for priority %d", priority);
+    uint8_t priority = eval->ranked[0].priority;
+    ESP_LOGI(TAG, "%d active reminder(s), first ID: %d, Priority: %d",
+             eval->count, eval->ranked[0].reminder.Reminder_ID, priority);
     const priority_config_t *configs = get_priority_configs();
     uint8_t idx = (priority > 0 && priority < 4) ? priority - 1 : 2;
     ESP_LOGI(TAG, "Action config: LED[%d, %d, %d], Chirp ID %d",
@@ -227,105 +279,230 @@ static void execute_priority_action(uint8_t priority, const char *reminder_msg_l
     set_led(configs[idx].default_led_red, configs[idx].default_led_green, configs[idx].default_led_blue);
     SEND_CHIRP(my_chirpQueue, configs[idx].default_chirp_id);
 
-    // Display the reminder message for 30 seconds if the display is available.
-    if(xSemaphoreTake(my_display_mutex, pdMS_TO_TICKS(1000))) {
-        display_message(my_u8g2_ptr, get_wifi_status(), get_time_validity(),
-                        reminder_msg_line1, reminder_msg_line2, reminder_msg_line3, reminder_msg_line4, 1);
-        vTaskDelay(pdMS_TO_TICKS(30000));
-        xSemaphoreGive(my_display_mutex);
+    // Showing the screen again replaces a notification still on it.
+    action.page_count = eval->count;
+    for (int i = 0; i < eval->count; i++) {
+        action.page_ids[i] = eval->ranked[i].reminder.Reminder_ID;
+        format_reminder_lines(&eval->ranked[i].reminder, i, eval->count, &action.pages[i]);
+    }
+    action.page = 0;
+    action.page_shown_us = 0;
+    action.remaining_us = (int64_t)ALARM_DISPLAY_MS * 1000;
+    action.stepped_at_us = alarm_port_time_us();
+    action.visible = true;  // the compositor puts it on top unless a user screen is up
+#if ALARM_STATS_ENABLED
+    action.seen = false;
+    action.posted_at_us = action.stepped_at_us;
+#endif
+    ALARM_STATS_COUNT(ALARM_STATS_ACTIONS);
+    if (display_show(DISPLAY_SCREEN_NOTIFICATION, DISPLAY_PRIORITY_NOTIFICATION, ALARM_DISPLAY_MS,
+                     &action.pages[0]) == ESP_OK) {
+        action.state = ACTION_ACTIVE;
+    } else {
+        ESP_LOGW(TAG, "Notification could not be posted to the display");
+        action.state = ACTION_IDLE;
+    }
+}
+
+/**
+ * Snoozes every reminder of the pending action until now + ALARM_SNOOZE_S and ends it.
+ * The next action may start at the end of the snooze at the latest.
+ *
+ * The storage update reaches the evaluator through the storage listener, which
+ * arms the snooze timers; the task is notified and re-evaluates right away.
+ */
+static void snooze_action(time_t now)
+{
+    if (action.state == ACTION_IDLE) {
+        return;
+    }
+    for (int i = 0; i < action.page_count; i++) {
+        type1_reminder_t reminder;
+        if (get_reminder_by_id(action.page_ids[i], &reminder) != ESP_OK) {
+            continue;  // deleted meanwhile
+        }
+        reminder.Time_Snoozed = now + ALARM_SNOOZE_S;
+        esp_err_t err = update_type1_reminder(&reminder);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to snooze reminder %d: %s", reminder.Reminder_ID, esp_err_to_name(err));
+        } else {
+            ESP_LOGI(TAG, "Reminder %d snoozed for %d s", reminder.Reminder_ID, ALARM_SNOOZE_S);
+        }
+    }
+    action_release();
+    set_led(0, 0, 0);
+    // The snoozed reminders come back when their snooze ends, even if the display
+    // interval of the action they were on is longer.
+    if (quiet_until > now + ALARM_SNOOZE_S) {
+        quiet_until = now + ALARM_SNOOZE_S;
+    }
+    ALARM_STATS_COUNT(ALARM_STATS_SNOOZES);
+}
+
+/**
+ * Blocks until next_change, the next action step, or a task notification.
+ *
+ * Without a known next change the task still wakes after ALARM_MAX_SLEEP_S, which
+ * also bounds the error after DST switches or clock corrections made without a sync.
+ *
+ * @return The notification bits received (0 on timeout).
+ */
+static uint32_t wait_for_change(time_t now, time_t next_change)
+{
+    time_t sleep_s = ALARM_MAX_SLEEP_S;
+    if (next_change != ALARM_NO_CHANGE && next_change - now < sleep_s) {
+        sleep_s = next_change > now ? next_change - now : 0;
     }
+    int64_t sleep_ms = (int64_t)sleep_s * 1000;
+    int64_t action_ms = action_timeout_ms();
+    if (action_ms >= 0 && action_ms < sleep_ms) {
+        sleep_ms = action_ms;
+    }
+    ESP_LOGI(TAG, "Next evaluation in %lld ms", (long long)sleep_ms);
+    ALARM_STATS_CYCLE_END();
+    uint32_t bits = alarm_port_wait((uint32_t)sleep_ms);
+    if (bits) {
+        ALARM_STATS_COUNT(ALARM_STATS_NOTIFIED);
+    }
+    return bits;
+}
 
+/**
+ * Storage listener: any reminder, task or timetable change can move the next due
+ * instant, so the scheduler re-evaluates right away.
+ */
+static void on_storage_change(storage_change_t change, int id, void *ctx)
+{
+    ESP_LOGD(TAG, "Storage change (kind %d, id %d), waking scheduler", (int)change, id);
+    alarm_eval_mark(change, id);
+    alarm_port_notify(ALARM_NOTIFY_EVALUATE);
+}
 
-    ESP_LOGI(TAG, "Action execution completed for reminder: %s, Task: %s", reminder_msg_line1, reminder_msg_line2);
+void alarm_execution_wake(void)
+{
+    // Cached evaluations were made against the old clock.
+    alarm_eval_mark_all();
+    alarm_port_notify(ALARM_NOTIFY_EVALUATE);
 }
 
+void alarm_execution_snooze(void)
+{
+    if (action.state != ACTION_IDLE) {
+        alarm_port_notify(ALARM_NOTIFY_SNOOZE);
+    }
+}
+
+
 /**
- * Alarm Execution Task.
+ * One pass of the alarm scheduler, followed by the wait for the next one.
  *
- * Continuously checks reminders and executes the appropriate actions when reminders are active.
- * If the current time falls within timetable 0 (Do Not Disturb timeslots), execution is skipped.
+ * Event-driven scheduler. Each pass evaluates the reminders once, computes the next
+ * instant at which any of them can change state (a timeslot of a reminder or of the
+ * Do Not Disturb timetable 0 opens or closes, an emergency threshold is reached or a
+ * snooze expires, the display interval after an action runs out), and then blocks on
+ * its task notification until that instant. Storage changes and clock synchronization
+ * wake it early through alarm_execution_wake(). While nothing is due the task neither
+ * wakes nor reads flash.
  *
- * @param params Not used.
+ * Actions never block the task: the notification screen is a timed state machine
+ * advanced between evaluations (see action_step).
  */
-void alarm_execution_task(void *params)
+void alarm_execution_cycle(void)
 {
-    ESP_LOGI(TAG, "Alarm execution task started");
-    while(1)
-    {
-        //disable led
-        set_led(0, 0, 0);
-        vTaskDelay(pdMS_TO_TICKS(100));
-        // Check if current time is within Do Not Disturb period (timetable 0)
-        timetable_t dnd_timetable;
-        if(load_timetable(0, &dnd_timetable) && check_timeslot_active(&dnd_timetable)) {
+    ALARM_STATS_CYCLE_BEGIN();
+    time_t now = alarm_port_time();
+    if (notified & ALARM_NOTIFY_SNOOZE) {
+        snooze_action(now);
+    } else {
+        action_step();
+    }
+
+    struct tm now_tm;
+    alarm_port_localtime(now, &now_tm);
+    time_t next_change = ALARM_NO_CHANGE;
+
+    // Check if current time is within Do Not Disturb period (timetable 0)
+    timetable_schedule_t dnd_schedule;
+    if(load_schedule_cached(0, &dnd_schedule)) {
+        note_change(&next_change, timetable_schedule_next_change(&dnd_schedule, now, &now_tm));
+        if(timetable_schedule_is_active(&dnd_schedule, &now_tm)) {
+#if ALARM_STATS_ENABLED
+            dnd_until = next_change;
+#endif
             ESP_LOGI(TAG, "Do Not Disturb period active. Skipping reminder execution.");
-            vTaskDelay(pdMS_TO_TICKS(60000)); // Delay for 1 minute before rechecking
-            continue;
+            if (action.state == ACTION_IDLE) {
+                set_led(0, 0, 0);
+            }
+            notified = wait_for_change(now, next_change);
+            return;
         }
+    }
 
-        uint8_t active_priority = 0;
-        type1_reminder_t active_reminder;
-        if(check_active_reminders(&active_priority, &active_reminder)) {
-            ESP_LOGI(TAG, "Active reminder detected, ID: %d, Priority: %d",
-                     active_reminder.Reminder_ID, active_priority);
-            char msg_line1[64];
-            char msg_line2[64];
-            char msg_line3[64];
-            char msg_line4[64];
-            //active reminder id
-            snprintf(msg_line1, sizeof(msg_line1), "Reminder %d active", active_reminder.Reminder_ID);
-            //reminder task name
-            task_t *task = get_task_by_id(active_reminder.Task_ID);
-            if(task != NULL) {
-                snprintf(msg_line2, sizeof(msg_line2), "T: %s", task->Name);
-            } else {
-                snprintf(msg_line2, sizeof(msg_line2), "Task ID: %d", active_reminder.Task_ID);
-            }
-            //reminder task option text
-            if(task != NULL && active_reminder.Task_Option_Selected >= 0 &&
-               active_reminder.Task_Option_Selected < TASK_MAX_OPTIONS) {
-                snprintf(msg_line3, sizeof(msg_line3), "O: %s",
-                         task->Options[active_reminder.Task_Option_Selected].display_text);
-            } else {
-                snprintf(msg_line3, sizeof(msg_line3), "Option: %d", active_reminder.Task_Option_Selected);
-            }
-            //aditional options number
-            sniprintf(msg_line4, sizeof(msg_line4), "Add. Options: %d", active_reminder.Task_Additional_Option_Selected);
-            if(task != NULL) free(task);
-            execute_priority_action(active_priority, msg_line1,msg_line2,msg_line3,msg_line4);
+    alarm_eval_result_t eval;
+    alarm_eval_run(now, &now_tm, &eval);
+    note_change(&next_change, eval.next_change);
+    if(eval.count > 0) {
+        uint8_t active_priority = eval.ranked[0].priority;
+        if (now >= quiet_until && action.state == ACTION_IDLE) {
+#if ALARM_STATS_ENABLED
+            time_t due = action_due(&eval, quiet_until);
+            alarm_stats_record(ALARM_STATS_LATENESS_S, now > due ? (uint32_t)(now - due) : 0);
+#endif
+            start_priority_action(&eval);
 
             const priority_config_t *configs = get_priority_configs();
             uint8_t idx = (active_priority > 0 && active_priority < 4) ? active_priority - 1 : 2;
-            ESP_LOGI(TAG, "Waiting for %d minutes after executing reminder", (int)configs[idx].display_interval_minutes);
-            vTaskDelay(pdMS_TO_TICKS(configs[idx].display_interval_minutes * 60000));
-        } else {
-            ESP_LOGI(TAG, "No active reminders found, waiting 10 seconds");
-            vTaskDelay(pdMS_TO_TICKS(10000));
+            ESP_LOGI(TAG, "Next action in %d minutes at the earliest", (int)configs[idx].display_interval_minutes);
+            quiet_until = now + (time_t)configs[idx].display_interval_minutes * 60;
+        }
+        if (quiet_until > now) {
+            note_change(&next_change, quiet_until);
+        }
+        // Past quiet_until only while a notification is still up (covered, its screen time
+        // stands still): the action poll of wait_for_change() notices its end.
+    } else {
+        ESP_LOGI(TAG, "No active reminders found");
+        if (action.state == ACTION_IDLE) {
+            //disable led
+            set_led(0, 0, 0);
         }
     }
+    notified = wait_for_change(now, next_change);
+}
+
+/**
+ * Alarm Execution Task.
+ *
+ * Runs alarm_execution_cycle() forever.
+ *
+ * @param params Not used.
+ */
+void alarm_execution_task(void *params)
+{
+    ESP_LOGI(TAG, "Alarm execution task started");
+    while(1)
+    {
+        alarm_execution_cycle();
+    }
 }
 
 /**
  * Initialize the alarm execution functionality.
  *
- * This function saves the provided pointers and creates the task responsible for
- * monitoring reminders and executing actions.
+ * This function saves the chirp queue and creates the task responsible for
+ * monitoring reminders and executing actions. Notifications are posted to the
+ * display compositor, which must be started with display_compositor_start().
  *
  * @param chirp_q      Queue for chirp commands.
- * @param display_mux  Semaphore for display access.
- * @param u8g2_ptr_in  Pointer to the u8g2 display object.
  * @return ESP_OK if the task is successfully created, ESP_FAIL otherwise.
  */
-esp_err_t alarm_execution_init(QueueHandle_t chirp_q,
-                               SemaphoreHandle_t display_mux,
-                               u8g2_t *u8g2_ptr_in)
+esp_err_t alarm_execution_init(QueueHandle_t chirp_q)
 {
     ESP_LOGI(TAG, "Initializing alarm execution module");
     my_chirpQueue    = chirp_q;
-    my_display_mutex = display_mux;
-    my_u8g2_ptr      = u8g2_ptr_in;
 
-    if(xTaskCreate(alarm_execution_task, "alarm_execution_task", 4096, NULL, 1, NULL) == pdPASS) {
+    if(alarm_port_start(alarm_execution_task) == ESP_OK) {
+        storage_add_listener(on_storage_change, NULL);
         ESP_LOGI(TAG, "Alarm execution task created successfully");
         return ESP_OK;
     } else {
@@ -3,33 +3,62 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
-#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "esp_err.h"
-#include "u8g2.h"          // for u8g2_t
 #include "json_parser.h"   // for timetable_t, type1_reminder_t, etc.
+#if CONFIG_IDF_TARGET_LINUX
+#include "alarm_sim_hw.h"  // host simulator sinks for the LED, buzzer, display and status
+#else
 #include "led.h"
 #include "buzzer.h"
-#include "display.h"
+#include "display_compositor.h"
+#include "wifi_time.h"
+#endif
 #include <time.h>
 #include <string.h>
 #include <stdlib.h>
-#include "wifi_time.h"
+#include "alarm_eval.h"
+#include "alarm_port.h"
+#include "alarm_stats.h"
 
-#define EMERGENCY_PRIORITY 3 // Priority level for emergency reminders
+#define ALARM_SNOOZE_S (10 * 60)   // snooze length set from the notification screen
 
 /**
  * @brief Initialize the alarm execution functionality.
  *
  * This function creates the task that continuously monitors reminders and executes
- * the configured actions.
+ * the configured actions. Notifications are shown through the display compositor.
  *
  * @param chirp_q      QueueHandle_t for chirp commands.
- * @param display_mux  SemaphoreHandle_t for the display.
- * @param u8g2_ptr     Pointer to the u8g2 display object.
  * @return ESP_OK if the task is successfully created, ESP_FAIL otherwise.
  */
-esp_err_t alarm_execution_init(QueueHandle_t chirp_q,
-                               SemaphoreHandle_t display_mux,
-                               u8g2_t *u8g2_ptr);
+esp_err_t alarm_execution_init(QueueHandle_t chirp_q);
+
+/**
+ * @brief Runs one scheduler pass, then waits until the next one is due.
+ *
+ * This is the body of the alarm task. It is exported for the host simulator, which
+ * calls it in a loop against a virtual clock instead of running the task.
+ */
+void alarm_execution_cycle(void);
+
+/**
+ * @brief Wakes the alarm scheduler so it re-evaluates the reminders now.
+ *
+ * The scheduler sleeps until the next instant a reminder can change state. Storage
+ * changes wake it automatically; call this after events it cannot see, such as a
+ * clock synchronization. All reminders are evaluated again from scratch.
+ * Safe to call before alarm_execution_init().
+ */
+void alarm_execution_wake(void);
+
+/**
+ * @brief Snoozes the reminders of the current notification.
+ *
+ * Sets Time_Snoozed of every reminder on the notification to ALARM_SNOOZE_S from
+ * now and ends the notification. Does nothing when no notification is pending.
+ * Non-blocking; the alarm task does the storage update.
+ */
+void alarm_execution_snooze(void);
 
 #endif // ALARM_EXECUTION_H
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "alarm_port.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "clock_service.h"
+#include "alarm_execution.h"  // alarm_execution_wake() after a clock change
+
+static TaskHandle_t alarm_task_handle = NULL;
+
+time_t alarm_port_time(void)
+{
+    return time(NULL);
+}
+
+struct tm *alarm_port_localtime(time_t t, struct tm *local)
+{
+    return clock_service_localtime(t, local);
+}
+
+int64_t alarm_port_time_us(void)
+{
+    return esp_timer_get_time();
+}
+
+// The wall clock was synced or jumped, or the local date rolled over: cached
+// evaluations used the old clock or the old day's offset (DST).
+static void on_clock_set(uint32_t events, const struct tm *local, void *ctx)
+{
+    alarm_execution_wake();
+}
+
+esp_err_t alarm_port_start(void (*task)(void *))
+{
+    if (xTaskCreate(task, "alarm_execution_task", 4096, NULL, 1, &alarm_task_handle) != pdPASS) {
+        return ESP_FAIL;
+    }
+    clock_service_subscribe(CLOCK_EVENT_SET | CLOCK_EVENT_DAY, on_clock_set, NULL);
+    return ESP_OK;
+}
+
+void alarm_port_notify(uint32_t bits)
+{
+    if (alarm_task_handle != NULL) {
+        xTaskNotify(alarm_task_handle, bits, eSetBits);
+    }
+}
+
+uint32_t alarm_port_wait(uint32_t timeout_ms)
+{
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, timeout_ms > 0 ? pdMS_TO_TICKS(timeout_ms) : 1);
+    return bits;
+}
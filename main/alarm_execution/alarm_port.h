@@ -0,0 +1,33 @@
+#ifndef ALARM_PORT_H
+#define ALARM_PORT_H
+
+#include <stdint.h>
+#include <time.h>
+#include "esp_err.h"
+
+/*
+ * Clock, wait and wake-up primitives of the alarm task.
+ *
+ * alarm_port.c implements them with the system clock, the clock service, esp_timer
+ * and FreeRTOS task notifications, and wakes the task when the clock service reports
+ * a clock change. The host simulator (host/alarm_sim.c) links its own implementation
+ * instead, driven by a virtual clock, so alarm_execution.c runs unchanged over
+ * simulated weeks or years.
+ */
+
+// Wall clock, seconds since the epoch.
+time_t alarm_port_time(void);
+// localtime_r() for the alarm task; cached by the clock service on the device.
+struct tm *alarm_port_localtime(time_t t, struct tm *local);
+// Monotonic clock, microseconds.
+int64_t alarm_port_time_us(void);
+
+// Creates the alarm task running task.
+esp_err_t alarm_port_start(void (*task)(void *));
+// Sets notification bits of the alarm task. Safe from any task; no-op before start.
+void alarm_port_notify(uint32_t bits);
+// Called by the alarm task: blocks until notified or timeout_ms elapsed and returns
+// the bits received (0 on timeout). Clears them.
+uint32_t alarm_port_wait(uint32_t timeout_ms);
+
+#endif // ALARM_PORT_H
@@ -0,0 +1,138 @@
+#include "alarm_stats.h"
+
+#if ALARM_STATS_ENABLED
+
+#include <string.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "alarm_port.h"
+#include "object_cache.h"
+
+static const char *TAG = "alarm_stats";
+
+static const char *const metric_names[ALARM_STATS_METRIC_COUNT] = {
+    [ALARM_STATS_CYCLE_US]        = "cycle us",
+    [ALARM_STATS_TASK_LOADS]      = "task loads/cycle",
+    [ALARM_STATS_TIMETABLE_LOADS] = "timetable loads/cycle",
+    [ALARM_STATS_EVALUATED]       = "evaluated/cycle",
+    [ALARM_STATS_LATENESS_S]      = "lateness s",
+    [ALARM_STATS_DISPLAY_WAIT_US] = "display wait us",
+};
+
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static alarm_stats_t stats;
+
+// State of the pass in progress; only touched by the alarm task.
+static int64_t cycle_start_us;
+static cache_stats_t cycle_start_cache;
+static time_t last_log;
+
+static inline int bucket_of(uint32_t value)
+{
+    if (value == 0) {
+        return 0;
+    }
+    int bucket = 32 - __builtin_clz(value);  // floor(log2(value)) + 1
+    return bucket < ALARM_STATS_BUCKETS ? bucket : ALARM_STATS_BUCKETS - 1;
+}
+
+void alarm_stats_count(alarm_stats_counter_t counter)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    stats.counters[counter]++;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+void alarm_stats_record(alarm_stats_metric_t metric, uint32_t value)
+{
+    alarm_stats_hist_t *hist = &stats.metrics[metric];
+    int bucket = bucket_of(value);
+    taskENTER_CRITICAL(&stats_lock);
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max) {
+        hist->max = value;
+    }
+    hist->buckets[bucket]++;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+void alarm_stats_cycle_begin(void)
+{
+    cycle_start_us = alarm_port_time_us();
+    cache_get_stats(&cycle_start_cache);
+}
+
+void alarm_stats_cycle_end(void)
+{
+    int64_t elapsed_us = alarm_port_time_us() - cycle_start_us;
+    cache_stats_t cache;
+    cache_get_stats(&cache);
+    alarm_stats_count(ALARM_STATS_CYCLES);
+    alarm_stats_record(ALARM_STATS_CYCLE_US, elapsed_us > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed_us);
+    // Misses made by other tasks during the pass are counted too; they are rare.
+    alarm_stats_record(ALARM_STATS_TASK_LOADS, cache.task_misses - cycle_start_cache.task_misses);
+    alarm_stats_record(ALARM_STATS_TIMETABLE_LOADS, cache.timetable_misses - cycle_start_cache.timetable_misses);
+
+    time_t now = alarm_port_time();
+    if (last_log == 0) {
+        last_log = now;
+    } else if (now - last_log >= ALARM_STATS_LOG_PERIOD_S) {
+        last_log = now;
+        alarm_stats_log();
+    }
+}
+
+void alarm_stats_get(alarm_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    taskENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+void alarm_stats_reset(void)
+{
+    taskENTER_CRITICAL(&stats_lock);
+    memset(&stats, 0, sizeof(stats));
+    taskEXIT_CRITICAL(&stats_lock);
+}
+
+uint32_t alarm_stats_percentile(const alarm_stats_hist_t *hist, uint32_t pct)
+{
+    if (hist->count == 0) {
+        return 0;
+    }
+    uint64_t rank = ((uint64_t)hist->count * pct + 99) / 100;  // nearest-rank
+    uint64_t seen = 0;
+    for (int i = 0; i < ALARM_STATS_BUCKETS - 1; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = i == 0 ? 0 : (1u << i) - 1;
+            return upper < hist->max ? upper : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+void alarm_stats_log(void)
+{
+    alarm_stats_t s;
+    alarm_stats_get(&s);
+    ESP_LOGI(TAG, "%u cycles (%u notified), %u actions, %u preempted, %u snoozed, display busy %u times",
+             (unsigned)s.counters[ALARM_STATS_CYCLES], (unsigned)s.counters[ALARM_STATS_NOTIFIED],
+             (unsigned)s.counters[ALARM_STATS_ACTIONS], (unsigned)s.counters[ALARM_STATS_PREEMPTIONS],
+             (unsigned)s.counters[ALARM_STATS_SNOOZES], (unsigned)s.counters[ALARM_STATS_DISPLAY_BUSY]);
+    for (int m = 0; m < ALARM_STATS_METRIC_COUNT; m++) {
+        const alarm_stats_hist_t *hist = &s.metrics[m];
+        ESP_LOGI(TAG, "%s: n %u, mean %u, p50 <= %u, p99 <= %u, max %u", metric_names[m],
+                 (unsigned)hist->count, hist->count ? (unsigned)(hist->sum / hist->count) : 0,
+                 (unsigned)alarm_stats_percentile(hist, 50), (unsigned)alarm_stats_percentile(hist, 99),
+                 (unsigned)hist->max);
+    }
+}
+
+#endif // ALARM_STATS_ENABLED
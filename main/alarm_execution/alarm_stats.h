@@ -0,0 +1,91 @@
+#ifndef ALARM_STATS_H
+#define ALARM_STATS_H
+
+#include <stdint.h>
+
+// Set to 0 to compile the alarm scheduler instrumentation out entirely.
+#define ALARM_STATS_ENABLED 1
+#define ALARM_STATS_LOG_PERIOD_S (60 * 60)  // period of the summary logged by the alarm task
+#define ALARM_STATS_BUCKETS 16
+
+/*
+ * Scheduler instrumentation.
+ *
+ * The alarm task counts events and records per-pass measurements in log2 histograms:
+ * bucket 0 holds the value 0, bucket i (1 <= i < ALARM_STATS_BUCKETS - 1) the values
+ * 2^(i-1) .. 2^i - 1, and the last bucket everything larger. Recording is a few
+ * instructions under a spinlock and never allocates or logs. alarm_stats_get() takes
+ * a consistent snapshot from any task; the alarm task logs a summary every
+ * ALARM_STATS_LOG_PERIOD_S.
+ *
+ * With ALARM_STATS_ENABLED 0 the hook macros expand to nothing (their arguments are
+ * not evaluated) and the functions below are not declared.
+ */
+
+typedef enum {
+    ALARM_STATS_CYCLES,             // scheduler passes
+    ALARM_STATS_NOTIFIED,           // waits ended by a notification instead of the timeout
+    ALARM_STATS_ACTIONS,            // notifications started (LED, chirp, screen)
+    ALARM_STATS_PREEMPTIONS,        // notifications covered by a higher-priority screen
+    ALARM_STATS_SNOOZES,            // notifications snoozed
+    ALARM_STATS_DISPLAY_BUSY,       // action steps that found the notification covered
+    ALARM_STATS_COUNTER_COUNT
+} alarm_stats_counter_t;
+
+typedef enum {
+    ALARM_STATS_CYCLE_US,           // duration of a pass, without the wait
+    ALARM_STATS_TASK_LOADS,         // task cache misses (NVS read + decode) during a pass
+    ALARM_STATS_TIMETABLE_LOADS,    // timetable cache misses during a pass
+    ALARM_STATS_EVALUATED,          // reminders evaluated by a pass
+    ALARM_STATS_LATENESS_S,         // notification start minus the instant it was due
+    ALARM_STATS_DISPLAY_WAIT_US,    // time from posting a notification to seeing it on top
+    ALARM_STATS_METRIC_COUNT
+} alarm_stats_metric_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t buckets[ALARM_STATS_BUCKETS];
+} alarm_stats_hist_t;
+
+typedef struct {
+    uint32_t counters[ALARM_STATS_COUNTER_COUNT];
+    alarm_stats_hist_t metrics[ALARM_STATS_METRIC_COUNT];
+} alarm_stats_t;
+
+#if ALARM_STATS_ENABLED
+
+void alarm_stats_count(alarm_stats_counter_t counter);
+void alarm_stats_record(alarm_stats_metric_t metric, uint32_t value);
+
+// Called by the alarm task at the start and at the end of each pass (before its
+// wait). The end records the pass duration and cache loads, and logs the summary
+// when ALARM_STATS_LOG_PERIOD_S has passed.
+void alarm_stats_cycle_begin(void);
+void alarm_stats_cycle_end(void);
+
+// Copies the counters and histograms. Safe from any task.
+void alarm_stats_get(alarm_stats_t *stats);
+void alarm_stats_reset(void);
+// Smallest value v such that at least pct percent of the samples are <= v, at bucket
+// resolution (the upper bound of the bucket, capped at the maximum seen).
+uint32_t alarm_stats_percentile(const alarm_stats_hist_t *hist, uint32_t pct);
+// Logs one line per counter group and histogram.
+void alarm_stats_log(void);
+
+#define ALARM_STATS_COUNT(counter)          alarm_stats_count(counter)
+#define ALARM_STATS_RECORD(metric, value)   alarm_stats_record((metric), (uint32_t)(value))
+#define ALARM_STATS_CYCLE_BEGIN()           alarm_stats_cycle_begin()
+#define ALARM_STATS_CYCLE_END()             alarm_stats_cycle_end()
+
+#else
+
+#define ALARM_STATS_COUNT(counter)          ((void)0)
+#define ALARM_STATS_RECORD(metric, value)   ((void)0)
+#define ALARM_STATS_CYCLE_BEGIN()           ((void)0)
+#define ALARM_STATS_CYCLE_END()             ((void)0)
+
+#endif // ALARM_STATS_ENABLED
+
+#endif // ALARM_STATS_H
@@ -0,0 +1,191 @@
+#include "timer_wheel.h"
+#include <string.h>
+
+#define LEVEL_SHIFT(level) ((level) * TIMER_WHEEL_LEVEL_BITS)
+#define SLOT_MASK          (TIMER_WHEEL_SLOTS - 1)
+// Deadlines this far ahead or further wait in the last level.
+#define WHEEL_SPAN         (1u << LEVEL_SHIFT(TIMER_WHEEL_LEVELS))
+#define NO_TICK            UINT32_MAX
+
+static inline uint64_t rotate_right(uint64_t bits, unsigned n)
+{
+    return (bits >> n) | (bits << ((64 - n) & 63));
+}
+
+static void link_entry(timer_wheel_t *wheel, timer_wheel_entry_t *entry, int level, int slot)
+{
+    timer_wheel_entry_t **head = &wheel->buckets[level][slot];
+    entry->prev = NULL;
+    entry->next = *head;
+    if (*head) {
+        (*head)->prev = entry;
+    }
+    *head = entry;
+    entry->bucket = (uint8_t)(level * TIMER_WHEEL_SLOTS + slot);
+    entry->pending = true;
+    wheel->occupied[level] |= 1ull << slot;
+}
+
+static void unlink_entry(timer_wheel_t *wheel, timer_wheel_entry_t *entry)
+{
+    int level = entry->bucket / TIMER_WHEEL_SLOTS;
+    int slot = entry->bucket % TIMER_WHEEL_SLOTS;
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        wheel->buckets[level][slot] = entry->next;
+        if (entry->next == NULL) {
+            wheel->occupied[level] &= ~(1ull << slot);
+        }
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    }
+    entry->next = entry->prev = NULL;
+    entry->pending = false;
+}
+
+/**
+ * @brief Links entry into the bucket for its deadline, relative to wheel->now.
+ *
+ * Deadlines before earliest are placed at earliest: wheel->now + 1 for new entries,
+ * whose second has been processed already, wheel->now while cascading.
+ */
+static void place_entry(timer_wheel_t *wheel, timer_wheel_entry_t *entry, uint32_t earliest)
+{
+    uint32_t at = entry->expires > earliest ? entry->expires : earliest;
+    uint32_t delta = at - wheel->now;
+    if (delta >= WHEEL_SPAN) {
+        at = wheel->now + WHEEL_SPAN - 1;
+        delta = WHEEL_SPAN - 1;
+    }
+    int level = 0;
+    while (delta >= 1u << LEVEL_SHIFT(level + 1)) {
+        level++;
+    }
+    link_entry(wheel, entry, level, (at >> LEVEL_SHIFT(level)) & SLOT_MASK);
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, time_t now, timer_wheel_fn fn, void *ctx)
+{
+    memset(wheel, 0, sizeof(*wheel));
+    wheel->now = (uint32_t)now;
+    wheel->fn = fn;
+    wheel->ctx = ctx;
+}
+
+void timer_wheel_add(timer_wheel_t *wheel, timer_wheel_entry_t *entry, time_t expires)
+{
+    if (entry->pending) {
+        unlink_entry(wheel, entry);
+    }
+    entry->expires = expires > 0 ? (uint32_t)expires : 0;
+    place_entry(wheel, entry, wheel->now + 1);
+}
+
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_entry_t *entry)
+{
+    if (entry->pending) {
+        unlink_entry(wheel, entry);
+    }
+}
+
+/**
+ * @brief First occupied bucket of a level after wheel->now, in wheel order.
+ *
+ * @param[out] tick Second at which that bucket is processed (fired or cascaded).
+ * @return The bucket's slot, or -1 if the level is empty.
+ */
+static int first_bucket(const timer_wheel_t *wheel, int level, uint32_t *tick)
+{
+    uint64_t bits = wheel->occupied[level];
+    if (bits == 0) {
+        return -1;
+    }
+    // Level 0 is processed every second, level k only when the lower k levels wrap.
+    uint32_t next_index = (wheel->now >> LEVEL_SHIFT(level)) + 1;
+    unsigned steps = (unsigned)__builtin_ctzll(rotate_right(bits, next_index & SLOT_MASK));
+    *tick = (next_index + steps) << LEVEL_SHIFT(level);
+    return (int)((next_index + steps) & SLOT_MASK);
+}
+
+static uint32_t next_event_tick(const timer_wheel_t *wheel)
+{
+    uint32_t next = NO_TICK;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        uint32_t tick;
+        if (first_bucket(wheel, level, &tick) >= 0 && tick < next) {
+            next = tick;
+        }
+    }
+    return next;
+}
+
+/**
+ * @brief Moves the entries of every bucket due at wheel->now one level down.
+ */
+static void cascade(timer_wheel_t *wheel)
+{
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        if (wheel->now & ((1u << LEVEL_SHIFT(level)) - 1)) {
+            break;
+        }
+        int slot = (wheel->now >> LEVEL_SHIFT(level)) & SLOT_MASK;
+        timer_wheel_entry_t *entry = wheel->buckets[level][slot];
+        wheel->buckets[level][slot] = NULL;
+        wheel->occupied[level] &= ~(1ull << slot);
+        while (entry) {
+            timer_wheel_entry_t *next = entry->next;
+            place_entry(wheel, entry, wheel->now);
+            entry = next;
+        }
+    }
+}
+
+void timer_wheel_advance(timer_wheel_t *wheel, time_t now)
+{
+    uint32_t target = (uint32_t)now;
+    while (wheel->now < target) {
+        uint32_t tick = next_event_tick(wheel);
+        if (tick > target) {
+            wheel->now = target;  // nothing due before target
+            return;
+        }
+        wheel->now = tick;
+        cascade(wheel);
+        // Every entry left in this level 0 bucket expires now; pop them one at a
+        // time, since the callback may add or cancel entries.
+        timer_wheel_entry_t **head = &wheel->buckets[0][tick & SLOT_MASK];
+        while (*head) {
+            timer_wheel_entry_t *entry = *head;
+            unlink_entry(wheel, entry);
+            wheel->fn(entry, wheel->ctx);
+        }
+    }
+}
+
+time_t timer_wheel_next_expiry(const timer_wheel_t *wheel)
+{
+    uint32_t next = NO_TICK;
+    uint32_t tick;
+    if (first_bucket(wheel, 0, &tick) >= 0) {
+        next = tick;  // a level 0 bucket holds a single deadline
+    }
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        // Later buckets of a level only hold later deadlines.
+        int slot = first_bucket(wheel, level, &tick);
+        if (slot < 0 || tick >= next) {
+            continue;
+        }
+        uint32_t bucket_end = tick + (1u << LEVEL_SHIFT(level));
+        for (const timer_wheel_entry_t *entry = wheel->buckets[level][slot]; entry; entry = entry->next) {
+            // A deadline beyond the wheel span only waits here to be placed again;
+            // report the bucket itself, which is early but never late.
+            uint32_t expires = entry->expires < bucket_end ? entry->expires : tick;
+            if (expires < next) {
+                next = expires;
+            }
+        }
+    }
+    return next == NO_TICK ? TIMER_WHEEL_NONE : (time_t)next;
+}
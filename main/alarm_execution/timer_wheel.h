@@ -0,0 +1,71 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+/*
+ * Hierarchical timer wheel with one second resolution.
+ *
+ * TIMER_WHEEL_LEVELS levels of 64 buckets each: level 0 holds deadlines less than
+ * 64 s ahead at their exact second, level k holds deadlines less than 64^(k+1) s
+ * ahead by their 64^k s bucket and moves them one level down (cascades) when the
+ * wheel reaches that bucket. With four levels the wheel spans about 194 days;
+ * later deadlines wait in the last level and are placed again when it cascades.
+ *
+ * Entries are intrusive and doubly linked, so adding and cancelling are O(1) and
+ * need no allocation. A per-level occupancy bitmap lets timer_wheel_advance() skip
+ * straight from one non-empty bucket to the next, so pending entries cost nothing
+ * until their bucket comes up. Not thread safe: use the wheel from one task.
+ */
+
+#define TIMER_WHEEL_LEVELS     4
+#define TIMER_WHEEL_LEVEL_BITS 6
+#define TIMER_WHEEL_SLOTS      (1 << TIMER_WHEEL_LEVEL_BITS)
+
+typedef struct timer_wheel_entry timer_wheel_entry_t;
+typedef void (*timer_wheel_fn)(timer_wheel_entry_t *entry, void *ctx);
+
+struct timer_wheel_entry {
+    timer_wheel_entry_t *next;
+    timer_wheel_entry_t *prev;
+    uint32_t expires;       // seconds since the epoch (unsigned, valid until 2106)
+    uint8_t bucket;         // level * TIMER_WHEEL_SLOTS + slot
+    bool pending;
+};
+
+typedef struct {
+    uint32_t now;           // last second processed
+    uint64_t occupied[TIMER_WHEEL_LEVELS];
+    timer_wheel_entry_t *buckets[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    timer_wheel_fn fn;      // called for every expired entry
+    void *ctx;
+} timer_wheel_t;
+
+// Empties the wheel and starts it at now. Entries still linked are forgotten,
+// so their owners must clear them (memset) before reuse.
+void timer_wheel_init(timer_wheel_t *wheel, time_t now, timer_wheel_fn fn, void *ctx);
+
+// Schedules entry at expires (re-scheduling it if pending). A deadline that has
+// already passed fires on the next advance.
+void timer_wheel_add(timer_wheel_t *wheel, timer_wheel_entry_t *entry, time_t expires);
+
+// Removes entry if pending.
+void timer_wheel_cancel(timer_wheel_t *wheel, timer_wheel_entry_t *entry);
+
+static inline bool timer_wheel_pending(const timer_wheel_entry_t *entry)
+{
+    return entry->pending;
+}
+
+// Fires, in deadline order, every entry due at or before now. The callback may
+// add or cancel entries.
+void timer_wheel_advance(timer_wheel_t *wheel, time_t now);
+
+// Earliest pending deadline, or TIMER_WHEEL_NONE if the wheel is empty. With
+// deadlines beyond the wheel span it may be earlier than the real one.
+#define TIMER_WHEEL_NONE ((time_t)-1)
+time_t timer_wheel_next_expiry(const timer_wheel_t *wheel);
+
+#endif // TIMER_WHEEL_H
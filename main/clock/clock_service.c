@@ -0,0 +1,153 @@
+#include "clock_service.h"
+#include <stdbool.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "clock_service";
+
+// A tick further than this from the previous one means the clock was set.
+#define CLOCK_JUMP_S 10
+
+typedef struct {
+    uint32_t mask;
+    clock_listener_fn fn;
+    void *ctx;
+} clock_listener_t;
+
+// Registered at start-up and never removed, so publishing needs no lock.
+static clock_listener_t listeners[CLOCK_SERVICE_MAX_LISTENERS];
+static volatile int listener_count = 0;
+
+static portMUX_TYPE clock_lock = portMUX_INITIALIZER_UNLOCKED;
+static time_t minute_start = -1;   // cached minute is [minute_start, minute_start + 60)
+static struct tm minute_tm;        // local time at minute_start
+static time_t tick_last = 0;       // wall clock at the previous tick, 0 before the first
+static time_t tick_minute = 0;     // minute_start seen by the previous tick
+static int tick_yday, tick_year;   // local date seen by the previous tick
+
+esp_err_t clock_service_subscribe(uint32_t mask, clock_listener_fn listener, void *ctx)
+{
+    if (listener == NULL || mask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&clock_lock);
+    if (listener_count < CLOCK_SERVICE_MAX_LISTENERS) {
+        listeners[listener_count].mask = mask;
+        listeners[listener_count].fn = listener;
+        listeners[listener_count].ctx = ctx;
+        listener_count++;
+        err = ESP_OK;
+    }
+    taskEXIT_CRITICAL(&clock_lock);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "No room for another clock listener");
+    }
+    return err;
+}
+
+static void publish(uint32_t events, const struct tm *local)
+{
+    int count = listener_count;
+    for (int i = 0; i < count; i++) {
+        if (listeners[i].mask & events) {
+            listeners[i].fn(events & listeners[i].mask, local, listeners[i].ctx);
+        }
+    }
+}
+
+/**
+ * @brief Converts t to local time, from the cached minute when possible.
+ *
+ * @param is_now t is the current time: a miss always replaces the cached minute,
+ *               even after the clock went back. Other misses only move it on to the
+ *               next minute (a caller saw the rollover before the next tick), so
+ *               converting past or future deadlines never evicts the current minute.
+ */
+static struct tm *local_time(time_t t, struct tm *local, bool is_now)
+{
+    taskENTER_CRITICAL(&clock_lock);
+    bool hit = minute_start >= 0 && t >= minute_start && t - minute_start < 60;
+    if (hit) {
+        *local = minute_tm;
+        local->tm_sec = (int)(t - minute_start);
+    }
+    taskEXIT_CRITICAL(&clock_lock);
+    if (hit) {
+        return local;
+    }
+
+    if (localtime_r(&t, local) == NULL) {
+        return NULL;
+    }
+    taskENTER_CRITICAL(&clock_lock);
+    if (is_now || (minute_start >= 0 && t - minute_start >= 60 && t - minute_start < 120)) {
+        minute_start = t - local->tm_sec;
+        minute_tm = *local;
+        minute_tm.tm_sec = 0;
+    }
+    taskEXIT_CRITICAL(&clock_lock);
+    return local;
+}
+
+time_t clock_service_now(struct tm *local)
+{
+    time_t now = time(NULL);
+    if (local != NULL) {
+        local_time(now, local, true);
+    }
+    return now;
+}
+
+struct tm *clock_service_localtime(time_t t, struct tm *local)
+{
+    return local_time(t, local, false);
+}
+
+void clock_service_tick(void)
+{
+    struct tm local;
+    time_t now = clock_service_now(&local);
+    time_t minute = now - local.tm_sec;
+    uint32_t events = 0;
+
+    taskENTER_CRITICAL(&clock_lock);
+    if (tick_last != 0) {
+        if (now < tick_last || now - tick_last > CLOCK_JUMP_S) {
+            events |= CLOCK_EVENT_SET;
+        }
+        if (minute != tick_minute) {
+            events |= CLOCK_EVENT_MINUTE;
+        }
+        if (local.tm_yday != tick_yday || local.tm_year != tick_year || (events & CLOCK_EVENT_SET)) {
+            events |= CLOCK_EVENT_DAY;
+        }
+    }
+    tick_last = now;
+    tick_minute = minute;
+    tick_yday = local.tm_yday;
+    tick_year = local.tm_year;
+    taskEXIT_CRITICAL(&clock_lock);
+
+    if (events & CLOCK_EVENT_SET) {
+        ESP_LOGI(TAG, "Clock jumped, notifying subscribers");
+    }
+    if (events) {
+        publish(events, &local);
+    }
+}
+
+void clock_service_time_set(void)
+{
+    struct tm local;
+    time_t now = clock_service_now(&local);
+    taskENTER_CRITICAL(&clock_lock);
+    // The next tick compares against the new time instead of reporting a jump.
+    tick_last = now;
+    tick_minute = now - local.tm_sec;
+    tick_yday = local.tm_yday;
+    tick_year = local.tm_year;
+    taskEXIT_CRITICAL(&clock_lock);
+    publish(CLOCK_EVENT_SET | CLOCK_EVENT_DAY, &local);
+}
@@ -0,0 +1,51 @@
+#ifndef CLOCK_SERVICE_H
+#define CLOCK_SERVICE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "esp_err.h"
+
+#define CLOCK_SERVICE_MAX_LISTENERS 4  // subscribers clock_service_subscribe() accepts
+
+/*
+ * Cached local time.
+ *
+ * newlib's localtime_r() parses TZ and works out the DST rules on every call. The
+ * clock service runs it once per local minute and derives the seconds of that minute
+ * from the cached struct tm (offset changes only happen on whole minutes), so asking
+ * for the local time is a copy under a spinlock.
+ *
+ * clock_service_tick(), called once per second by task_update_tick, publishes the
+ * rollovers to subscribers: a new minute, a new day, and clock changes (SNTP sync
+ * reported through clock_service_time_set(), or a jump seen between two ticks).
+ */
+
+// Events a subscriber can ask for (bit mask).
+#define CLOCK_EVENT_MINUTE (1u << 0)  // local minute rolled over
+#define CLOCK_EVENT_DAY    (1u << 1)  // local date rolled over (also sent with CLOCK_EVENT_SET)
+#define CLOCK_EVENT_SET    (1u << 2)  // wall clock was set or jumped
+
+// Called with the events that happened and the local time they happened at. Runs in
+// the task that ticked or set the clock, so subscribers must not block.
+typedef void (*clock_listener_fn)(uint32_t events, const struct tm *local, void *ctx);
+
+// Registers listener for the events in mask. Subscribers are never removed.
+esp_err_t clock_service_subscribe(uint32_t mask, clock_listener_fn listener, void *ctx);
+
+// Current wall clock and local time, from the cache while the minute lasts.
+time_t clock_service_now(struct tm *local);
+
+// Drop-in replacement for localtime_r(). Served from the cache when t lies in the
+// cached minute, which is the case for "now" in every pass of every task. Other
+// times are converted with localtime_r() and leave the cache alone, unless t lies in
+// the minute right after the cached one.
+struct tm *clock_service_localtime(time_t t, struct tm *local);
+
+// Publishes the minute and day rollovers since the previous tick. Call once per second.
+void clock_service_tick(void);
+
+// Tells the service the wall clock was just set: refreshes the cache and sends
+// CLOCK_EVENT_SET | CLOCK_EVENT_DAY to the subscribers.
+void clock_service_time_set(void);
+
+#endif // CLOCK_SERVICE_H
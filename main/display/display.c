@@ -1,10 +1,57 @@
 #include "display.h"
+#include "display_widgets.h"
+#include "clock_service.h"
 
 
 
 static const char *DISPLAY_TAG = "display";
 
+// Layouts of the widget tree below; a screen function builds its layout when another
+// one is on the buffer and otherwise only sets the data of its widgets.
+typedef enum {
+    LAYOUT_CLOCK,
+    LAYOUT_CLOCK_UNSET,
+    LAYOUT_TASK_OPTIONS,
+    LAYOUT_MESSAGE,
+    LAYOUT_LIST,
+} display_layout_id_t;
+
+#define MESSAGE_LINE_CHARS 23   // 5x7 characters on a message line
+
+static const int text_row_y[4] = { 22, 35, 47, 59 };  // message lines and list rows
+
+// Widgets on the frame buffer. Only the compositor task draws, so no lock.
+static display_widget_tree_t screen_tree = DISPLAY_WIDGET_TREE_INIT;
+static int status_bar_id;
+static int text_ids[4];
+
+// u8g2 setup of the panel for the buffer chosen by DISPLAY_PAGE_BUFFER
+#if DISPLAY_PAGE_BUFFER == 1
+#define DISPLAY_SETUP u8g2_Setup_sh1106_i2c_128x64_noname_1
+#elif DISPLAY_PAGE_BUFFER == 2
+#define DISPLAY_SETUP u8g2_Setup_sh1106_i2c_128x64_noname_2
+#else
+#define DISPLAY_SETUP u8g2_Setup_sh1106_i2c_128x64_noname_f
+#endif
 
+/**
+ * @brief Draws the changed widgets of screen_tree and sends them to the display: once
+ *        into the full buffer, or in passes of the page buffer.
+ */
+static void show_screen_tree(u8g2_t *u8g2)
+{
+#if DISPLAY_PAGE_BUFFER
+    display_widgets_render_pages(&screen_tree, u8g2);
+#else
+    display_widgets_render(&screen_tree, u8g2);
+    display_send_frame(u8g2);
+#endif
+}
+
+
+// Bench test of the panel on a full buffer of its own. Left out of page buffer builds,
+// where it would link in the 1 KB buffer of the _f setup.
+#if !CONFIG_IDF_TARGET_LINUX && !DISPLAY_PAGE_BUFFER
 void task_test_SSD1306i2c(void* ignore) {
   u8g2_esp32_hal_t u8g2_esp32_hal = U8G2_ESP32_HAL_DEFAULT;
   u8g2_esp32_hal.bus.i2c.sda = PIN_SDA;
@@ -58,6 +105,16 @@ u8g2_DrawLine(&u8g2, 0, 46, 116, 46);
 u8g2_SendBuffer(&u8g2);
   vTaskDelete(NULL);
 }
+#endif
+
+// Date line of the idle clock screen, formatted again only after a day rollover.
+static char idle_date_str[32];
+static volatile bool idle_date_stale = true;
+
+static void on_clock_day(uint32_t events, const struct tm *local, void *ctx)
+{
+    idle_date_stale = true;
+}
 
 /**
  * @brief Initialize a SSD1306 I2C display using a provided u8g2 object.
@@ -65,23 +122,36 @@ u8g2_SendBuffer(&u8g2);
  * This function configures the u8g2 object for a 128x64 SSD1306 display. The function
  * initializes the display hardware using your defined I2C pins (PIN_SDA and PIN_SCL) and
  * sets the power-save mode off. The configured u8g2 object can then be used for drawing.
+ * On the linux target the bytes go to the panel model of host/display_host.c instead.
+ * The u8g2 buffer is the full frame or the page buffer chosen by DISPLAY_PAGE_BUFFER.
  *
  * @param u8g2 Pointer to an unconfigured u8g2_t structure.
  */
 void init_ssd1306_display(u8g2_t *u8g2)
 {
+    clock_service_subscribe(CLOCK_EVENT_DAY, on_clock_day, NULL);
+
+#if CONFIG_IDF_TARGET_LINUX
+    DISPLAY_SETUP(
+        u8g2,
+        U8G2_R0,
+        display_host_byte_cb,
+        display_host_gpio_and_delay_cb);
+#else
     u8g2_esp32_hal_t u8g2_esp32_hal = U8G2_ESP32_HAL_DEFAULT;
     u8g2_esp32_hal.bus.i2c.sda = PIN_SDA;
     u8g2_esp32_hal.bus.i2c.scl = PIN_SCL;
     u8g2_esp32_hal_init(u8g2_esp32_hal);
 
-    u8g2_Setup_sh1106_i2c_128x64_noname_f(
+    DISPLAY_SETUP(
         u8g2,
         U8G2_R0,
         u8g2_esp32_i2c_byte_cb,
         u8g2_esp32_gpio_and_delay_cb);
+#endif
 
     u8x8_SetI2CAddress(&u8g2->u8x8, 0x78);
+    display_frame_init(u8g2);
 
     ESP_LOGI(DISPLAY_TAG, "u8g2_InitDisplay");
     u8g2_InitDisplay(u8g2);
@@ -130,6 +200,40 @@ void init_ssd1306_display(u8g2_t *u8g2)
     u8g2_SetDrawColor(u8g2, 1);
 }
 
+/**
+ * @brief Renders the four option texts of a task along with a top bar
+ *        showing WiFi and time status.
+ *
+ * @param u8g2         Pointer to an initialized u8g2 display context.
+ * @param wifi_status  0 for OK, non-zero otherwise
+ * @param time_status  0 for OK, non-zero otherwise
+ * @param options      TASK_MAX_OPTIONS display texts
+ */
+void display_task_options(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status, const char *const options[TASK_MAX_OPTIONS])
+{
+    if (display_widgets_begin(&screen_tree, LAYOUT_TASK_OPTIONS)) {
+        status_bar_id = display_widgets_add_status_bar(&screen_tree);
+        // Lines at 22, 36, 50 => text just above
+        display_widgets_add_separator(&screen_tree, 0, 22, 127);
+        display_widgets_add_separator(&screen_tree, 0, 36, 127);
+        display_widgets_add_separator(&screen_tree, 0, 50, 127);
+        for (int i = 0; i < TASK_MAX_OPTIONS; i++) {
+            text_ids[i] = display_widgets_add_label(&screen_tree, u8g2, u8g2_font_profont15_tr, 0, 20 + (i * 14), 0);
+        }
+    }
+    display_widgets_set_status(&screen_tree, status_bar_id, wifi_status, time_status);
+
+    // The four options, in a smaller font when long
+    for (int i = 0; i < TASK_MAX_OPTIONS; i++) {
+        const char *disp_text = options[i];
+        const uint8_t *font = strlen(disp_text) > 16 ? u8g2_font_haxrcorp4089_tr : u8g2_font_profont15_tr;
+        display_widgets_set_label(&screen_tree, u8g2, text_ids[i], font, disp_text, false);
+    }
+
+    // Draw the changed widgets and send them to the display
+    show_screen_tree(u8g2);
+}
+
 /**
  * @brief Renders Task Type 1 data (4 options) along with a top bar
  *        showing WiFi and time status.
@@ -146,35 +250,11 @@ esp_err_t display_task_type1(uint8_t wifi_status, uint8_t time_status, const tas
         ESP_LOGE(DISPLAY_TAG, "Invalid task or task type not equal to 1");
         return ESP_ERR_INVALID_ARG;
     }
-
-    // Begin drawing on the display
-    u8g2_ClearBuffer(&u8g2);
-    u8g2_SetBitmapMode(&u8g2, 1);
-    u8g2_SetFontMode(&u8g2, 1);
-
-    // Draw lines
-    u8g2_DrawLine(&u8g2, 0, 22, 127, 22);
-    u8g2_DrawLine(&u8g2, 0, 36, 127, 36);
-    u8g2_DrawLine(&u8g2, 0, 50, 127, 50);
-
-    // Render the four options
+    const char *options[TASK_MAX_OPTIONS];
     for (int i = 0; i < TASK_MAX_OPTIONS; i++) {
-        const char *disp_text = task->Options[i].display_text;
-        if (strlen(disp_text) > 16) {
-            u8g2_SetFont(&u8g2, u8g2_font_haxrcorp4089_tr);
-        } else {
-            u8g2_SetFont(&u8g2, u8g2_font_profont15_tr);
-        }
-        int y = 20 + (i * 14);  // Lines at 22, 36, 50 => text just above
-        u8g2_DrawStr(&u8g2, 0, y, disp_text);
+        options[i] = task->Options[i].display_text;
     }
-
-    // Render the top info bar with WiFi and Time status
-    render_top_info_bar(&u8g2, wifi_status, time_status);
-
-    // Send the buffer to the display
-    u8g2_SendBuffer(&u8g2);
-
+    display_task_options(&u8g2, wifi_status, time_status, options);
     return ESP_OK;
 }
 
@@ -192,75 +272,54 @@ esp_err_t display_task_type1(uint8_t wifi_status, uint8_t time_status, const tas
  */
 void display_idle_clock_screen(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status)
 {
-    // Retrieve current system time
-    time_t now = time(NULL);
+    // Current local time from the clock service cache
     struct tm timeinfo;
-    localtime_r(&now, &timeinfo);
+    clock_service_now(&timeinfo);
 
     // Format main time string as "HH:MM" (e.g., "18:30")
     char main_time[16];
     snprintf(main_time, sizeof(main_time), "%02d:%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
 
     // Format date string as "Weekday dd.mm" (e.g., "Wednesday 11.12")
-    char date_str[32];
-    strftime(date_str, sizeof(date_str), "%A %d.%m", &timeinfo);
-
-    // Clear display and set drawing modes
-    u8g2_ClearBuffer(u8g2);
-    u8g2_SetBitmapMode(u8g2, 1);
-    u8g2_SetFontMode(u8g2, 1);
-
-    // Render the top info bar to show WiFi and Time status
-    render_top_info_bar(u8g2, wifi_status, time_status);
+    if (idle_date_stale) {
+        idle_date_stale = false;
+        strftime(idle_date_str, sizeof(idle_date_str), "%A %d.%m", &timeinfo);
+    }
 
     // If system time is not set (tm_year < 70 indicates before 1970), show error message
     if(timeinfo.tm_year < 71)
     {
-        ESP_LOGW(DISPLAY_TAG, "Time not set ");
-        u8g2_SetFont(u8g2, u8g2_font_timR14_tr);
-        u8g2_DrawStr(u8g2, 10, 30, "Time not set");
-        u8g2_DrawStr(u8g2, 10, 50, "Check WiFi");
-
-
+        if (display_widgets_begin(&screen_tree, LAYOUT_CLOCK_UNSET)) {
+            ESP_LOGW(DISPLAY_TAG, "Time not set ");
+            status_bar_id = display_widgets_add_status_bar(&screen_tree);
+            text_ids[0] = display_widgets_add_label(&screen_tree, u8g2, u8g2_font_timR14_tr, 10, 30, 0);
+            text_ids[1] = display_widgets_add_label(&screen_tree, u8g2, u8g2_font_timR14_tr, 10, 50, 0);
+            display_widgets_set_label(&screen_tree, u8g2, text_ids[0], u8g2_font_timR14_tr, "Time not set", false);
+            display_widgets_set_label(&screen_tree, u8g2, text_ids[1], u8g2_font_timR14_tr, "Check WiFi", false);
+        }
     }
     else{
-    // Draw the main time as HH:MM using a large font
-    u8g2_SetFont(u8g2, u8g2_font_timR24_tr);
-    u8g2_DrawStr(u8g2, 1, 43, main_time);
-
-    // Draw the date string using a small font
-    u8g2_SetFont(u8g2, u8g2_font_timR10_tr);
-    u8g2_DrawStr(u8g2, 4, 60, date_str);
-
-    // Draw a horizontal separator line
-    u8g2_DrawLine(u8g2, 0, 46, 116, 46);
+        if (display_widgets_begin(&screen_tree, LAYOUT_CLOCK)) {
+            status_bar_id = display_widgets_add_status_bar(&screen_tree);
+            // Main time in a large font; digits and colons stay between the bar and the separator
+            text_ids[0] = display_widgets_add_label(&screen_tree, u8g2, u8g2_font_timR24_tr, 1, 43, 0);
+            display_widgets_set_box(&screen_tree, text_ids[0], 0, 10, 128, 36);
+            // Horizontal separator line
+            display_widgets_add_separator(&screen_tree, 0, 46, 116);
+            // Date string in a small font
+            text_ids[1] = display_widgets_add_label(&screen_tree, u8g2, u8g2_font_timR10_tr, 4, 60, 0);
+        }
+        display_widgets_set_label(&screen_tree, u8g2, text_ids[0], u8g2_font_timR24_tr, main_time, false);
+        display_widgets_set_label(&screen_tree, u8g2, text_ids[1], u8g2_font_timR10_tr, idle_date_str, false);
     }
-    // Send the buffer to the display
-    u8g2_SendBuffer(u8g2);
-}
+    // Top info bar with WiFi and Time status, redrawn only when one of them changed
+    display_widgets_set_status(&screen_tree, status_bar_id, wifi_status, time_status);
 
-
-// Helper function to pad the input line to a width of 23 characters
-// by adding leading spaces. The result is written into dest.
-static void pad_line(const char *line, char *dest, int center)
-{
-    const int maxWidth = 23;
-    int len = strlen(line);
-    if (len > maxWidth) {
-        len = maxWidth;
-    }
-    if (center && len < maxWidth) {
-        int pad = (maxWidth - len) / 2;
-        memset(dest, ' ', pad);
-        memcpy(dest + pad, line, len);
-        dest[pad + len] = '\0';
-    } else {
-        // Copy up to maxWidth characters and null-terminate
-        strncpy(dest, line, maxWidth);
-        dest[maxWidth] = '\0';
-    }
+    // Draw the changed widgets and send them to the display
+    show_screen_tree(u8g2);
 }
 
+
 /**
  * @brief Display a message composed of a header and 4 lines.
  *
@@ -283,31 +342,52 @@ static void pad_line(const char *line, char *dest, int center)
 void display_message(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status, const char *line1, const char *line2,
                      const char *line3, const char *line4, int center)
 {
-    char buf[24]; // Buffer for a padded line (23 characters + null terminator)
+    const char *lines[4] = { line1, line2, line3, line4 };
 
-    // Clear display buffer
-    u8g2_ClearBuffer(u8g2);
-
-    // Render the top info bar with WiFi and Time status
-    render_top_info_bar(u8g2, wifi_status, time_status);
+    if (display_widgets_begin(&screen_tree, LAYOUT_MESSAGE)) {
+        status_bar_id = display_widgets_add_status_bar(&screen_tree);
+        for (int i = 0; i < 4; i++) {
+            text_ids[i] = display_widgets_add_label(&screen_tree, u8g2, u8g2_font_5x7_tr, 2, text_row_y[i],
+                                                    MESSAGE_LINE_CHARS);
+        }
+    }
+    // Top info bar with WiFi and Time status
+    display_widgets_set_status(&screen_tree, status_bar_id, wifi_status, time_status);
 
-    // Draw line1 at y = 22
-    pad_line(line1, buf, center);
-    u8g2_DrawStr(u8g2, 2, 22, buf);
+    // Lines at y = 22, 35, 47 and 59
+    for (int i = 0; i < 4; i++) {
+        display_widgets_set_label(&screen_tree, u8g2, text_ids[i], u8g2_font_5x7_tr, lines[i], center);
+    }
 
-    // Draw line2 at y = 35
-    pad_line(line2, buf, center);
-    u8g2_DrawStr(u8g2, 2, 35, buf);
+    // Draw the changed widgets and send them to the display
+    show_screen_tree(u8g2);
+}
 
-    // Draw line3 at y = 47
-    pad_line(line3, buf, center);
-    u8g2_DrawStr(u8g2, 2, 47, buf);
+/**
+ * @brief Displays a list of four rows below the top info bar, one of them highlighted.
+ *
+ * Used by the running reminders menu.
+ *
+ * @param u8g2        Pointer to an initialized u8g2 display context.
+ * @param wifi_status 0 if WiFi is OK; non-zero otherwise.
+ * @param time_status 0 if time is OK; non-zero otherwise.
+ * @param rows        Four row texts (empty rows are left blank).
+ * @param selected    Row drawn inverted, or -1 for none.
+ */
+void display_list(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status, const char *const rows[4], int selected)
+{
+    if (display_widgets_begin(&screen_tree, LAYOUT_LIST)) {
+        status_bar_id = display_widgets_add_status_bar(&screen_tree);
+        for (int row = 0; row < 4; row++) {
+            text_ids[row] = display_widgets_add_row(&screen_tree, u8g2, u8g2_font_5x7_tr, text_row_y[row]);
+        }
+    }
+    display_widgets_set_status(&screen_tree, status_bar_id, wifi_status, time_status);
 
-    // Draw line4 at y = 59
-    pad_line(line4, buf, center);
-    u8g2_DrawStr(u8g2, 2, 59, buf);
+    for (int row = 0; row < 4; row++) {
+        // Highlight current selection.
+        display_widgets_set_row(&screen_tree, text_ids[row], rows[row], row == selected);
+    }
 
-    // Send buffer to the display
-    u8g2_SendBuffer(u8g2);
+    show_screen_tree(u8g2);
 }
-
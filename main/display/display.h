@@ -6,7 +6,11 @@
 #define PIN_SCL 23
 
 #include <u8g2.h>
+#if CONFIG_IDF_TARGET_LINUX
+#include "display_host.h"  // host panel model in place of the I2C HAL
+#else
 #include <u8g2_esp32_hal.h>
+#endif
 #include "esp_log.h"
 #include "json_parser.h"
 #include <time.h>
@@ -15,11 +19,70 @@
 void task_test_SSD1306i2c(void* ignore);
 void init_ssd1306_display(u8g2_t *u8g2);
 esp_err_t display_task_type1(uint8_t wifi_status, uint8_t time_status, const task_t *task, u8g2_t u8g2);
+void display_task_options(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status, const char *const options[TASK_MAX_OPTIONS]);
 void display_idle_clock_screen(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status);
 void display_message(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status, const char *line1, const char *line2,
                      const char *line3, const char *line4, int center);
 void render_top_info_bar(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status);
+void display_list(u8g2_t *u8g2, uint8_t wifi_status, uint8_t time_status, const char *const rows[4], int selected);
 
+/*
+ * Frame buffer of u8g2.
+ *
+ * 0 keeps the full 1 KB buffer (u8g2_Setup_..._f) and the 1 KB copy of the panel
+ * display_send_frame() diffs against. 1 or 2 selects the page buffer of one or two
+ * tile rows (..._1: 128 bytes, ..._2: 256 bytes) and no panel copy: each frame is
+ * drawn in passes of the buffer height over the tile rows that changed, and those
+ * rows are sent whole across the changed columns. Pass it to the build with
+ * target_compile_definitions(... -DDISPLAY_PAGE_BUFFER=1).
+ */
+#ifndef DISPLAY_PAGE_BUFFER
+#define DISPLAY_PAGE_BUFFER 0
+#endif
+
+/*
+ * Frame transfer (display_frame.c).
+ *
+ * display_send_frame() replaces u8g2_SendBuffer(): it compares the buffer with the
+ * last frame sent, 8x8 tile by tile, and pushes only the changed tiles with
+ * u8g2_UpdateDisplayArea(). The idle clock then sends the seconds digits instead of
+ * the whole 1 KB frame every second. All drawing must go through it once
+ * display_frame_init() ran, or the copy of the panel goes stale.
+ *
+ * With DISPLAY_PAGE_BUFFER there is no frame to compare: the caller knows what
+ * changed and display_send_frame_pages() draws and sends that area pass by pass.
+ */
+#define DISPLAY_FRAME_BYTES (128 * 64 / 8)
+
+typedef struct {
+    uint32_t frames;            // frames sent
+    uint32_t full_frames;       // frames sent whole (first frame, after invalidation)
+    uint32_t tiles_sent;
+    uint32_t bytes_sent;        // bytes on the bus, commands and I2C addresses included
+    uint32_t passes;            // buffer passes drawn (one per frame with the full buffer)
+    uint32_t last_frame_tiles;
+    uint32_t last_frame_bytes;
+    uint32_t last_frame_passes;
+    uint32_t ram_bytes;         // u8g2 buffer plus the panel copy
+} display_frame_stats_t;
+
+// Draws the whole screen; u8g2 clips it to the buffer pass in progress.
+typedef void (*display_draw_fn)(u8g2_t *u8g2, void *ctx);
+
+// Hooks the bus byte counter into u8g2 and forgets the panel content. Call after the
+// u8g2 setup function, before the first frame.
+void display_frame_init(u8g2_t *u8g2);
+// The panel content is unknown (re-initialized, woken up); the next frame is sent whole.
+void display_frame_invalidate(void);
+#if DISPLAY_PAGE_BUFFER
+// Draws the tile rows covering the pixel area (x, y, w, h) in buffer passes and sends
+// the tiles of the area after each pass. The whole screen after an invalidation;
+// nothing for an empty area.
+void display_send_frame_pages(u8g2_t *u8g2, int x, int y, int w, int h, display_draw_fn draw, void *ctx);
+#else
+void display_send_frame(u8g2_t *u8g2);
+#endif
+void display_get_frame_stats(display_frame_stats_t *stats);
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "display.h"
+#include "display_compositor.h"
+#include "wifi_time.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include <sys/time.h>
+
+static const char *TAG = "display_compositor";
+
+#define COMPOSITOR_CLOCK_PERIOD_MS 1000  // redraw period of the top screen (clock seconds, status bar)
+
+typedef enum {
+    REQUEST_SHOW,
+    REQUEST_UPDATE,
+    REQUEST_REMOVE,
+} request_kind_t;
+
+typedef struct {
+    uint8_t kind;                   // request_kind_t
+    uint8_t screen;                 // display_screen_t
+    uint8_t priority;
+    uint32_t seq;                   // per-screen request number, see display_screen_active()
+    uint32_t ttl_ms;
+    display_content_t content;
+} display_request_t;
+
+typedef struct {
+    bool present;
+    uint8_t priority;
+    uint32_t order;                 // when it was last shown; breaks priority ties
+    int64_t ttl_left_us;            // screen time left, 0 for none
+    display_content_t content;
+} screen_entry_t;
+
+static QueueHandle_t request_queue = NULL;
+static u8g2_t *display_u8g2 = NULL;
+
+// Owned by the compositor task.
+static screen_entry_t stack[DISPLAY_SCREEN_COUNT];
+static uint32_t show_order = 0;
+
+// Request numbers per screen: posted by the callers, ended by the compositor when the
+// screen leaves the stack (the newest number it has seen for that screen). The screen
+// is active while they differ.
+static portMUX_TYPE seq_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t posted_seq[DISPLAY_SCREEN_COUNT];
+static volatile uint32_t ended_seq[DISPLAY_SCREEN_COUNT];
+static uint32_t latest_seq[DISPLAY_SCREEN_COUNT];  // compositor task only
+static volatile int visible_screen = -1;
+
+static esp_err_t post(request_kind_t kind, display_screen_t screen, uint8_t priority, uint32_t ttl_ms,
+                      const display_content_t *content)
+{
+    if (request_queue == NULL || screen <= DISPLAY_SCREEN_CLOCK || screen >= DISPLAY_SCREEN_COUNT) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    display_request_t request = { .kind = kind, .screen = screen, .priority = priority, .ttl_ms = ttl_ms };
+    if (content != NULL) {
+        request.content = *content;
+    }
+    taskENTER_CRITICAL(&seq_lock);
+    request.seq = ++posted_seq[screen];
+    taskEXIT_CRITICAL(&seq_lock);
+    if (xQueueSend(request_queue, &request, 0) != pdTRUE) {
+        // Give the number back so the screen does not look active forever. Exact as
+        // long as a screen whose activity is queried is posted by one task only.
+        taskENTER_CRITICAL(&seq_lock);
+        posted_seq[screen]--;
+        taskEXIT_CRITICAL(&seq_lock);
+        ESP_LOGW(TAG, "Render queue full, request for screen %d dropped", (int)screen);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+esp_err_t display_show(display_screen_t screen, uint8_t priority, uint32_t ttl_ms, const display_content_t *content)
+{
+    return post(REQUEST_SHOW, screen, priority, ttl_ms, content);
+}
+
+esp_err_t display_update(display_screen_t screen, const display_content_t *content)
+{
+    return post(REQUEST_UPDATE, screen, 0, 0, content);
+}
+
+esp_err_t display_remove(display_screen_t screen)
+{
+    return post(REQUEST_REMOVE, screen, 0, 0, NULL);
+}
+
+bool display_screen_active(display_screen_t screen)
+{
+    taskENTER_CRITICAL(&seq_lock);
+    bool active = posted_seq[screen] != ended_seq[screen];
+    taskEXIT_CRITICAL(&seq_lock);
+    return active;
+}
+
+bool display_screen_visible(display_screen_t screen)
+{
+    return visible_screen == (int)screen;
+}
+
+void display_content_message(display_content_t *content, const char *line1, const char *line2,
+                             const char *line3, const char *line4, bool center)
+{
+    const char *lines[DISPLAY_LINES] = { line1, line2, line3, line4 };
+    content->layout = DISPLAY_LAYOUT_MESSAGE;
+    content->center = center;
+    content->selected = -1;
+    for (int i = 0; i < DISPLAY_LINES; i++) {
+        snprintf(content->lines[i], DISPLAY_LINE_LEN, "%s", lines[i] ? lines[i] : "");
+    }
+}
+
+esp_err_t display_show_message(display_screen_t screen, uint8_t priority, uint32_t ttl_ms, const char *line1,
+                               const char *line2, const char *line3, const char *line4)
+{
+    display_content_t content;
+    display_content_message(&content, line1, line2, line3, line4, true);
+    return display_show(screen, priority, ttl_ms, &content);
+}
+
+static void drop_entry(int screen)
+{
+    stack[screen].present = false;
+    taskENTER_CRITICAL(&seq_lock);
+    ended_seq[screen] = latest_seq[screen];
+    taskEXIT_CRITICAL(&seq_lock);
+}
+
+/**
+ * @brief Applies one request to the stack.
+ *
+ * @return true if it changed what may be on screen.
+ */
+static bool apply_request(const display_request_t *request)
+{
+    screen_entry_t *entry = &stack[request->screen];
+    // Two tasks posting for the same screen may queue out of order.
+    if ((int32_t)(request->seq - latest_seq[request->screen]) > 0) {
+        latest_seq[request->screen] = request->seq;
+    }
+    switch (request->kind) {
+        case REQUEST_SHOW:
+            entry->present = true;
+            entry->priority = request->priority;
+            entry->order = ++show_order;
+            entry->ttl_left_us = (int64_t)request->ttl_ms * 1000;
+            entry->content = request->content;
+            return true;
+        case REQUEST_UPDATE:
+            if (!entry->present) {
+                drop_entry(request->screen);  // already gone, and must not look active
+                return false;
+            }
+            entry->content = request->content;
+            return true;
+        case REQUEST_REMOVE:
+            drop_entry(request->screen);
+            return true;
+    }
+    return false;
+}
+
+static int top_screen(void)
+{
+    int top = DISPLAY_SCREEN_CLOCK;
+    for (int i = DISPLAY_SCREEN_CLOCK + 1; i < DISPLAY_SCREEN_COUNT; i++) {
+        if (stack[i].present &&
+            (stack[i].priority > stack[top].priority ||
+             (stack[i].priority == stack[top].priority && stack[i].order > stack[top].order))) {
+            top = i;
+        }
+    }
+    return top;
+}
+
+static void render(int screen)
+{
+    uint8_t wifi_status = get_wifi_status();
+    uint8_t time_status = get_time_validity();
+    if (screen == DISPLAY_SCREEN_CLOCK) {
+        display_idle_clock_screen(display_u8g2, wifi_status, time_status);
+        return;
+    }
+    const display_content_t *content = &stack[screen].content;
+    const char *lines[DISPLAY_LINES];
+    for (int i = 0; i < DISPLAY_LINES; i++) {
+        lines[i] = content->lines[i];
+    }
+    switch (content->layout) {
+        case DISPLAY_LAYOUT_TASK:
+            display_task_options(display_u8g2, wifi_status, time_status, lines);
+            break;
+        case DISPLAY_LAYOUT_LIST:
+            display_list(display_u8g2, wifi_status, time_status, lines, content->selected);
+            break;
+        default:
+            display_message(display_u8g2, wifi_status, time_status,
+                            lines[0], lines[1], lines[2], lines[3], content->center);
+            break;
+    }
+}
+
+/**
+ * @brief Milliseconds until the next whole second of the wall clock, so the clock's
+ *        seconds change on time.
+ */
+static uint32_t ms_to_next_second(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return COMPOSITOR_CLOCK_PERIOD_MS - (uint32_t)(tv.tv_usec / 1000) % COMPOSITOR_CLOCK_PERIOD_MS;
+}
+
+static void display_compositor_task(void *params)
+{
+    stack[DISPLAY_SCREEN_CLOCK].present = true;
+    stack[DISPLAY_SCREEN_CLOCK].priority = DISPLAY_PRIORITY_CLOCK;
+    int shown = -1;
+    int64_t shown_since_us = esp_timer_get_time();
+    bool first_frame = true;
+    display_request_t request;
+
+    while (1) {
+        // Screen time of the top screen until its TTL or the next redraw.
+        uint32_t wait_ms = ms_to_next_second();
+        if (shown > DISPLAY_SCREEN_CLOCK && stack[shown].present && stack[shown].ttl_left_us > 0) {
+            int64_t left_ms = (stack[shown].ttl_left_us + 999) / 1000;
+            if (left_ms < wait_ms) {
+                wait_ms = (uint32_t)left_ms;
+            }
+        }
+        bool received = xQueueReceive(request_queue, &request, pdMS_TO_TICKS(wait_ms)) == pdTRUE;
+
+        // Charge the time since the last pass to the screen that was showing.
+        bool changed = !received;  // periodic redraw
+        int64_t now_us = esp_timer_get_time();
+        if (shown >= 0 && stack[shown].present && stack[shown].ttl_left_us > 0) {
+            stack[shown].ttl_left_us -= now_us - shown_since_us;
+            if (stack[shown].ttl_left_us <= 0) {
+                drop_entry(shown);
+                changed = true;
+            }
+        }
+        shown_since_us = now_us;
+
+        if (received) {
+            changed |= apply_request(&request);
+            // Take everything queued meanwhile before drawing once.
+            while (xQueueReceive(request_queue, &request, 0) == pdTRUE) {
+                changed |= apply_request(&request);
+            }
+        }
+
+        int top = top_screen();
+        if (!changed && top == shown) {
+            continue;
+        }
+        if (top != shown) {
+            ESP_LOGD(TAG, "Screen %d on top", top);
+        }
+        render(top);
+        shown = top;
+        visible_screen = top;
+        if (first_frame) {
+            first_frame = false;
+            ESP_LOGI(TAG, "Boot to first screen: %lld ms", esp_timer_get_time() / 1000);
+        }
+    }
+}
+
+esp_err_t display_compositor_start(u8g2_t *u8g2)
+{
+    display_u8g2 = u8g2;
+    request_queue = xQueueCreate(DISPLAY_QUEUE_LEN, sizeof(display_request_t));
+    if (request_queue == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (xTaskCreate(display_compositor_task, "display_compositor", 4096, NULL, 2, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the compositor task");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,86 @@
+#ifndef DISPLAY_COMPOSITOR_H
+#define DISPLAY_COMPOSITOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+// Only pointers are used here, so the host simulator builds without u8g2;
+// u8g2.h declares the same typedef.
+typedef struct u8g2_struct u8g2_t;
+
+/*
+ * Display compositor.
+ *
+ * One task owns the display. Other tasks never draw: they post render requests
+ * (screen id, priority, content, time to live) to its queue and return at once.
+ * The compositor keeps a stack with at most one entry per screen id and shows the
+ * entry with the highest priority, the most recently shown one among equals. The
+ * idle clock sits at the bottom of the stack and is redrawn every second while it
+ * is on top, so it comes back on its own when the other screens are gone.
+ *
+ * The time to live is screen time: it only runs down while the screen is on top,
+ * so a notification covered by a menu keeps the rest of its time for later.
+ */
+
+#define DISPLAY_LINES 4
+#define DISPLAY_LINE_LEN 36         // "T: " and the longest task name, plus terminator
+#define DISPLAY_QUEUE_LEN 8         // requests waiting for the compositor
+
+typedef enum {
+    DISPLAY_SCREEN_CLOCK,           // idle clock, always at the bottom of the stack
+    DISPLAY_SCREEN_NOTIFICATION,    // alarm notification
+    DISPLAY_SCREEN_TASK,            // options of a scanned RFID task, and its prompts
+    DISPLAY_SCREEN_MENU,            // running reminders menu
+    DISPLAY_SCREEN_MESSAGE,         // short confirmations
+    DISPLAY_SCREEN_COUNT
+} display_screen_t;
+
+// Priorities used by the firmware's screens; higher preempts lower.
+#define DISPLAY_PRIORITY_CLOCK        0
+#define DISPLAY_PRIORITY_NOTIFICATION 1
+#define DISPLAY_PRIORITY_USER         2  // screens the user is interacting with
+#define DISPLAY_PRIORITY_MESSAGE      3
+
+#define DISPLAY_MESSAGE_MS 2000     // screen time of a confirmation message
+
+typedef enum {
+    DISPLAY_LAYOUT_MESSAGE,         // display_message(): four lines
+    DISPLAY_LAYOUT_TASK,            // display_task_options(): the four options of a task
+    DISPLAY_LAYOUT_LIST,            // display_list(): four rows, one highlighted
+} display_layout_t;
+
+typedef struct {
+    display_layout_t layout;
+    bool center;                    // MESSAGE: center each line
+    int8_t selected;                // LIST: highlighted row, -1 for none
+    char lines[DISPLAY_LINES][DISPLAY_LINE_LEN];
+} display_content_t;
+
+// Creates the compositor task drawing on u8g2 (set up with init_ssd1306_display()).
+esp_err_t display_compositor_start(u8g2_t *u8g2);
+
+// Puts screen on top of the entries of its priority, replacing its previous content
+// and time to live. ttl_ms is screen time, 0 keeps it until display_remove().
+// Never blocks; ESP_ERR_TIMEOUT if the queue is full.
+esp_err_t display_show(display_screen_t screen, uint8_t priority, uint32_t ttl_ms, const display_content_t *content);
+// Replaces the content of screen if it is still in the stack, keeping its place and
+// the rest of its time to live.
+esp_err_t display_update(display_screen_t screen, const display_content_t *content);
+// Takes screen off the stack.
+esp_err_t display_remove(display_screen_t screen);
+
+// True from display_show() until the screen is removed or its time to live ran out.
+// Exact for screens posted by a single task, which is how the notification is used.
+bool display_screen_active(display_screen_t screen);
+// True while screen is the one on the display.
+bool display_screen_visible(display_screen_t screen);
+
+// Builds a DISPLAY_LAYOUT_MESSAGE content (NULL lines are left empty).
+void display_content_message(display_content_t *content, const char *line1, const char *line2,
+                             const char *line3, const char *line4, bool center);
+// Shows a centered message on screen.
+esp_err_t display_show_message(display_screen_t screen, uint8_t priority, uint32_t ttl_ms, const char *line1,
+                               const char *line2, const char *line3, const char *line4);
+
+#endif // DISPLAY_COMPOSITOR_H
@@ -0,0 +1,184 @@
+#include "display.h"
+#include <string.h>
+
+static const char *TAG = "display_frame";
+
+#if !DISPLAY_PAGE_BUFFER
+// Dirty tiles separated by at most this many clean tiles are sent as one area: a
+// clean tile costs 8 data bytes, a new area its addressing commands and transfer.
+#define FRAME_MERGE_GAP_TILES 1
+
+// Copy of what the panel shows, in the u8g2 tile layout (one tile row of 8 pixel
+// rows is tile_width * 8 bytes, each byte a vertical column of 8 pixels).
+static uint8_t sent_frame[DISPLAY_FRAME_BYTES];
+#endif
+static bool sent_valid = false;
+
+static display_frame_stats_t stats;
+
+// Byte layer of the bus, wrapped to count what it carries.
+static u8x8_msg_cb bus_byte_cb = NULL;
+static uint32_t bus_bytes = 0;
+
+static uint8_t counting_byte_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+    if (msg == U8X8_MSG_BYTE_SEND) {
+        bus_bytes += arg_int;
+    } else if (msg == U8X8_MSG_BYTE_START_TRANSFER) {
+        bus_bytes++;  // I2C address byte
+    }
+    return bus_byte_cb(u8x8, msg, arg_int, arg_ptr);
+}
+
+void display_frame_init(u8g2_t *u8g2)
+{
+    if (u8g2->u8x8.byte_cb != counting_byte_cb) {
+        bus_byte_cb = u8g2->u8x8.byte_cb;
+        u8g2->u8x8.byte_cb = counting_byte_cb;
+    }
+    display_frame_invalidate();
+
+    uint32_t buffer_bytes = (uint32_t)u8g2_GetBufferTileWidth(u8g2) * u8g2_GetBufferTileHeight(u8g2) * 8;
+#if DISPLAY_PAGE_BUFFER
+    uint32_t copy_bytes = 0;
+#else
+    uint32_t copy_bytes = sizeof(sent_frame);
+#endif
+    stats.ram_bytes = buffer_bytes + copy_bytes;
+    ESP_LOGI(TAG, "Frame RAM: %u bytes (u8g2 buffer %u, panel copy %u)", (unsigned)stats.ram_bytes,
+             (unsigned)buffer_bytes, (unsigned)copy_bytes);
+}
+
+void display_frame_invalidate(void)
+{
+    sent_valid = false;
+}
+
+static void frame_sent(uint32_t tiles, uint32_t bytes, uint32_t passes)
+{
+    stats.frames++;
+    stats.tiles_sent += tiles;
+    stats.bytes_sent += bytes;
+    stats.passes += passes;
+    stats.last_frame_tiles = tiles;
+    stats.last_frame_bytes = bytes;
+    stats.last_frame_passes = passes;
+    ESP_LOGD(TAG, "Frame %u: %u tile(s), %u bytes, %u pass(es)", (unsigned)stats.frames, (unsigned)tiles,
+             (unsigned)bytes, (unsigned)passes);
+}
+
+#if DISPLAY_PAGE_BUFFER
+
+void display_send_frame_pages(u8g2_t *u8g2, int x, int y, int w, int h, display_draw_fn draw, void *ctx)
+{
+    u8x8_t *u8x8 = u8g2_GetU8x8(u8g2);
+    int tile_width = u8g2_GetBufferTileWidth(u8g2);
+    int tile_height = u8x8->display_info->tile_height;
+    int pass_rows = u8g2_GetBufferTileHeight(u8g2);
+    uint32_t bytes_before = bus_bytes;
+    uint32_t tiles = 0;
+    uint32_t passes = 0;
+
+    if (!sent_valid) {
+        x = 0;
+        y = 0;
+        w = tile_width * 8;
+        h = tile_height * 8;
+        sent_valid = true;
+        stats.full_frames++;
+    }
+    // Tiles touched by the area
+    int tx0 = x < 0 ? 0 : x / 8;
+    int ty0 = y < 0 ? 0 : y / 8;
+    int tx1 = (x + w + 7) / 8;
+    int ty1 = (y + h + 7) / 8;
+    if (tx1 > tile_width) {
+        tx1 = tile_width;
+    }
+    if (ty1 > tile_height) {
+        ty1 = tile_height;
+    }
+
+    if (w > 0 && h > 0 && tx0 < tx1) {
+        // Passes start at the first changed row, so u8g2 never draws a row above it.
+        for (int row = ty0; row < ty1; row += pass_rows) {
+            u8g2_SetBufferCurrTileRow(u8g2, row);
+            u8g2_ClearBuffer(u8g2);
+            draw(u8g2, ctx);
+            passes++;
+            const uint8_t *buffer = u8g2_GetBufferPtr(u8g2);
+            for (int ty = row; ty < row + pass_rows && ty < ty1; ty++) {
+                u8x8_DrawTile(u8x8, tx0, ty, tx1 - tx0, (uint8_t *)buffer + ((ty - row) * tile_width + tx0) * 8);
+                tiles += tx1 - tx0;
+            }
+        }
+    }
+
+    frame_sent(tiles, bus_bytes - bytes_before, passes);
+}
+
+#else
+
+static inline bool tile_dirty(const uint8_t *frame, size_t offset)
+{
+    return memcmp(frame + offset, sent_frame + offset, 8) != 0;
+}
+
+void display_send_frame(u8g2_t *u8g2)
+{
+    const uint8_t *frame = u8g2_GetBufferPtr(u8g2);
+    int tile_width = u8g2_GetBufferTileWidth(u8g2);
+    int tile_height = u8g2_GetBufferTileHeight(u8g2);
+    size_t frame_bytes = (size_t)tile_width * tile_height * 8;
+    uint32_t bytes_before = bus_bytes;
+    uint32_t tiles = 0;
+
+    if (frame_bytes > sizeof(sent_frame)) {
+        // Not a full frame buffer this module knows; send it as it is.
+        u8g2_SendBuffer(u8g2);
+        tiles = (uint32_t)tile_width * tile_height;
+    } else if (!sent_valid) {
+        u8g2_SendBuffer(u8g2);
+        memcpy(sent_frame, frame, frame_bytes);
+        sent_valid = true;
+        tiles = (uint32_t)tile_width * tile_height;
+        stats.full_frames++;
+    } else {
+        for (int ty = 0; ty < tile_height; ty++) {
+            size_t row = (size_t)ty * tile_width * 8;
+            int tx = 0;
+            while (tx < tile_width) {
+                if (!tile_dirty(frame, row + tx * 8)) {
+                    tx++;
+                    continue;
+                }
+                // Extend the area over dirty tiles and short clean gaps.
+                int end = tx + 1;
+                int gap = 0;
+                for (int next = end; next < tile_width && gap <= FRAME_MERGE_GAP_TILES; next++) {
+                    if (tile_dirty(frame, row + next * 8)) {
+                        end = next + 1;
+                        gap = 0;
+                    } else {
+                        gap++;
+                    }
+                }
+                u8g2_UpdateDisplayArea(u8g2, tx, ty, end - tx, 1);
+                memcpy(sent_frame + row + tx * 8, frame + row + tx * 8, (size_t)(end - tx) * 8);
+                tiles += end - tx;
+                tx = end;
+            }
+        }
+    }
+
+    frame_sent(tiles, bus_bytes - bytes_before, 1);
+}
+
+#endif // DISPLAY_PAGE_BUFFER
+
+void display_get_frame_stats(display_frame_stats_t *out)
+{
+    if (out) {
+        *out = stats;
+    }
+}
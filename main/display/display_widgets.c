@@ -0,0 +1,364 @@
+#include "display.h"
+#include "display_widgets.h"
+#include <string.h>
+
+static const char *TAG = "display_widgets";
+
+#define ROW_BAR_ABOVE 9     // highlight bar of a row: from y - 9 ...
+#define ROW_BAR_HEIGHT 12   // ... 12 pixels down
+
+bool display_widgets_begin(display_widget_tree_t *tree, int layout)
+{
+    if (tree->layout == layout) {
+        return false;
+    }
+    tree->layout = layout;
+    tree->count = 0;
+    tree->cleared = true;
+    return true;
+}
+
+void display_widgets_invalidate(display_widget_tree_t *tree)
+{
+    tree->layout = -1;
+}
+
+static display_widget_t *add_widget(display_widget_tree_t *tree, display_widget_kind_t kind, int *id)
+{
+    if (tree->count >= DISPLAY_WIDGETS_MAX) {
+        ESP_LOGE(TAG, "Layout %d has more than %d widgets", tree->layout, DISPLAY_WIDGETS_MAX);
+        *id = -1;
+        return NULL;
+    }
+    *id = tree->count++;
+    display_widget_t *widget = &tree->widgets[*id];
+    memset(widget, 0, sizeof(*widget));
+    widget->kind = kind;
+    widget->dirty = true;
+    return widget;
+}
+
+static void set_box(u8g2_t *u8g2, display_widget_t *widget, int x, int y, int w, int h)
+{
+    // u8g2 coordinates are unsigned: keep the box on the display.
+    int width = u8g2_GetDisplayWidth(u8g2);
+    int height = u8g2_GetDisplayHeight(u8g2);
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > width) { w = width - x; }
+    if (y + h > height) { h = height - y; }
+    widget->box_x = (int16_t)x;
+    widget->box_y = (int16_t)y;
+    widget->box_w = (int16_t)(w > 0 ? w : 0);
+    widget->box_h = (int16_t)(h > 0 ? h : 0);
+}
+
+/**
+ * @brief Box of a full-width text line in font at baseline y: from the ascent of 'A'
+ *        to the descent of 'g', with a pixel of margin for glyphs reaching further.
+ */
+static void font_box(u8g2_t *u8g2, const uint8_t *font, int y, int *top, int *height)
+{
+    u8g2_SetFont(u8g2, font);
+    int ascent = u8g2_GetAscent(u8g2);
+    int descent = u8g2_GetDescent(u8g2);  // negative below the baseline
+    *top = y - ascent - 1;
+    *height = ascent - descent + 3;
+}
+
+int display_widgets_add_status_bar(display_widget_tree_t *tree)
+{
+    int id;
+    display_widget_t *widget = add_widget(tree, DISPLAY_WIDGET_STATUS_BAR, &id);
+    if (widget != NULL) {
+        // render_top_info_bar() fills rows 0 to 8.
+        widget->box_w = 128;
+        widget->box_h = 9;
+        widget->wifi_status = 0xFF;  // nothing shown yet
+        widget->time_status = 0xFF;
+    }
+    return id;
+}
+
+int display_widgets_add_label(display_widget_tree_t *tree, u8g2_t *u8g2, const uint8_t *font, int x, int y,
+                              uint8_t max_chars)
+{
+    int id;
+    display_widget_t *widget = add_widget(tree, DISPLAY_WIDGET_LABEL, &id);
+    if (widget != NULL) {
+        int top, height;
+        font_box(u8g2, font, y, &top, &height);
+        widget->font = font;
+        widget->x = (int16_t)x;
+        widget->y = (int16_t)y;
+        widget->draw_x = (int16_t)x;
+        widget->max_chars = max_chars;
+        set_box(u8g2, widget, 0, top, u8g2_GetDisplayWidth(u8g2), height);
+    }
+    return id;
+}
+
+int display_widgets_add_row(display_widget_tree_t *tree, u8g2_t *u8g2, const uint8_t *font, int y)
+{
+    int id;
+    display_widget_t *widget = add_widget(tree, DISPLAY_WIDGET_ROW, &id);
+    if (widget != NULL) {
+        widget->font = font;
+        widget->x = 2;
+        widget->y = (int16_t)y;
+        set_box(u8g2, widget, 0, y - ROW_BAR_ABOVE, u8g2_GetDisplayWidth(u8g2), ROW_BAR_HEIGHT);
+    }
+    return id;
+}
+
+int display_widgets_add_separator(display_widget_tree_t *tree, int x1, int y, int x2)
+{
+    int id;
+    display_widget_t *widget = add_widget(tree, DISPLAY_WIDGET_SEPARATOR, &id);
+    if (widget != NULL) {
+        widget->x = (int16_t)x1;
+        widget->y = (int16_t)y;
+        widget->x2 = (int16_t)x2;
+        widget->box_x = (int16_t)x1;
+        widget->box_y = (int16_t)y;
+        widget->box_w = (int16_t)(x2 - x1 + 1);
+        widget->box_h = 1;
+    }
+    return id;
+}
+
+void display_widgets_set_box(display_widget_tree_t *tree, int id, int x, int y, int w, int h)
+{
+    if (id < 0 || id >= tree->count) {
+        return;
+    }
+    display_widget_t *widget = &tree->widgets[id];
+    widget->box_x = (int16_t)x;
+    widget->box_y = (int16_t)y;
+    widget->box_w = (int16_t)w;
+    widget->box_h = (int16_t)h;
+}
+
+void display_widgets_set_status(display_widget_tree_t *tree, int id, uint8_t wifi_status, uint8_t time_status)
+{
+    if (id < 0 || id >= tree->count) {
+        return;
+    }
+    display_widget_t *widget = &tree->widgets[id];
+    if (widget->wifi_status != wifi_status || widget->time_status != time_status) {
+        widget->wifi_status = wifi_status;
+        widget->time_status = time_status;
+        widget->dirty = true;
+    }
+}
+
+void display_widgets_set_label(display_widget_tree_t *tree, u8g2_t *u8g2, int id, const uint8_t *font,
+                               const char *text, bool center)
+{
+    if (id < 0 || id >= tree->count) {
+        return;
+    }
+    display_widget_t *widget = &tree->widgets[id];
+    if (text == NULL) {
+        text = "";
+    }
+    size_t len = strlen(text);
+    if (widget->max_chars > 0 && len > widget->max_chars) {
+        len = widget->max_chars;
+    }
+    if (len >= DISPLAY_WIDGET_TEXT_LEN) {
+        len = DISPLAY_WIDGET_TEXT_LEN - 1;
+    }
+    if (widget->font == font && widget->center == center &&
+        strncmp(widget->text, text, len) == 0 && widget->text[len] == '\0') {
+        return;  // same as on screen
+    }
+
+    if (widget->font != font) {
+        // The box keeps covering what the old font drew.
+        int top, height;
+        font_box(u8g2, font, widget->y, &top, &height);
+        int bottom = widget->box_y + widget->box_h;
+        if (top + height > bottom) {
+            bottom = top + height;
+        }
+        if (top > widget->box_y) {
+            top = widget->box_y;
+        }
+        set_box(u8g2, widget, widget->box_x, top, widget->box_w, bottom - top);
+        widget->font = font;
+    }
+    memcpy(widget->text, text, len);
+    widget->text[len] = '\0';
+    widget->center = center;
+    widget->draw_x = widget->x;
+    if (center && widget->max_chars > 0 && len < widget->max_chars) {
+        // Same offset as padding the text with leading spaces to max_chars.
+        u8g2_SetFont(u8g2, font);
+        int pad = (widget->max_chars - (int)len) / 2;
+        widget->draw_x = (int16_t)(widget->x + pad * u8g2_GetStrWidth(u8g2, " "));
+    }
+    widget->dirty = true;
+}
+
+void display_widgets_set_row(display_widget_tree_t *tree, int id, const char *text, bool selected)
+{
+    if (id < 0 || id >= tree->count) {
+        return;
+    }
+    display_widget_t *widget = &tree->widgets[id];
+    if (text == NULL) {
+        text = "";
+    }
+    if (widget->selected == selected && strncmp(widget->text, text, DISPLAY_WIDGET_TEXT_LEN - 1) == 0) {
+        return;
+    }
+    snprintf(widget->text, sizeof(widget->text), "%s", text);
+    widget->selected = selected;
+    widget->dirty = true;
+}
+
+static bool boxes_overlap(const display_widget_t *a, const display_widget_t *b)
+{
+    return a->box_x < b->box_x + b->box_w && b->box_x < a->box_x + a->box_w &&
+           a->box_y < b->box_y + b->box_h && b->box_y < a->box_y + a->box_h;
+}
+
+static void draw_widget(u8g2_t *u8g2, const display_widget_t *widget)
+{
+    switch (widget->kind) {
+        case DISPLAY_WIDGET_STATUS_BAR:
+            render_top_info_bar(u8g2, widget->wifi_status, widget->time_status);
+            break;
+        case DISPLAY_WIDGET_LABEL:
+            u8g2_SetFont(u8g2, widget->font);
+            u8g2_DrawStr(u8g2, widget->draw_x, widget->y, widget->text);
+            break;
+        case DISPLAY_WIDGET_ROW:
+            u8g2_SetFont(u8g2, widget->font);
+            if (widget->selected) {
+                u8g2_DrawBox(u8g2, widget->box_x, widget->box_y, widget->box_w, widget->box_h);
+                u8g2_SetDrawColor(u8g2, 0);
+                u8g2_DrawStr(u8g2, widget->x, widget->y, widget->text);
+                u8g2_SetDrawColor(u8g2, 1);
+            } else {
+                u8g2_DrawStr(u8g2, widget->x, widget->y, widget->text);
+            }
+            break;
+        case DISPLAY_WIDGET_SEPARATOR:
+            u8g2_DrawLine(u8g2, widget->x, widget->y, widget->x2, widget->y);
+            break;
+    }
+}
+
+int display_widgets_render(display_widget_tree_t *tree, u8g2_t *u8g2)
+{
+    u8g2_SetBitmapMode(u8g2, 1);
+    u8g2_SetFontMode(u8g2, 1);
+    u8g2_SetDrawColor(u8g2, 1);
+
+    if (tree->cleared) {
+        tree->cleared = false;
+        u8g2_ClearBuffer(u8g2);
+        for (int i = 0; i < tree->count; i++) {
+            tree->widgets[i].dirty = true;
+        }
+    } else {
+        // Clearing a box also erases the part of any neighbour inside it, so those
+        // neighbours are drawn again too (until no more boxes are added).
+        bool added = true;
+        while (added) {
+            added = false;
+            for (int i = 0; i < tree->count; i++) {
+                if (!tree->widgets[i].dirty) {
+                    continue;
+                }
+                for (int j = 0; j < tree->count; j++) {
+                    if (!tree->widgets[j].dirty && boxes_overlap(&tree->widgets[i], &tree->widgets[j])) {
+                        tree->widgets[j].dirty = true;
+                        added = true;
+                    }
+                }
+            }
+        }
+        u8g2_SetDrawColor(u8g2, 0);
+        for (int i = 0; i < tree->count; i++) {
+            const display_widget_t *widget = &tree->widgets[i];
+            if (widget->dirty && widget->box_w > 0 && widget->box_h > 0) {
+                u8g2_DrawBox(u8g2, widget->box_x, widget->box_y, widget->box_w, widget->box_h);
+            }
+        }
+        u8g2_SetDrawColor(u8g2, 1);
+    }
+
+    int drawn = 0;
+    for (int i = 0; i < tree->count; i++) {
+        if (tree->widgets[i].dirty) {
+            draw_widget(u8g2, &tree->widgets[i]);
+            tree->widgets[i].dirty = false;
+            drawn++;
+        }
+    }
+    return drawn;
+}
+
+#if DISPLAY_PAGE_BUFFER
+
+// display_draw_fn of the page passes: every widget the pass can show, dirty or not,
+// as the pass starts from a clear buffer.
+static void draw_pass(u8g2_t *u8g2, void *ctx)
+{
+    const display_widget_tree_t *tree = ctx;
+    int pass_top = u8g2_GetBufferCurrTileRow(u8g2) * 8;
+    int pass_bottom = pass_top + u8g2_GetBufferTileHeight(u8g2) * 8;
+
+    u8g2_SetBitmapMode(u8g2, 1);
+    u8g2_SetFontMode(u8g2, 1);
+    u8g2_SetDrawColor(u8g2, 1);
+    for (int i = 0; i < tree->count; i++) {
+        const display_widget_t *widget = &tree->widgets[i];
+        if (widget->box_y < pass_bottom && widget->box_y + widget->box_h > pass_top) {
+            draw_widget(u8g2, widget);
+        }
+    }
+}
+
+int display_widgets_render_pages(display_widget_tree_t *tree, u8g2_t *u8g2)
+{
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    int drawn = 0;
+
+    if (tree->cleared) {
+        tree->cleared = false;
+        x1 = u8g2_GetDisplayWidth(u8g2);
+        y1 = u8g2_GetDisplayHeight(u8g2);
+    }
+    // Bounding box of the dirty widgets: the only part of the panel that changes.
+    for (int i = 0; i < tree->count; i++) {
+        display_widget_t *widget = &tree->widgets[i];
+        if (!widget->dirty) {
+            continue;
+        }
+        widget->dirty = false;
+        drawn++;
+        if (widget->box_w <= 0 || widget->box_h <= 0) {
+            continue;
+        }
+        if (x1 == x0 || y1 == y0) {
+            x0 = widget->box_x;
+            y0 = widget->box_y;
+            x1 = widget->box_x + widget->box_w;
+            y1 = widget->box_y + widget->box_h;
+            continue;
+        }
+        if (widget->box_x < x0) { x0 = widget->box_x; }
+        if (widget->box_y < y0) { y0 = widget->box_y; }
+        if (widget->box_x + widget->box_w > x1) { x1 = widget->box_x + widget->box_w; }
+        if (widget->box_y + widget->box_h > y1) { y1 = widget->box_y + widget->box_h; }
+    }
+
+    display_send_frame_pages(u8g2, x0, y0, x1 - x0, y1 - y0, draw_pass, tree);
+    return drawn;
+}
+
+#endif // DISPLAY_PAGE_BUFFER
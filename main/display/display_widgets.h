@@ -0,0 +1,97 @@
+#ifndef DISPLAY_WIDGETS_H
+#define DISPLAY_WIDGETS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "u8g2.h"
+#include "display.h"  // DISPLAY_PAGE_BUFFER
+
+/*
+ * Retained widgets (display_widgets.c).
+ *
+ * A screen is a small tree of widgets built once per layout: the status bar, text
+ * labels, list rows and separator lines. Each widget keeps its layout (font, text
+ * origin, centering offset, the box of pixels it owns) and a dirty flag. Setting a
+ * widget's data marks it dirty only when the data differs from what it shows, and
+ * display_widgets_render() redraws only the dirty widgets into the frame buffer:
+ * it clears their boxes and draws them again. Widgets overlapping a cleared box are
+ * redrawn with it, so boxes only need to cover what the widget draws.
+ *
+ * The tree assumes nothing else draws into the buffer between two renders.
+ *
+ * With DISPLAY_PAGE_BUFFER the buffer holds only a band of the screen, so nothing
+ * stays in it between frames: display_widgets_render_pages() draws every widget of
+ * each band the dirty widgets reach and sends those bands, and the dirty flags only
+ * decide which part of the panel is drawn again.
+ */
+
+#define DISPLAY_WIDGETS_MAX 10      // widgets of the busiest layout (task options: 8)
+#define DISPLAY_WIDGET_TEXT_LEN 36  // longest label or row text plus terminator
+
+typedef enum {
+    DISPLAY_WIDGET_STATUS_BAR,      // WiFi and time status, see render_top_info_bar()
+    DISPLAY_WIDGET_LABEL,           // text, optionally centered in a field of max_chars
+    DISPLAY_WIDGET_ROW,             // list row, drawn inverted when selected
+    DISPLAY_WIDGET_SEPARATOR,       // horizontal line
+} display_widget_kind_t;
+
+typedef struct {
+    uint8_t kind;                   // display_widget_kind_t
+    bool dirty;
+    bool center;                    // LABEL
+    bool selected;                  // ROW
+    uint8_t max_chars;              // LABEL: text is cut to this length, 0 for no limit
+    uint8_t wifi_status;            // STATUS_BAR: values on screen
+    uint8_t time_status;
+    const uint8_t *font;            // LABEL, ROW
+    int16_t x, y;                   // text origin (baseline), or line start
+    int16_t draw_x;                 // LABEL: x after centering
+    int16_t x2;                     // SEPARATOR: line end
+    int16_t box_x, box_y, box_w, box_h;  // pixels the widget owns, cleared before a redraw
+    char text[DISPLAY_WIDGET_TEXT_LEN];
+} display_widget_t;
+
+typedef struct {
+    int layout;                     // layout id the widgets were built for, -1 for none
+    bool cleared;                   // clear the whole buffer at the next render
+    uint8_t count;
+    display_widget_t widgets[DISPLAY_WIDGETS_MAX];
+} display_widget_tree_t;
+
+#define DISPLAY_WIDGET_TREE_INIT { .layout = -1 }
+
+// Returns true if the tree has to be built for layout: it held another layout (or
+// was invalidated) and is now empty, and the next render starts from a clear buffer.
+// Returns false if the widgets of layout are in place; only their data is set then.
+bool display_widgets_begin(display_widget_tree_t *tree, int layout);
+// Forgets the layout, so the next frame is built and drawn from scratch.
+void display_widgets_invalidate(display_widget_tree_t *tree);
+
+// Builders, called after display_widgets_begin() returned true. Return the widget
+// index, or -1 if the tree is full. A label's box is derived from its font, a row's
+// is its highlight bar.
+int display_widgets_add_status_bar(display_widget_tree_t *tree);
+int display_widgets_add_label(display_widget_tree_t *tree, u8g2_t *u8g2, const uint8_t *font, int x, int y,
+                              uint8_t max_chars);
+int display_widgets_add_row(display_widget_tree_t *tree, u8g2_t *u8g2, const uint8_t *font, int y);
+int display_widgets_add_separator(display_widget_tree_t *tree, int x1, int y, int x2);
+// Narrows the box of a widget whose text never reaches the font's full extent.
+void display_widgets_set_box(display_widget_tree_t *tree, int id, int x, int y, int w, int h);
+
+// Data setters; each marks the widget dirty only if something changed.
+void display_widgets_set_status(display_widget_tree_t *tree, int id, uint8_t wifi_status, uint8_t time_status);
+void display_widgets_set_label(display_widget_tree_t *tree, u8g2_t *u8g2, int id, const uint8_t *font,
+                               const char *text, bool center);
+void display_widgets_set_row(display_widget_tree_t *tree, int id, const char *text, bool selected);
+
+// Draws the dirty widgets into the buffer (it does not send it) and returns how many
+// were drawn.
+int display_widgets_render(display_widget_tree_t *tree, u8g2_t *u8g2);
+#if DISPLAY_PAGE_BUFFER
+// Page buffer counterpart of display_widgets_render() plus display_send_frame():
+// draws and sends the tile rows and columns covering the dirty widgets, and returns
+// how many widgets were dirty.
+int display_widgets_render_pages(display_widget_tree_t *tree, u8g2_t *u8g2);
+#endif
+
+#endif // DISPLAY_WIDGETS_H
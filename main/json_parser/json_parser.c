@@ -1,4 +1,5 @@
 #include "json_parser.h"
+#include <stdlib.h>
 
 /**
  * @brief Fill a type1_reminder_t from a given task_t (Type=1).
@@ -30,4 +31,90 @@ void fill_type1_reminder_from_task(const task_t *task,
     reminder->Task_Additional_Option_Selected = additional_option;
     reminder->Time_Created = time(NULL);               // Current timestamp
     reminder->Time_Snoozed = 0;                        // Defaults to 0
-}
\ No newline at end of file
+}
+/**
+ * @brief Marks the IDs of all records named "<prefix><ID>" of one type in a namespace.
+ */
+static void collect_record_ids(const char *namespace_name, nvs_type_t type, const char *prefix, uint32_t ids[8])
+{
+    size_t prefix_len = strlen(prefix);
+    nvs_iterator_t it;
+    esp_err_t err = nvs_entry_find(NVS_PARTITION, namespace_name, type, &it);
+    while (err == ESP_OK) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+        if (strncmp(info.key, prefix, prefix_len) == 0 &&
+            info.key[prefix_len] >= '0' && info.key[prefix_len] <= '9') {
+            int id = atoi(&info.key[prefix_len]);
+            if (id <= UINT8_MAX) {
+                ids[id / 32] |= 1u << (id % 32);
+            }
+        }
+        err = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+}
+
+/**
+ * @brief Export the whole configuration (timetables and tasks) as one JSON document.
+ *
+ * Records are loaded one at a time into stack structs and serialized through a
+ * CONFIG_EXPORT_CHUNK_SIZE scratch buffer, so memory use does not grow with the
+ * number of records and no large heap block is ever needed.
+ *
+ * @param sink Receives the document in chunks; returning false aborts the export.
+ * @param ctx Passed through to sink.
+ * @return ESP_OK, or ESP_FAIL if the sink aborted.
+ */
+esp_err_t export_config_json(json_sink_fn sink, void *ctx)
+{
+    const char *TAG = "CONFIG_EXPORT";
+    if (!sink) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t timetable_ids[8] = {0};
+    uint32_t task_ids[8] = {0};
+    storage_lock();
+    collect_record_ids("Jtimetable", NVS_TYPE_STR, "TT", timetable_ids);
+    collect_record_ids(TASK_NAMESPACE, NVS_TYPE_BLOB, "T", task_ids);
+    collect_record_ids(TASK_LEGACY_NAMESPACE, NVS_TYPE_STR, "T", task_ids);  // migrated by load_task
+    storage_unlock();
+
+    char scratch[CONFIG_EXPORT_CHUNK_SIZE];
+    json_writer_t w;
+    json_writer_init_sink(&w, scratch, sizeof(scratch), sink, ctx);
+    unsigned timetable_count = 0, task_count = 0;
+
+    json_write_object_begin(&w);
+    json_write_key(&w, "Timetables");
+    json_write_array_begin(&w);
+    for (int id = 0; id <= UINT8_MAX && !w.error; id++) {
+        timetable_t timetable;
+        if ((timetable_ids[id / 32] & (1u << (id % 32))) && load_timetable(id, &timetable) == ESP_OK) {
+            timetable_write_json(&w, &timetable);
+            timetable_count++;
+        }
+    }
+    json_write_array_end(&w);
+
+    json_write_key(&w, "Tasks");
+    json_write_array_begin(&w);
+    for (int id = 0; id <= UINT8_MAX && !w.error; id++) {
+        task_t task;
+        if ((task_ids[id / 32] & (1u << (id % 32))) && load_task(id, &task) == ESP_OK) {
+            task_write_json(&w, &task);
+            task_count++;
+        }
+    }
+    json_write_array_end(&w);
+    json_write_object_end(&w);
+
+    size_t len = json_writer_finish(&w);
+    if (w.error) {
+        ESP_LOGE(TAG, "Configuration export aborted by sink");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "Exported %u timetables and %u tasks (%u bytes)", timetable_count, task_count, (unsigned)len);
+    return ESP_OK;
+}
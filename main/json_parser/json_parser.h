@@ -2,7 +2,6 @@
 #define JSON_PARSE_H
 
 
-#include "cJSON.h"
 #include <time.h>
 #include "esp_log.h"
 #include "esp_err.h"
@@ -11,6 +10,9 @@
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "nvs_config.h" // NVS partition name
+#include "storage.h"
+#include "json_stream.h"
+#include "json_writer.h"
 
 struct type1_reminder;
 typedef struct type1_reminder type1_reminder_t;
@@ -19,6 +21,8 @@ typedef struct type1_reminder type1_reminder_t;
 #include "reminder.h"
 #include "timetable.h"
 #include "task.h"
+#include "rfid_map.h"
+#include "object_cache.h"
 
 
 
@@ -32,5 +36,12 @@ void fill_type1_reminder_from_task(const task_t *task,
                                    uint8_t selected_option,
                                    uint8_t additional_option);
 
+#define CONFIG_EXPORT_CHUNK_SIZE 128  // scratch buffer handed to the sink per chunk
+
+// Streams all timetables and tasks as one JSON document
+// {"Timetables":[...],"Tasks":[...]} to sink, in chunks of at most
+// CONFIG_EXPORT_CHUNK_SIZE bytes. Uses no heap for the document itself.
+esp_err_t export_config_json(json_sink_fn sink, void *ctx);
+
 
 #endif
\ No newline at end of file
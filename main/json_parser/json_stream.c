@@ -0,0 +1,326 @@
+#include "json_stream.h"
+#include <ctype.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JSON_STREAM_NUMBER_MAX 64  // same scratch size cJSON uses for number text
+
+static bool fail(json_stream_t *js)
+{
+    js->error = true;
+    return false;
+}
+
+static void skip_whitespace(json_stream_t *js)
+{
+    while (*js->pos != '\0' && (unsigned char)*js->pos <= 32) {
+        js->pos++;
+    }
+}
+
+void json_stream_init(json_stream_t *js, const char *text)
+{
+    js->pos = text ? text : "";
+    js->need_comma = false;
+    js->error = (text == NULL);
+    // cJSON skips a leading UTF-8 byte order mark
+    if (strncmp(js->pos, "\xEF\xBB\xBF", 3) == 0) {
+        js->pos += 3;
+    }
+}
+
+json_stream_type_t json_stream_peek(json_stream_t *js)
+{
+    if (js->error) {
+        return JSON_STREAM_INVALID;
+    }
+    skip_whitespace(js);
+    char c = *js->pos;
+    if (c == '{') {
+        return JSON_STREAM_OBJECT;
+    }
+    if (c == '[') {
+        return JSON_STREAM_ARRAY;
+    }
+    if (c == '"') {
+        return JSON_STREAM_STRING;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        return JSON_STREAM_NUMBER;
+    }
+    if (strncmp(js->pos, "null", 4) == 0 || strncmp(js->pos, "true", 4) == 0 ||
+        strncmp(js->pos, "false", 5) == 0) {
+        return JSON_STREAM_LITERAL;
+    }
+    return JSON_STREAM_INVALID;
+}
+
+static bool container_begin(json_stream_t *js, json_stream_type_t type)
+{
+    if (json_stream_peek(js) != type) {
+        return fail(js);
+    }
+    js->pos++;
+    js->need_comma = false;
+    return true;
+}
+
+bool json_stream_object_begin(json_stream_t *js)
+{
+    return container_begin(js, JSON_STREAM_OBJECT);
+}
+
+bool json_stream_array_begin(json_stream_t *js)
+{
+    return container_begin(js, JSON_STREAM_ARRAY);
+}
+
+/**
+ * @brief Positions the stream on the next item of a container.
+ *
+ * @return true if an item follows, false if the container closed or on error.
+ */
+static bool container_next(json_stream_t *js, char close)
+{
+    if (js->error) {
+        return false;
+    }
+    skip_whitespace(js);
+    if (*js->pos == close) {
+        js->pos++;
+        js->need_comma = true;  // the container itself is a completed value
+        return false;
+    }
+    if (js->need_comma) {
+        if (*js->pos != ',') {
+            return fail(js);
+        }
+        js->pos++;
+        skip_whitespace(js);
+    }
+    js->need_comma = false;
+    return true;
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = (char)tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static bool read_utf16_unit(const char *p, uint32_t *unit)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hex_value(p[i]);
+        if (digit < 0) {
+            return false;
+        }
+        value = (value << 4) | (uint32_t)digit;
+    }
+    *unit = value;
+    return true;
+}
+
+/**
+ * @brief Reads a string token, unescaping into out (truncated) and counting the full length.
+ */
+static bool read_string_token(json_stream_t *js, char *out, size_t out_size, size_t *full_len)
+{
+    skip_whitespace(js);
+    if (js->error || *js->pos != '"') {
+        return fail(js);
+    }
+    const char *p = js->pos + 1;
+    size_t len = 0;
+
+#define EMIT(byte) do { if (len + 1 < out_size) out[len] = (char)(byte); len++; } while (0)
+
+    while (*p != '"') {
+        if (*p == '\0') {
+            return fail(js);
+        }
+        if (*p != '\\') {
+            EMIT(*p);
+            p++;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case 'b': EMIT('\b'); break;
+            case 'f': EMIT('\f'); break;
+            case 'n': EMIT('\n'); break;
+            case 'r': EMIT('\r'); break;
+            case 't': EMIT('\t'); break;
+            case '"':
+            case '\\':
+            case '/': EMIT(*p); break;
+            case 'u': {
+                uint32_t code;
+                if (!read_utf16_unit(p + 1, &code) || (code >= 0xDC00 && code <= 0xDFFF)) {
+                    return fail(js);
+                }
+                p += 4;
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    uint32_t low;
+                    if (p[1] != '\\' || p[2] != 'u' || !read_utf16_unit(p + 3, &low) ||
+                        low < 0xDC00 || low > 0xDFFF) {
+                        return fail(js);
+                    }
+                    p += 6;
+                    code = 0x10000 + (((code & 0x3FF) << 10) | (low & 0x3FF));
+                }
+                if (code < 0x80) {
+                    EMIT(code);
+                } else if (code < 0x800) {
+                    EMIT(0xC0 | (code >> 6));
+                    EMIT(0x80 | (code & 0x3F));
+                } else if (code < 0x10000) {
+                    EMIT(0xE0 | (code >> 12));
+                    EMIT(0x80 | ((code >> 6) & 0x3F));
+                    EMIT(0x80 | (code & 0x3F));
+                } else {
+                    EMIT(0xF0 | (code >> 18));
+                    EMIT(0x80 | ((code >> 12) & 0x3F));
+                    EMIT(0x80 | ((code >> 6) & 0x3F));
+                    EMIT(0x80 | (code & 0x3F));
+                }
+                break;
+            }
+            default:
+                return fail(js);
+        }
+        p++;
+    }
+#undef EMIT
+
+    if (out_size > 0) {
+        out[len < out_size ? len : out_size - 1] = '\0';
+    }
+    if (full_len) {
+        *full_len = len;
+    }
+    js->pos = p + 1;
+    js->need_comma = true;
+    return true;
+}
+
+bool json_stream_next_key(json_stream_t *js, char *key, size_t key_size)
+{
+    if (!container_next(js, '}')) {
+        return false;
+    }
+    size_t full_len;
+    if (!read_string_token(js, key, key_size, &full_len)) {
+        return false;
+    }
+    if (full_len >= key_size && key_size > 0) {
+        key[0] = '\0';  // truncated key must not match a shorter name
+    }
+    skip_whitespace(js);
+    if (*js->pos != ':') {
+        return fail(js);
+    }
+    js->pos++;
+    js->need_comma = false;
+    return true;
+}
+
+bool json_stream_next_element(json_stream_t *js)
+{
+    return container_next(js, ']');
+}
+
+bool json_stream_read_string(json_stream_t *js, char *out, size_t out_size)
+{
+    return read_string_token(js, out, out_size, NULL);
+}
+
+bool json_stream_read_int(json_stream_t *js, int *out)
+{
+    if (json_stream_peek(js) != JSON_STREAM_NUMBER) {
+        return fail(js);
+    }
+    // Same approach as cJSON: copy the number characters, then let strtod decide.
+    char number[JSON_STREAM_NUMBER_MAX];
+    size_t n = 0;
+    while (n < sizeof(number) - 1 && js->pos[n] != '\0' && strchr("0123456789+-eE.", js->pos[n])) {
+        number[n] = js->pos[n];
+        n++;
+    }
+    number[n] = '\0';
+    char *after = NULL;
+    double value = strtod(number, &after);
+    if (after == number) {
+        return fail(js);
+    }
+    js->pos += after - number;
+    js->need_comma = true;
+
+    if (value >= INT_MAX) {
+        *out = INT_MAX;
+    } else if (value <= (double)INT_MIN) {
+        *out = INT_MIN;
+    } else {
+        *out = (int)value;
+    }
+    return true;
+}
+
+static bool skip_value(json_stream_t *js, int depth)
+{
+    if (depth > JSON_STREAM_MAX_DEPTH) {
+        return fail(js);
+    }
+    char key;
+    int number;
+    switch (json_stream_peek(js)) {
+        case JSON_STREAM_OBJECT:
+            json_stream_object_begin(js);
+            while (json_stream_next_key(js, &key, 1)) {
+                if (!skip_value(js, depth + 1)) {
+                    return false;
+                }
+            }
+            return !js->error;
+        case JSON_STREAM_ARRAY:
+            json_stream_array_begin(js);
+            while (json_stream_next_element(js)) {
+                if (!skip_value(js, depth + 1)) {
+                    return false;
+                }
+            }
+            return !js->error;
+        case JSON_STREAM_STRING:
+            return read_string_token(js, &key, 1, NULL);
+        case JSON_STREAM_NUMBER:
+            return json_stream_read_int(js, &number);
+        case JSON_STREAM_LITERAL:
+            js->pos += (*js->pos == 'f') ? 5 : 4;
+            js->need_comma = true;
+            return true;
+        default:
+            return fail(js);
+    }
+}
+
+bool json_stream_skip(json_stream_t *js)
+{
+    return skip_value(js, 0);
+}
+
+bool json_stream_key_equals(const char *key, const char *name)
+{
+    while (*key != '\0' && tolower((unsigned char)*key) == tolower((unsigned char)*name)) {
+        key++;
+        name++;
+    }
+    return tolower((unsigned char)*key) == tolower((unsigned char)*name);
+}
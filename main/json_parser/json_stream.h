@@ -0,0 +1,74 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define JSON_STREAM_MAX_DEPTH 32   // nesting limit when skipping unknown values
+#define JSON_STREAM_KEY_MAX   24   // key buffer size used by the decoders (incl. terminator)
+
+typedef enum {
+    JSON_STREAM_INVALID = 0,
+    JSON_STREAM_OBJECT,
+    JSON_STREAM_ARRAY,
+    JSON_STREAM_STRING,
+    JSON_STREAM_NUMBER,
+    JSON_STREAM_LITERAL,    // true, false or null
+} json_stream_type_t;
+
+/*
+ * Pull-style JSON reader working directly on a null-terminated input buffer.
+ * It never allocates: strings are unescaped straight into caller buffers and
+ * numbers are converted on the stack. Any syntax error sets `error`, after
+ * which every call fails.
+ *
+ * Values follow cJSON semantics so decoders built on it accept the same documents
+ * as the cJSON-based ones: whitespace is any byte <= 32, numbers are converted to
+ * int the way cJSON fills valueint, and trailing bytes after the root are ignored.
+ *
+ * Typical use:
+ *   json_stream_object_begin(&js);
+ *   while (json_stream_next_key(&js, key, sizeof(key))) {
+ *       if (json_stream_key_equals(key, "ID")) json_stream_read_int(&js, &id);
+ *       else json_stream_skip(&js);
+ *   }
+ *   if (js.error) ...
+ */
+typedef struct {
+    const char *pos;
+    bool need_comma;  // a value was just completed inside the current container
+    bool error;
+} json_stream_t;
+
+void json_stream_init(json_stream_t *js, const char *text);
+
+// Type of the next value, without consuming it.
+json_stream_type_t json_stream_peek(json_stream_t *js);
+
+// Consume '{' / '['.
+bool json_stream_object_begin(json_stream_t *js);
+bool json_stream_array_begin(json_stream_t *js);
+
+// Advance to the next member of the current object and read its key (and the ':').
+// Keys that do not fit in key_size are returned as "" so they never match.
+// Returns false when the object ends ('}' consumed) or on error.
+bool json_stream_next_key(json_stream_t *js, char *key, size_t key_size);
+
+// Advance to the next element of the current array.
+// Returns false when the array ends (']' consumed) or on error.
+bool json_stream_next_element(json_stream_t *js);
+
+// Read a string value into out, truncated to out_size - 1 bytes (like strncpy + terminator).
+bool json_stream_read_string(json_stream_t *js, char *out, size_t out_size);
+
+// Read a number value and convert it to int, saturating like cJSON's valueint.
+bool json_stream_read_int(json_stream_t *js, int *out);
+
+// Skip the next value of any type, including nested objects and arrays.
+bool json_stream_skip(json_stream_t *js);
+
+// Case-insensitive key comparison, matching cJSON_GetObjectItem.
+bool json_stream_key_equals(const char *key, const char *name);
+
+#endif // JSON_STREAM_H
@@ -0,0 +1,168 @@
+#include "json_writer.h"
+#include <stdio.h>
+#include <string.h>
+
+void json_writer_init_buffer(json_writer_t *w, char *buf, size_t size)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->size = buf ? size : 0;
+}
+
+void json_writer_init_sink(json_writer_t *w, char *scratch, size_t scratch_size, json_sink_fn sink, void *ctx)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = scratch;
+    w->size = scratch_size;
+    w->sink = sink;
+    w->sink_ctx = ctx;
+    w->error = (scratch == NULL || scratch_size == 0 || sink == NULL);
+}
+
+static void flush(json_writer_t *w)
+{
+    if (w->pending > 0 && !w->error) {
+        if (!w->sink(w->sink_ctx, w->buf, w->pending)) {
+            w->error = true;
+        }
+    }
+    w->pending = 0;
+}
+
+static void put(json_writer_t *w, const char *data, size_t len)
+{
+    if (w->error) {
+        return;
+    }
+    if (w->sink) {
+        w->len += len;
+        while (len > 0 && !w->error) {
+            size_t chunk = w->size - w->pending;
+            if (chunk > len) {
+                chunk = len;
+            }
+            memcpy(w->buf + w->pending, data, chunk);
+            w->pending += chunk;
+            data += chunk;
+            len -= chunk;
+            if (w->pending == w->size) {
+                flush(w);
+            }
+        }
+        return;
+    }
+    // Buffer mode: keep one byte for the terminator, count everything.
+    if (w->len + 1 < w->size) {
+        size_t room = w->size - 1 - w->len;
+        memcpy(w->buf + w->len, data, len < room ? len : room);
+    }
+    w->len += len;
+}
+
+static void put_char(json_writer_t *w, char c)
+{
+    put(w, &c, 1);
+}
+
+size_t json_writer_finish(json_writer_t *w)
+{
+    if (w->sink) {
+        flush(w);
+    } else if (w->size > 0) {
+        w->buf[w->len < w->size ? w->len : w->size - 1] = '\0';
+    }
+    return w->len;
+}
+
+static void value_separator(json_writer_t *w)
+{
+    if (w->need_comma) {
+        put_char(w, ',');
+    }
+}
+
+void json_write_object_begin(json_writer_t *w)
+{
+    value_separator(w);
+    put_char(w, '{');
+    w->need_comma = false;
+}
+
+void json_write_object_end(json_writer_t *w)
+{
+    put_char(w, '}');
+    w->need_comma = true;
+}
+
+void json_write_array_begin(json_writer_t *w)
+{
+    value_separator(w);
+    put_char(w, '[');
+    w->need_comma = false;
+}
+
+void json_write_array_end(json_writer_t *w)
+{
+    put_char(w, ']');
+    w->need_comma = true;
+}
+
+/**
+ * @brief Writes a quoted string, escaped the way cJSON prints strings.
+ */
+static void put_string(json_writer_t *w, const char *s)
+{
+    put_char(w, '"');
+    const char *run = s;
+    for (; *s != '\0'; s++) {
+        unsigned char c = (unsigned char)*s;
+        const char *escape = NULL;
+        char unicode[7];
+        switch (c) {
+            case '"':  escape = "\\\""; break;
+            case '\\': escape = "\\\\"; break;
+            case '\b': escape = "\\b"; break;
+            case '\f': escape = "\\f"; break;
+            case '\n': escape = "\\n"; break;
+            case '\r': escape = "\\r"; break;
+            case '\t': escape = "\\t"; break;
+            default:
+                if (c < 32) {
+                    snprintf(unicode, sizeof(unicode), "\\u%04x", c);
+                    escape = unicode;
+                }
+                break;
+        }
+        if (escape) {
+            put(w, run, (size_t)(s - run));
+            put(w, escape, strlen(escape));
+            run = s + 1;
+        }
+    }
+    put(w, run, (size_t)(s - run));
+    put_char(w, '"');
+}
+
+void json_write_key(json_writer_t *w, const char *key)
+{
+    value_separator(w);
+    put_string(w, key);
+    put_char(w, ':');
+    w->need_comma = false;
+}
+
+void json_write_string(json_writer_t *w, const char *value)
+{
+    value_separator(w);
+    put_string(w, value ? value : "");
+    w->need_comma = true;
+}
+
+void json_write_int(json_writer_t *w, int value)
+{
+    value_separator(w);
+    char number[12];
+    int len = snprintf(number, sizeof(number), "%d", value);
+    put(w, number, (size_t)len);
+    w->need_comma = true;
+}
@@ -0,0 +1,52 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Receives serialized output in chunks. Return false to abort the export.
+typedef bool (*json_sink_fn)(void *ctx, const char *data, size_t len);
+
+/*
+ * Allocation-free JSON writer, the output-side counterpart of json_stream.
+ *
+ * Buffer mode writes into a caller buffer with snprintf semantics: output is
+ * truncated to size - 1 bytes plus terminator, and json_writer_finish() returns the
+ * full length. A NULL buffer gives the exact size without writing anything.
+ *
+ * Sink mode collects output in a small caller-provided scratch buffer and hands it
+ * to the sink whenever it fills up, so documents of any size are produced in
+ * constant memory.
+ *
+ * The output is byte-for-byte what cJSON_PrintUnformatted produces for the same
+ * document (same string escaping, integers printed with %d).
+ */
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;           // bytes emitted so far (buffer mode: may exceed size)
+    size_t pending;       // sink mode: bytes waiting in buf
+    json_sink_fn sink;
+    void *sink_ctx;
+    bool need_comma;
+    bool error;
+} json_writer_t;
+
+void json_writer_init_buffer(json_writer_t *w, char *buf, size_t size);
+void json_writer_init_sink(json_writer_t *w, char *scratch, size_t scratch_size, json_sink_fn sink, void *ctx);
+
+// Terminates the buffer / flushes the sink. Returns the total length in bytes,
+// excluding the terminator.
+size_t json_writer_finish(json_writer_t *w);
+
+void json_write_object_begin(json_writer_t *w);
+void json_write_object_end(json_writer_t *w);
+void json_write_array_begin(json_writer_t *w);
+void json_write_array_end(json_writer_t *w);
+// Member key of the current object; the value call follows.
+void json_write_key(json_writer_t *w, const char *key);
+void json_write_string(json_writer_t *w, const char *value);
+void json_write_int(json_writer_t *w, int value);
+
+#endif // JSON_WRITER_H
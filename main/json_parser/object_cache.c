@@ -0,0 +1,258 @@
+#include "object_cache.h"
+#include "json_parser.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "OBJ_CACHE";
+
+typedef struct {
+    bool valid;
+    uint8_t id;
+    uint32_t last_used;  // value of use_clock at the last hit, 0 = never
+    task_t task;
+} task_slot_t;
+
+typedef struct {
+    bool valid;
+    uint8_t id;
+    uint32_t last_used;
+    timetable_t timetable;
+    timetable_schedule_t schedule;  // compiled when the slot is filled
+} timetable_slot_t;
+
+static task_slot_t task_slots[CACHE_TASK_SLOTS];
+static timetable_slot_t timetable_slots[CACHE_TIMETABLE_SLOTS];
+static uint32_t use_clock = 0;
+// Bumped by every invalidation so a load that raced with a store is not cached.
+static uint32_t generation = 0;
+static cache_stats_t stats;
+static portMUX_TYPE cache_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Picks the slot for a new entry: a free slot, otherwise the least recently used one.
+ *
+ * Must be called with cache_lock held.
+ */
+static int pick_task_slot(void)
+{
+    int victim = 0;
+    for (int i = 0; i < CACHE_TASK_SLOTS; i++) {
+        if (!task_slots[i].valid) {
+            return i;
+        }
+        if (task_slots[i].last_used < task_slots[victim].last_used) {
+            victim = i;
+        }
+    }
+    stats.evictions++;
+    return victim;
+}
+
+static int pick_timetable_slot(void)
+{
+    int victim = 0;
+    for (int i = 0; i < CACHE_TIMETABLE_SLOTS; i++) {
+        if (!timetable_slots[i].valid) {
+            return i;
+        }
+        if (timetable_slots[i].last_used < timetable_slots[victim].last_used) {
+            victim = i;
+        }
+    }
+    stats.evictions++;
+    return victim;
+}
+
+/**
+ * @brief Get a task from the cache, loading it from NVS on a miss.
+ *
+ * @param id   Task ID.
+ * @param task Output, filled on success.
+ * @return ESP_OK on success, otherwise the error returned by load_task().
+ */
+esp_err_t cache_get_task(int id, task_t *task)
+{
+    if (!task || id < 0 || id > UINT8_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&cache_lock);
+    for (int i = 0; i < CACHE_TASK_SLOTS; i++) {
+        if (task_slots[i].valid && task_slots[i].id == id) {
+            task_slots[i].last_used = ++use_clock;
+            *task = task_slots[i].task;
+            stats.task_hits++;
+            taskEXIT_CRITICAL(&cache_lock);
+            return ESP_OK;
+        }
+    }
+    stats.task_misses++;
+    uint32_t load_generation = generation;
+    taskEXIT_CRITICAL(&cache_lock);
+
+    esp_err_t err = load_task(id, task);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    taskENTER_CRITICAL(&cache_lock);
+    if (load_generation == generation) {
+        int slot = pick_task_slot();
+        task_slots[slot].valid = true;
+        task_slots[slot].id = (uint8_t)id;
+        task_slots[slot].last_used = ++use_clock;
+        task_slots[slot].task = *task;
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief Looks up timetable <id>, loading and compiling it on a miss.
+ *
+ * Either output may be NULL.
+ */
+static esp_err_t get_timetable_entry(int id, timetable_t *timetable, timetable_schedule_t *schedule)
+{
+    if (id < 0 || id > UINT8_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    taskENTER_CRITICAL(&cache_lock);
+    for (int i = 0; i < CACHE_TIMETABLE_SLOTS; i++) {
+        if (timetable_slots[i].valid && timetable_slots[i].id == id) {
+            timetable_slots[i].last_used = ++use_clock;
+            if (timetable) {
+                *timetable = timetable_slots[i].timetable;
+            }
+            if (schedule) {
+                *schedule = timetable_slots[i].schedule;
+            }
+            stats.timetable_hits++;
+            taskEXIT_CRITICAL(&cache_lock);
+            return ESP_OK;
+        }
+    }
+    stats.timetable_misses++;
+    uint32_t load_generation = generation;
+    taskEXIT_CRITICAL(&cache_lock);
+
+    timetable_t loaded;
+    esp_err_t err = load_timetable(id, &loaded);
+    if (err != ESP_OK) {
+        return err;
+    }
+    // Compiled outside the critical section; the slot copy below is cheap.
+    timetable_schedule_t compiled;
+    timetable_compile_schedule(&loaded, &compiled);
+    if (timetable) {
+        *timetable = loaded;
+    }
+    if (schedule) {
+        *schedule = compiled;
+    }
+
+    taskENTER_CRITICAL(&cache_lock);
+    if (load_generation == generation) {
+        int slot = pick_timetable_slot();
+        timetable_slots[slot].valid = true;
+        timetable_slots[slot].id = (uint8_t)id;
+        timetable_slots[slot].last_used = ++use_clock;
+        timetable_slots[slot].timetable = loaded;
+        timetable_slots[slot].schedule = compiled;
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+    return ESP_OK;
+}
+
+/**
+ * @brief Get a timetable from the cache, loading it from NVS on a miss.
+ *
+ * @param id        Timetable ID.
+ * @param timetable Output, filled on success.
+ * @return ESP_OK on success, otherwise the error returned by load_timetable().
+ */
+esp_err_t cache_get_timetable(int id, timetable_t *timetable)
+{
+    if (!timetable) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return get_timetable_entry(id, timetable, NULL);
+}
+
+/**
+ * @brief Get the compiled weekly schedule of a timetable.
+ *
+ * The schedule is built once when the timetable enters the cache and dropped with it
+ * when store_timetable_json() changes the timetable.
+ *
+ * @param id       Timetable ID.
+ * @param schedule Output, filled on success.
+ * @return ESP_OK on success, otherwise the error returned by load_timetable().
+ */
+esp_err_t cache_get_timetable_schedule(int id, timetable_schedule_t *schedule)
+{
+    if (!schedule) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return get_timetable_entry(id, NULL, schedule);
+}
+
+void cache_invalidate_task(int id)
+{
+    taskENTER_CRITICAL(&cache_lock);
+    generation++;
+    for (int i = 0; i < CACHE_TASK_SLOTS; i++) {
+        if (task_slots[i].valid && task_slots[i].id == id) {
+            task_slots[i].valid = false;
+            stats.invalidations++;
+        }
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+}
+
+void cache_invalidate_timetable(int id)
+{
+    taskENTER_CRITICAL(&cache_lock);
+    generation++;
+    for (int i = 0; i < CACHE_TIMETABLE_SLOTS; i++) {
+        if (timetable_slots[i].valid && timetable_slots[i].id == id) {
+            timetable_slots[i].valid = false;
+            stats.invalidations++;
+        }
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+}
+
+void cache_invalidate_all(void)
+{
+    taskENTER_CRITICAL(&cache_lock);
+    generation++;
+    for (int i = 0; i < CACHE_TASK_SLOTS; i++) {
+        task_slots[i].valid = false;
+    }
+    for (int i = 0; i < CACHE_TIMETABLE_SLOTS; i++) {
+        timetable_slots[i].valid = false;
+    }
+    taskEXIT_CRITICAL(&cache_lock);
+}
+
+void cache_get_stats(cache_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    taskENTER_CRITICAL(&cache_lock);
+    *out = stats;
+    taskEXIT_CRITICAL(&cache_lock);
+}
+
+void cache_log_stats(void)
+{
+    cache_stats_t s;
+    cache_get_stats(&s);
+    ESP_LOGI(TAG, "tasks %u hit / %u miss, timetables %u hit / %u miss, %u evicted, %u invalidated",
+             (unsigned)s.task_hits, (unsigned)s.task_misses,
+             (unsigned)s.timetable_hits, (unsigned)s.timetable_misses,
+             (unsigned)s.evictions, (unsigned)s.invalidations);
+}
@@ -0,0 +1,44 @@
+#ifndef OBJECT_CACHE_H
+#define OBJECT_CACHE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "task.h"
+#include "timetable.h"
+
+// Fixed memory budget of the cache. Slots are static arrays, so the cache
+// never allocates: roughly 8 * sizeof(task_t) + 8 * (sizeof(timetable_t) +
+// sizeof(timetable_schedule_t)) (~4.9 KB).
+#define CACHE_TASK_SLOTS      8
+#define CACHE_TIMETABLE_SLOTS 8
+
+typedef struct {
+    uint32_t task_hits;
+    uint32_t task_misses;
+    uint32_t timetable_hits;
+    uint32_t timetable_misses;
+    uint32_t evictions;      // least recently used entries dropped to make room
+    uint32_t invalidations;  // entries dropped because the stored object changed
+} cache_stats_t;
+
+// Copies task <id> into task. On a miss the task is loaded with load_task()
+// and kept in the cache. Returns the load_task() error on failure.
+esp_err_t cache_get_task(int id, task_t *task);
+
+// Copies timetable <id> into timetable. On a miss the timetable is loaded
+// with load_timetable() and kept in the cache.
+esp_err_t cache_get_timetable(int id, timetable_t *timetable);
+
+// Copies the weekly schedule of timetable <id> (see timetable_compile_schedule).
+// The schedule is compiled once per load and kept until the timetable changes.
+esp_err_t cache_get_timetable_schedule(int id, timetable_schedule_t *schedule);
+
+// Drop a cached entry. Called by the store functions after every write.
+void cache_invalidate_task(int id);
+void cache_invalidate_timetable(int id);
+void cache_invalidate_all(void);
+
+void cache_get_stats(cache_stats_t *stats);
+void cache_log_stats(void);
+
+#endif // OBJECT_CACHE_H
@@ -1,144 +1,398 @@
 #include "reminder.h"
 
-#define REMINDER_NAMESPACE "Rmdr"
 static const char *TAG = "REMINDER";
 
+/*
+ * Reminder table layout in namespace "Rmdr":
+ *   "RHDR"  reminder_table_header_t - version, count and a 256-bit allocation bitmap
+ *   "R<ID>" one type1_reminder_t slot per reminder (the key older firmware used)
+ * A slot is only valid while its bit is set in the bitmap. The header and a hash
+ * index on (Task_ID, option, additional option) are kept in RAM after the first use
+ * and are only touched with the storage lock held.
+ *
+ * Every write touches only the record it changes: a store writes its slot and the
+ * header, an update (snooze) only its slot, a delete only the header (and erases the
+ * slot, which marks existing entries and writes none).
+ */
+typedef struct {
+    uint8_t  version;
+    uint8_t  count;
+    uint8_t  reserved[2];
+    uint32_t bitmap[8];   // bit N set = reminder ID N is in use
+} reminder_table_header_t;
+
+// Version 1 kept the slots in pages of REMINDER_V1_PAGE_SLOTS ("RP<n>"), which made
+// every store and snooze rewrite 16 slots.
+#define REMINDER_V1_PAGE_SLOTS 16
+#define REMINDER_V1_PAGES 16
+
+#define REMINDER_TABLE_VERSION 2
+#define REMINDER_HEADER_KEY "RHDR"
+#define REMINDER_HASH_BUCKETS 64
+#define REMINDER_NO_ID 0       // ID 0 is never assigned, used as the chain terminator
+
+static reminder_table_header_t header;
+static bool table_loaded = false;
+// Hash index: bucket heads and per-ID chain links, plus the packed key of every ID.
+static uint8_t hash_heads[REMINDER_HASH_BUCKETS];
+static uint8_t hash_next[256];
+static uint32_t reminder_keys[256];
+
+static inline bool id_in_use(uint8_t id)
+{
+    return (header.bitmap[id / 32] >> (id % 32)) & 1u;
+}
+
+static inline uint32_t reminder_key(uint8_t task_id, uint8_t option, uint8_t additional_option)
+{
+    return ((uint32_t)task_id << 16) | ((uint32_t)option << 8) | additional_option;
+}
+
+static inline uint32_t key_bucket(uint32_t key)
+{
+    // Fibonacci hashing of the packed key, top bits select the bucket (64 = 2^6).
+    return (key * 2654435761u) >> 26;
+}
+
+static void index_insert(uint8_t id, uint32_t key)
+{
+    uint32_t b = key_bucket(key);
+    reminder_keys[id] = key;
+    hash_next[id] = hash_heads[b];
+    hash_heads[b] = id;
+}
+
+static void index_remove(uint8_t id)
+{
+    uint32_t b = key_bucket(reminder_keys[id]);
+    uint8_t *link = &hash_heads[b];
+    while (*link != REMINDER_NO_ID) {
+        if (*link == id) {
+            *link = hash_next[id];
+            hash_next[id] = REMINDER_NO_ID;
+            return;
+        }
+        link = &hash_next[*link];
+    }
+}
+
+static bool index_contains(uint32_t key)
+{
+    for (uint8_t id = hash_heads[key_bucket(key)]; id != REMINDER_NO_ID; id = hash_next[id]) {
+        if (reminder_keys[id] == key) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void slot_key(uint8_t id, char *key, size_t size)
+{
+    snprintf(key, size, "R%u", id);
+}
+
+static esp_err_t read_slot(nvs_handle_t handle, uint8_t id, type1_reminder_t *out)
+{
+    char key[8];
+    slot_key(id, key, sizeof(key));
+    size_t size = sizeof(*out);
+    esp_err_t err = nvs_get_blob(handle, key, out, &size);
+    if (err == ESP_OK && size != sizeof(*out)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return err;
+}
+
+static esp_err_t write_slot(nvs_handle_t handle, const type1_reminder_t *in)
+{
+    char key[8];
+    slot_key(in->Reminder_ID, key, sizeof(key));
+    return nvs_set_blob(handle, key, in, sizeof(*in));
+}
+
 /**
- * @brief Finds and returns the next unused ID in [1..254].
- *        Returns 0 if none found.
+ * @brief Adopts reminders stored by older firmware without a table header (one
+ *        "R<ID>" blob each, the slot format of this table). Reminder IDs are preserved.
  */
-static uint8_t find_next_available_id(void)
+static esp_err_t migrate_legacy_reminders(nvs_handle_t handle)
+{
+    nvs_iterator_t it;
+    esp_err_t it_err = nvs_entry_find(NVS_PARTITION, REMINDER_NAMESPACE, NVS_TYPE_BLOB, &it);
+    while (it_err == ESP_OK) {
+        nvs_entry_info_t info;
+        nvs_entry_info(it, &info);
+        if (info.key[0] == 'R' && info.key[1] >= '0' && info.key[1] <= '9') {
+            int id = atoi(&info.key[1]);
+            if (id > 0 && id <= REMINDER_MAX_ID) {
+                header.bitmap[id / 32] |= 1u << (id % 32);
+                header.count++;
+            }
+        }
+        it_err = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+
+    // Older firmware did not always keep Reminder_ID in the blob; fix the slots that differ.
+    esp_err_t err = ESP_OK;
+    for (int id = 1; id <= REMINDER_MAX_ID && err == ESP_OK; id++) {
+        type1_reminder_t reminder;
+        if (!id_in_use(id) || read_slot(handle, id, &reminder) != ESP_OK || reminder.Reminder_ID == id) {
+            continue;
+        }
+        reminder.Reminder_ID = (uint8_t)id;
+        err = write_slot(handle, &reminder);
+    }
+    if (err == ESP_OK && header.count > 0) {
+        ESP_LOGI(TAG, "Migrated %d legacy reminder(s) into the reminder table", header.count);
+    }
+    return err;
+}
+
+/**
+ * @brief Moves the slots of a version 1 table ("RP<n>" pages) into "R<ID>" slots.
+ *
+ * The header read into RAM keeps its bitmap and count; the pages are erased once
+ * every slot is written, so an interrupted migration is repeated on the next boot.
+ */
+static esp_err_t migrate_v1_pages(nvs_handle_t handle)
+{
+    type1_reminder_t *page = calloc(REMINDER_V1_PAGE_SLOTS, sizeof(type1_reminder_t));
+    if (!page) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t err = ESP_OK;
+    for (int p = 0; p < REMINDER_V1_PAGES && err == ESP_OK; p++) {
+        char key[8];
+        snprintf(key, sizeof(key), "RP%d", p);
+        size_t size = REMINDER_V1_PAGE_SLOTS * sizeof(type1_reminder_t);
+        esp_err_t read_err = nvs_get_blob(handle, key, page, &size);
+        if (read_err != ESP_OK || size != REMINDER_V1_PAGE_SLOTS * sizeof(type1_reminder_t)) {
+            continue;
+        }
+        for (int slot = 0; slot < REMINDER_V1_PAGE_SLOTS && err == ESP_OK; slot++) {
+            int id = p * REMINDER_V1_PAGE_SLOTS + slot;
+            if (id_in_use(id)) {
+                page[slot].Reminder_ID = (uint8_t)id;
+                err = write_slot(handle, &page[slot]);
+            }
+        }
+    }
+    free(page);
+    for (int p = 0; p < REMINDER_V1_PAGES && err == ESP_OK; p++) {
+        char key[8];
+        snprintf(key, sizeof(key), "RP%d", p);
+        nvs_erase_key(handle, key);
+    }
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "Moved %d reminder(s) out of the version 1 pages", header.count);
+    }
+    return err;
+}
+
+/**
+ * @brief Loads the table header and builds the hash index (once per boot).
+ *
+ * Must be called with the table lock held.
+ */
+static esp_err_t ensure_table_loaded(void)
 {
+    if (table_loaded) {
+        return ESP_OK;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memset(hash_heads, REMINDER_NO_ID, sizeof(hash_heads));
+    memset(hash_next, REMINDER_NO_ID, sizeof(hash_next));
+    header.version = REMINDER_TABLE_VERSION;
+
     nvs_handle_t handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, REMINDER_NAMESPACE, NVS_READONLY, &handle);
+    esp_err_t err = storage_open(REMINDER_NAMESPACE, NVS_READWRITE, &handle);
     if (err != ESP_OK) {
-        // If namespace doesn't exist yet, ID 1 is available.
-        return 1;
+        ESP_LOGE(TAG, "Failed to open reminder namespace: %s", esp_err_to_name(err));
+        return err;
     }
 
-    // Check each ID until we find a key that doesn't exist
-    for (uint8_t i = 1; i < 255; i++) {
-        char key[8];
-        snprintf(key, sizeof(key), "R%u", i);
-        size_t size = 0;
-        err = nvs_get_blob(handle, key, NULL, &size);
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            nvs_close(handle);
-            return i;
+    size_t size = sizeof(header);
+    err = nvs_get_blob(handle, REMINDER_HEADER_KEY, &header, &size);
+    bool migrated = false;
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        memset(&header, 0, sizeof(header));
+        err = migrate_legacy_reminders(handle);
+        migrated = true;
+    } else if (err == ESP_OK && size == sizeof(header) && header.version == 1) {
+        err = migrate_v1_pages(handle);
+        migrated = true;
+    } else if (err == ESP_OK && (size != sizeof(header) || header.version != REMINDER_TABLE_VERSION)) {
+        ESP_LOGE(TAG, "Reminder table header has unsupported version %d", header.version);
+        err = ESP_ERR_INVALID_VERSION;
+    }
+    if (err == ESP_OK && migrated) {
+        header.version = REMINDER_TABLE_VERSION;
+        err = nvs_set_blob(handle, REMINDER_HEADER_KEY, &header, sizeof(header));
+        if (err == ESP_OK) {
+            err = storage_commit(handle);
+        }
+    }
+    if (err != ESP_OK) {
+        storage_close(handle);
+        return err;
+    }
+
+    // Build the duplicate-check index from the used slots.
+    for (int id = 1; id <= REMINDER_MAX_ID; id++) {
+        if (!id_in_use(id)) {
+            continue;
+        }
+        type1_reminder_t r;
+        err = read_slot(handle, id, &r);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Reminder %d is in the table but its slot cannot be read: %s", id, esp_err_to_name(err));
+            storage_close(handle);
+            return err;
+        }
+        index_insert(id, reminder_key(r.Task_ID, r.Task_Option_Selected, r.Task_Additional_Option_Selected));
+    }
+    storage_close(handle);
+    table_loaded = true;
+    return ESP_OK;
+}
+
+/**
+ * @brief Finds the lowest unused ID in [1..254] using the allocation bitmap.
+ *        Returns 0 if none found. Must be called with the table lock held.
+ */
+static uint8_t find_next_available_id(void)
+{
+    for (int word = 0; word < 8; word++) {
+        uint32_t free_bits = ~header.bitmap[word];
+        if (word == 0) {
+            free_bits &= ~1u;            // ID 0 is reserved
+        } else if (word == 7) {
+            free_bits &= ~(1u << 31);    // ID 255 is reserved
+        }
+        if (free_bits != 0) {
+            return (uint8_t)(word * 32 + __builtin_ctz(free_bits));
         }
     }
-    nvs_close(handle);
     return 0; // No available ID
 }
 
+/**
+ * @brief Writes one reminder slot and/or the header, then commits once.
+ *
+ * Either may be NULL. The header is written after the slot, so an interrupted store
+ * never exposes a half-written slot; a deleted slot (erase_id) is erased after the
+ * header no longer refers to it. Must be called with the table lock held.
+ */
+static esp_err_t write_table(const type1_reminder_t *reminder, const reminder_table_header_t *new_header,
+                             uint8_t erase_id)
+{
+    nvs_handle_t handle;
+    esp_err_t err = storage_open(REMINDER_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (reminder != NULL) {
+        err = write_slot(handle, reminder);
+    }
+    if (err == ESP_OK && new_header != NULL) {
+        err = nvs_set_blob(handle, REMINDER_HEADER_KEY, new_header, sizeof(*new_header));
+    }
+    if (err == ESP_OK && erase_id != REMINDER_NO_ID) {
+        char key[8];
+        slot_key(erase_id, key, sizeof(key));
+        // A slot left behind is harmless: its bit is clear, and the next store of the ID overwrites it.
+        nvs_erase_key(handle, key);
+    }
+    if (err == ESP_OK) {
+        err = storage_commit(handle);
+    }
+    storage_close(handle);
+    return err;
+}
+
 /**
  * @brief Store a new type1 reminder (auto-assigns a free ID).
  *
+ * The duplicate check is a hash index lookup and the ID comes from the
+ * allocation bitmap, so storing costs two blob writes (slot and header)
+ * regardless of how many reminders exist.
+ *
  * @param reminder Pointer to the reminder data (Reminder_ID should be 0).
  * @param create_even_if_exists If 1, store the reminder even if a reminder with the same Taks_ID, Option ID and additional Option ID exists.
- * @return The assigned reminder ID on success; 0 if store failed.
+ * @return The assigned reminder ID on success; -1 if a duplicate exists; 0 if store failed.
  */
 int store_type1_reminder(const type1_reminder_t *reminder_in, uint8_t create_even_if_exists)
 {
     if (!reminder_in) return 0;
 
     type1_reminder_t new_reminder = *reminder_in;
+    uint32_t key = reminder_key(new_reminder.Task_ID, new_reminder.Task_Option_Selected,
+                                new_reminder.Task_Additional_Option_Selected);
+
+    storage_lock();
+    if (ensure_table_loaded() != ESP_OK) {
+        storage_unlock();
+        return 0;
+    }
 
     // Check for duplicates: same Task_ID, Task_Option_Selected and Task_Additional_Option_Selected.
-    if (create_even_if_exists != 1) {
-        size_t total = get_num_of_reminders();
-        if (total > 0) {
-            type1_reminder_t *all_reminders = malloc(total * sizeof(type1_reminder_t));
-            if (all_reminders == NULL) {
-                ESP_LOGE(TAG, "Memory allocation failed for duplicate check");
-                return 0;
-            }
-            size_t filled = get_all_type1_reminders(all_reminders, total);
-            for (size_t i = 0; i < filled; i++) {
-                if (all_reminders[i].Task_ID == new_reminder.Task_ID &&
-                    all_reminders[i].Task_Option_Selected == new_reminder.Task_Option_Selected &&
-                    all_reminders[i].Task_Additional_Option_Selected == new_reminder.Task_Additional_Option_Selected)
-                {
-                    free(all_reminders);
-
-                        ESP_LOGW(TAG, "Duplicate reminder exists for Task_ID %d, Option %d, Additional Option %d",
-                                new_reminder.Task_ID,
-                                new_reminder.Task_Option_Selected,
-                                new_reminder.Task_Additional_Option_Selected);
-                        return -1;
-                }
-            }
-            free(all_reminders);
-        }
+    if (create_even_if_exists != 1 && index_contains(key)) {
+        storage_unlock();
+        ESP_LOGW(TAG, "Duplicate reminder exists for Task_ID %d, Option %d, Additional Option %d",
+                 new_reminder.Task_ID,
+                 new_reminder.Task_Option_Selected,
+                 new_reminder.Task_Additional_Option_Selected);
+        return -1;
     }
 
     uint8_t new_id = find_next_available_id();
     if (new_id == 0) {
+        storage_unlock();
         ESP_LOGE(TAG, "No available IDs for new reminder.");
         return 0;
     }
     new_reminder.Reminder_ID = new_id;
 
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, REMINDER_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS for storing reminder: %s", esp_err_to_name(err));
-        return 0;
-    }
-
-    char key[8];
-    snprintf(key, sizeof(key), "R%u", new_id);
-
-    err = nvs_set_blob(handle, key, &new_reminder, sizeof(new_reminder));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set reminder blob: %s", esp_err_to_name(err));
-        nvs_close(handle);
-        return 0;
-    }
-
-    err = nvs_commit(handle);
-    nvs_close(handle);
+    reminder_table_header_t new_header = header;
+    new_header.bitmap[new_id / 32] |= 1u << (new_id % 32);
+    new_header.count++;
 
+    esp_err_t err = write_table(&new_reminder, &new_header, REMINDER_NO_ID);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit new reminder: %s", esp_err_to_name(err));
+        storage_unlock();
+        ESP_LOGE(TAG, "Failed to store new reminder: %s", esp_err_to_name(err));
         return 0;
     }
+    header = new_header;
+    index_insert(new_id, key);
+    storage_unlock();
+    storage_notify_change(STORAGE_CHANGE_REMINDER, new_id);
     return new_id;
 }
 
 /**
  * @brief Get the number of reminders of any type stored in NVS.
  *
+ * Read from the table header kept in RAM.
+ *
  * @return Number of stored reminders.
  */
 size_t get_num_of_reminders(void)
 {
-    // First, confirm the namespace can be opened (even READONLY).
-    // If it doesn't exist, there's nothing to count.
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, REMINDER_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        return 0;
-    }
-    nvs_close(handle);
-
-    size_t count = 0;
-    nvs_iterator_t it;
-    // Use the new API: nvs_entry_find(part_name, namespace, type, &it)
-    esp_err_t it_err = nvs_entry_find(NVS_PARTITION, REMINDER_NAMESPACE, NVS_TYPE_BLOB, &it);
-    while (it_err == ESP_OK) {
-        count++;
-        it_err = nvs_entry_next(&it);
-    }
-    // Release the iterator once we're done
-    nvs_release_iterator(it);
-
+    storage_lock();
+    size_t count = (ensure_table_loaded() == ESP_OK) ? header.count : 0;
+    storage_unlock();
     return count;
 }
 
 /**
  * @brief Retrieve all type1 reminders into the given array.
  *
+ * One slot read per stored reminder, found through the bitmap.
+ * Reminders are returned in ascending ID order.
+ *
  * @param reminders Pointer to an array of type1_reminder_t.
  * @param max_count Capacity of the provided array.
  * @return Count of reminders placed in the array.
@@ -147,32 +401,28 @@ size_t get_all_type1_reminders(type1_reminder_t *reminders, size_t max_count)
 {
     if (!reminders || max_count == 0) return 0;
 
-    // Open NVS for reading
+    storage_lock();
+    if (ensure_table_loaded() != ESP_OK || header.count == 0) {
+        storage_unlock();
+        return 0;
+    }
+
     nvs_handle_t handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, REMINDER_NAMESPACE, NVS_READONLY, &handle);
+    esp_err_t err = storage_open(REMINDER_NAMESPACE, NVS_READONLY, &handle);
     if (err != ESP_OK) {
+        storage_unlock();
         ESP_LOGW(TAG, "No reminders to read or failed to open namespace.");
         return 0;
     }
 
     size_t num_filled = 0;
-    nvs_iterator_t it;
-    esp_err_t it_err = nvs_entry_find(NVS_PARTITION, REMINDER_NAMESPACE, NVS_TYPE_BLOB, &it);
-
-    while (it_err == ESP_OK && num_filled < max_count) {
-        nvs_entry_info_t info;
-        nvs_entry_info(it, &info);
-
-        size_t blob_size = sizeof(type1_reminder_t);
-        err = nvs_get_blob(handle, info.key, &reminders[num_filled], &blob_size);
-        if (err == ESP_OK && blob_size == sizeof(type1_reminder_t)) {
+    for (int id = 1; id <= REMINDER_MAX_ID && num_filled < max_count; id++) {
+        if (id_in_use(id) && read_slot(handle, id, &reminders[num_filled]) == ESP_OK) {
             num_filled++;
         }
-
-        it_err = nvs_entry_next(&it);
     }
-    nvs_release_iterator(it);
-    nvs_close(handle);
+    storage_close(handle);
+    storage_unlock();
 
     return num_filled;
 }
@@ -181,65 +431,71 @@ size_t get_all_type1_reminders(type1_reminder_t *reminders, size_t max_count)
  * @brief Update an existing type1 reminder in NVS (matching Reminder_ID).
  *
  * @param reminder Pointer to the updated reminder data.
- * @return ESP_OK on success, error otherwise.
+ * Only the reminder's slot is written; the header does not change.
+ *
+ * @return ESP_OK on success, ESP_ERR_NVS_NOT_FOUND if the ID is not in use, error otherwise.
  */
 esp_err_t update_type1_reminder(const type1_reminder_t *reminder)
 {
-    if (!reminder || reminder->Reminder_ID == 0) {
+    if (!reminder || reminder->Reminder_ID == 0 || reminder->Reminder_ID > REMINDER_MAX_ID) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, REMINDER_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        return err;
+    storage_lock();
+    esp_err_t err = ensure_table_loaded();
+    if (err == ESP_OK && !id_in_use(reminder->Reminder_ID)) {
+        err = ESP_ERR_NVS_NOT_FOUND;
     }
-
-    char key[8];
-    snprintf(key, sizeof(key), "R%u", reminder->Reminder_ID);
-
-    err = nvs_set_blob(handle, key, reminder, sizeof(*reminder));
-    if (err != ESP_OK) {
-        nvs_close(handle);
-        return err;
+    if (err == ESP_OK) {
+        err = write_table(reminder, NULL, REMINDER_NO_ID);
+    }
+    if (err == ESP_OK) {
+        index_remove(reminder->Reminder_ID);
+        index_insert(reminder->Reminder_ID,
+                     reminder_key(reminder->Task_ID, reminder->Task_Option_Selected,
+                                  reminder->Task_Additional_Option_Selected));
+    }
+    storage_unlock();
+    if (err == ESP_OK) {
+        storage_notify_change(STORAGE_CHANGE_REMINDER, reminder->Reminder_ID);
     }
-
-    err = nvs_commit(handle);
-    nvs_close(handle);
-
     return err;
 }
 
 /**
  * @brief Delete a reminder by its ID.
  *
+ * Only the header is rewritten: clearing the bitmap bit frees the slot, which is
+ * then erased.
+ *
  * @param reminder_id The ID of the reminder to delete.
- * @return ESP_OK on success, error otherwise.
+ * @return ESP_OK on success, ESP_ERR_NVS_NOT_FOUND if the ID is not in use, error otherwise.
  */
 esp_err_t delete_reminder(uint8_t reminder_id)
 {
-    if (reminder_id == 0) {
+    if (reminder_id == 0 || reminder_id > REMINDER_MAX_ID) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, REMINDER_NAMESPACE, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        return err;
+    storage_lock();
+    esp_err_t err = ensure_table_loaded();
+    if (err == ESP_OK && !id_in_use(reminder_id)) {
+        err = ESP_ERR_NVS_NOT_FOUND;
     }
-
-    char key[8];
-    snprintf(key, sizeof(key), "R%u", reminder_id);
-
-    err = nvs_erase_key(handle, key);
-    if (err != ESP_OK) {
-        nvs_close(handle);
-        return err;
+    if (err == ESP_OK) {
+        reminder_table_header_t new_header = header;
+        new_header.bitmap[reminder_id / 32] &= ~(1u << (reminder_id % 32));
+        new_header.count--;
+        err = write_table(NULL, &new_header, reminder_id);
+        if (err == ESP_OK) {
+            header = new_header;
+            index_remove(reminder_id);
+        }
+    }
+    storage_unlock();
+    if (err == ESP_OK) {
+        storage_notify_change(STORAGE_CHANGE_REMINDER, reminder_id);
     }
-
-    err = nvs_commit(handle);
-    nvs_close(handle);
-
     return err;
 }
 
@@ -252,35 +508,36 @@ esp_err_t delete_reminder(uint8_t reminder_id)
  */
 esp_err_t get_reminder_by_id(uint8_t reminder_id, type1_reminder_t *reminder)
 {
-    if (!reminder || reminder_id == 0) {
+    if (!reminder || reminder_id == 0 || reminder_id > REMINDER_MAX_ID) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, REMINDER_NAMESPACE, NVS_READONLY, &handle);
-    if (err != ESP_OK) {
-        return err;
+    storage_lock();
+    esp_err_t err = ensure_table_loaded();
+    if (err == ESP_OK && !id_in_use(reminder_id)) {
+        err = ESP_ERR_NVS_NOT_FOUND;
     }
+    if (err == ESP_OK) {
+        nvs_handle_t handle;
+        err = storage_open(REMINDER_NAMESPACE, NVS_READONLY, &handle);
+        if (err == ESP_OK) {
+            err = read_slot(handle, reminder_id, reminder);
+            storage_close(handle);
+        }
+    }
+    storage_unlock();
 
-    char key[8];
-    snprintf(key, sizeof(key), "R%u", reminder_id);
-
-    size_t blob_size = sizeof(type1_reminder_t);
-    err = nvs_get_blob(handle, key, reminder, &blob_size);
-    nvs_close(handle);
-
-    if (err != ESP_OK || blob_size != sizeof(type1_reminder_t)) {
-        ESP_LOGE(TAG, "Failed to get reminder for key %s: %s", key, esp_err_to_name(err));
-        return err;
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get reminder %u: %s", reminder_id, esp_err_to_name(err));
     }
-    return ESP_OK;
+    return err;
 }
 
 /**
  * @brief Log the task option string associated with a type1 reminder.
  *
- * This function retrieves the task JSON from NVS using the Task_ID from the reminder,
- * parses it into a task_t structure, and logs the display_text of the selected task option.
+ * This function loads the task record from NVS using the Task_ID from the reminder
+ * and logs the display_text of the selected task option.
  *
  * @param reminder Pointer to a type1_reminder_t structure.
  */
@@ -291,20 +548,12 @@ void log_type1_reminder(const type1_reminder_t *reminder)
         return;
     }
 
-    // Retrieve task JSON using Task_ID (stored in reminder->Task_ID)
-    char *task_json = retrieve_task_json(reminder->Task_ID);
-    if (task_json == NULL) {
-        ESP_LOGE(TAG, "Task with ID %d not found in NVS", reminder->Task_ID);
-        return;
-    }
-
+    // Load the binary task record using Task_ID (stored in reminder->Task_ID)
     task_t task;
-    if (!parse_task_json(task_json, &task)) {
-        ESP_LOGE(TAG, "Failed to parse task JSON for task ID %d", reminder->Task_ID);
-        free(task_json);
+    if (load_task(reminder->Task_ID, &task) != ESP_OK) {
+        ESP_LOGE(TAG, "Task with ID %d not found in NVS", reminder->Task_ID);
         return;
     }
-    free(task_json);
 
     // Validate the selected option index.
     if (reminder->Task_Option_Selected >= TASK_MAX_OPTIONS) {
@@ -6,12 +6,15 @@
 #include <time.h>
 #include "esp_err.h"
 
+#define REMINDER_NAMESPACE "Rmdr"
+#define REMINDER_MAX_ID 254       // IDs 1..254 are assignable
+
 /**
- * @brief Struct for a type1 reminder, stored as a fixed-size binary blob.
+ * @brief Struct for a type1 reminder, stored as one slot blob of the reminder table.
  */
 typedef struct type1_reminder {
     uint8_t  Reminder_Type;  // For now always 1
-    uint8_t  Reminder_ID;    // Assigned automatically, forms the NVS key ("R<ID>")
+    uint8_t  Reminder_ID;    // Assigned automatically from the table's allocation bitmap
     uint8_t  Task_ID;
     uint8_t  Task_Type;
     uint8_t  Task_Option_Selected;
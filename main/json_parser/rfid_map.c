@@ -0,0 +1,416 @@
+#include "rfid_map.h"
+#include "json_parser.h"
+#include <ctype.h>
+
+static const char *TAG = "RFID_MAP";
+
+/*
+ * NVS layout in namespace "mapping":
+ *   "RMHDR" rfid_map_header_t - version and number of slots in use
+ *   "RM<n>" chunk n, RFID_MAP_CHUNK_ENTRIES entries in insertion order
+ * An entry keeps its NVS slot for its whole life, so an assignment rewrites
+ * only one chunk. New entries take the slot after the highest one in use;
+ * slots whose entry was skipped on load (invalid or duplicate UID) stay unused.
+ * In RAM the entries are kept sorted by UID for binary search.
+ */
+#define RFID_MAP_VERSION 1
+#define RFID_MAP_HEADER_KEY "RMHDR"
+#define RFID_MAP_LEGACY_KEY "RFID_MAP"   // hex-string blob used by older firmware
+#define RFID_MAP_LEGACY_MAX 16
+
+typedef struct {
+    uint8_t  version;
+    uint8_t  reserved;
+    uint16_t slot_count;  // highest slot in use + 1
+} rfid_map_header_t;
+
+typedef struct {
+    rfid_map_entry_t entry;
+    uint16_t slot;       // position in the NVS chunks
+} rfid_index_entry_t;
+
+// Layout of the blob written by older firmware.
+typedef struct {
+    char rfid_uid[17];
+    uint8_t task_id;
+} legacy_rfid_entry_t;
+
+typedef struct {
+    uint8_t count;
+    legacy_rfid_entry_t entries[RFID_MAP_LEGACY_MAX];
+} legacy_rfid_mapping_t;
+
+static rfid_index_entry_t *index_entries = NULL;  // sorted by (uid_len, uid)
+static size_t index_count = 0;
+static size_t index_capacity = 0;
+static uint16_t next_slot = 0;   // first slot after the ones in use, as in the header
+static bool map_loaded = false;
+
+static int compare_uid(const rfid_map_entry_t *e, const uint8_t *uid, uint8_t uid_len)
+{
+    if (e->uid_len != uid_len) {
+        return (int)e->uid_len - (int)uid_len;
+    }
+    return memcmp(e->uid, uid, uid_len);
+}
+
+/**
+ * @brief Binary search for a UID in the sorted RAM index.
+ *
+ * @param found Set to true if the UID exists.
+ * @return Position of the UID, or the position where it would be inserted.
+ */
+static size_t index_search(const uint8_t *uid, uint8_t uid_len, bool *found)
+{
+    size_t lo = 0, hi = index_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = compare_uid(&index_entries[mid].entry, uid, uid_len);
+        if (cmp == 0) {
+            *found = true;
+            return mid;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = false;
+    return lo;
+}
+
+static esp_err_t index_reserve(size_t needed)
+{
+    if (needed <= index_capacity) {
+        return ESP_OK;
+    }
+    size_t new_capacity = index_capacity ? index_capacity * 2 : RFID_MAP_CHUNK_ENTRIES;
+    while (new_capacity < needed) {
+        new_capacity *= 2;
+    }
+    if (new_capacity > RFID_MAP_MAX_ENTRIES) {
+        new_capacity = RFID_MAP_MAX_ENTRIES;
+    }
+    rfid_index_entry_t *grown = realloc(index_entries, new_capacity * sizeof(*grown));
+    if (!grown) {
+        return ESP_ERR_NO_MEM;
+    }
+    index_entries = grown;
+    index_capacity = new_capacity;
+    return ESP_OK;
+}
+
+static void index_insert_at(size_t pos, const rfid_map_entry_t *entry, uint16_t slot)
+{
+    memmove(&index_entries[pos + 1], &index_entries[pos], (index_count - pos) * sizeof(*index_entries));
+    index_entries[pos].entry = *entry;
+    index_entries[pos].slot = slot;
+    index_count++;
+}
+
+static void index_remove_at(size_t pos)
+{
+    index_count--;
+    memmove(&index_entries[pos], &index_entries[pos + 1], (index_count - pos) * sizeof(*index_entries));
+}
+
+static void chunk_key(uint16_t chunk, char *key, size_t size)
+{
+    snprintf(key, size, "RM%u", chunk);
+}
+
+/**
+ * @brief Writes the chunk that contains `slot`, taking the entries from the RAM index.
+ */
+static esp_err_t write_chunk_for_slot(nvs_handle_t handle, uint16_t slot)
+{
+    rfid_map_entry_t chunk[RFID_MAP_CHUNK_ENTRIES];
+    memset(chunk, 0, sizeof(chunk));
+    uint16_t first = slot - (slot % RFID_MAP_CHUNK_ENTRIES);
+    size_t used = 0;
+    for (size_t i = 0; i < index_count; i++) {
+        uint16_t s = index_entries[i].slot;
+        if (s >= first && s < first + RFID_MAP_CHUNK_ENTRIES) {
+            chunk[s - first] = index_entries[i].entry;
+            if ((size_t)(s - first) + 1 > used) {
+                used = s - first + 1;
+            }
+        }
+    }
+    char key[8];
+    chunk_key(slot / RFID_MAP_CHUNK_ENTRIES, key, sizeof(key));
+    return nvs_set_blob(handle, key, chunk, used * sizeof(rfid_map_entry_t));
+}
+
+static esp_err_t write_header(nvs_handle_t handle)
+{
+    rfid_map_header_t header = {
+        .version = RFID_MAP_VERSION,
+        .slot_count = next_slot,
+    };
+    return nvs_set_blob(handle, RFID_MAP_HEADER_KEY, &header, sizeof(header));
+}
+
+/**
+ * @brief Adds or updates a mapping in RAM and persists it. Caller holds the storage lock.
+ *
+ * If a write fails the RAM index is restored, so it keeps matching what rfid_map_init()
+ * would load.
+ */
+static esp_err_t assign_locked(nvs_handle_t handle, const rfid_map_entry_t *entry)
+{
+    bool found;
+    size_t pos = index_search(entry->uid, entry->uid_len, &found);
+    uint16_t slot;
+    uint8_t old_task_id = 0;
+    if (found) {
+        old_task_id = index_entries[pos].entry.task_id;
+        if (old_task_id == entry->task_id) {
+            return ESP_OK;  // unchanged, nothing to write
+        }
+        index_entries[pos].entry.task_id = entry->task_id;
+        slot = index_entries[pos].slot;
+    } else {
+        if (next_slot >= RFID_MAP_MAX_ENTRIES) {
+            ESP_LOGE(TAG, "RFID mapping is full");
+            return ESP_ERR_NO_MEM;
+        }
+        esp_err_t err = index_reserve(index_count + 1);
+        if (err != ESP_OK) {
+            return err;
+        }
+        slot = next_slot++;
+        index_insert_at(pos, entry, slot);
+    }
+
+    esp_err_t err = write_chunk_for_slot(handle, slot);
+    if (err == ESP_OK && !found) {
+        err = write_header(handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to write RFID mapping: %s", esp_err_to_name(err));
+        if (found) {
+            index_entries[pos].entry.task_id = old_task_id;
+        } else {
+            index_remove_at(pos);
+            next_slot--;
+        }
+    }
+    return err;
+}
+
+/**
+ * @brief Converts the hex-string mapping written by older firmware.
+ */
+static esp_err_t migrate_legacy_map(nvs_handle_t handle)
+{
+    legacy_rfid_mapping_t legacy;
+    size_t size = sizeof(legacy);
+    esp_err_t err = nvs_get_blob(handle, RFID_MAP_LEGACY_KEY, &legacy, &size);
+    if (err != ESP_OK || size != sizeof(legacy)) {
+        return ESP_OK;  // nothing to migrate
+    }
+    for (int i = 0; i < legacy.count && i < RFID_MAP_LEGACY_MAX; i++) {
+        rfid_map_entry_t entry;
+        memset(&entry, 0, sizeof(entry));
+        legacy.entries[i].rfid_uid[16] = '\0';
+        if (!rfid_hex_to_uid(legacy.entries[i].rfid_uid, entry.uid, &entry.uid_len)) {
+            continue;
+        }
+        entry.task_id = legacy.entries[i].task_id;
+        err = assign_locked(handle, &entry);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    nvs_erase_key(handle, RFID_MAP_LEGACY_KEY);
+    ESP_LOGI(TAG, "Migrated %d legacy RFID mapping(s)", legacy.count);
+    return ESP_OK;
+}
+
+/**
+ * @brief Load the RFID index from NVS into RAM.
+ *
+ * Reads the header and every chunk once, sorts the entries by UID and
+ * migrates the old hex-string mapping if present.
+ *
+ * @return ESP_OK on success, otherwise an error code.
+ */
+esp_err_t rfid_map_init(void)
+{
+    storage_lock();
+    index_count = 0;
+    next_slot = 0;
+
+    nvs_handle_t handle;
+    esp_err_t err = storage_open(RFID_MAP_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS namespace for RFID mapping: %s", esp_err_to_name(err));
+        storage_unlock();
+        return err;
+    }
+
+    rfid_map_header_t header = {0};
+    size_t size = sizeof(header);
+    err = nvs_get_blob(handle, RFID_MAP_HEADER_KEY, &header, &size);
+    if (err == ESP_OK && header.version == RFID_MAP_VERSION && header.slot_count <= RFID_MAP_MAX_ENTRIES) {
+        err = index_reserve(header.slot_count);
+        next_slot = header.slot_count;
+        rfid_map_entry_t chunk[RFID_MAP_CHUNK_ENTRIES];
+        for (uint16_t first = 0; err == ESP_OK && first < header.slot_count; first += RFID_MAP_CHUNK_ENTRIES) {
+            char key[8];
+            chunk_key(first / RFID_MAP_CHUNK_ENTRIES, key, sizeof(key));
+            size = sizeof(chunk);
+            err = nvs_get_blob(handle, key, chunk, &size);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to read RFID chunk %s: %s", key, esp_err_to_name(err));
+                break;
+            }
+            size_t in_chunk = size / sizeof(rfid_map_entry_t);
+            for (size_t i = 0; i < in_chunk && first + i < header.slot_count; i++) {
+                if (chunk[i].uid_len == 0 || chunk[i].uid_len > RFID_UID_MAX_BYTES) {
+                    continue;
+                }
+                bool found;
+                size_t pos = index_search(chunk[i].uid, chunk[i].uid_len, &found);
+                if (!found) {
+                    index_insert_at(pos, &chunk[i], (uint16_t)(first + i));
+                }
+            }
+        }
+    } else if (err == ESP_ERR_NVS_NOT_FOUND) {
+        err = ESP_OK;
+    }
+
+    if (err == ESP_OK) {
+        err = migrate_legacy_map(handle);
+    }
+    if (err == ESP_OK) {
+        err = storage_commit(handle);
+    }
+    storage_close(handle);
+    ESP_LOGI(TAG, "Loaded %d RFID mapping(s)", (int)index_count);
+    map_loaded = (err == ESP_OK);
+    storage_unlock();
+    return err;
+}
+
+/**
+ * @brief Assign a raw RFID UID to a task.
+ *
+ * @param uid     UID bytes as read from the card.
+ * @param uid_len Number of UID bytes (1..RFID_UID_MAX_BYTES).
+ * @param task_id The task ID to assign to the UID.
+ * @return esp_err_t ESP_OK on success, otherwise an error code.
+ */
+esp_err_t assign_rfid_uid_to_task(const uint8_t *uid, uint8_t uid_len, uint8_t task_id)
+{
+    if (!uid || uid_len == 0 || uid_len > RFID_UID_MAX_BYTES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!map_loaded) {
+        ESP_LOGE(TAG, "RFID map not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    rfid_map_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.uid, uid, uid_len);
+    entry.uid_len = uid_len;
+    entry.task_id = task_id;
+
+    storage_lock();
+    nvs_handle_t handle;
+    esp_err_t err = storage_open(RFID_MAP_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = assign_locked(handle, &entry);
+        if (err == ESP_OK) {
+            err = storage_commit(handle);
+        }
+        storage_close(handle);
+    } else {
+        ESP_LOGE(TAG, "Failed to open NVS namespace for RFID mapping: %s", esp_err_to_name(err));
+    }
+    storage_unlock();
+    return err;
+}
+
+/**
+ * @brief Retrieve the task ID assigned to a raw RFID UID.
+ *
+ * @return int The task ID if found, or -1 if not found.
+ */
+int get_task_id_by_rfid_uid(const uint8_t *uid, uint8_t uid_len)
+{
+    if (!uid || uid_len == 0 || uid_len > RFID_UID_MAX_BYTES || !map_loaded) {
+        return -1;
+    }
+    int task_id = -1;
+    storage_lock();
+    bool found;
+    size_t pos = index_search(uid, uid_len, &found);
+    if (found) {
+        task_id = index_entries[pos].entry.task_id;
+    }
+    storage_unlock();
+    return task_id;
+}
+
+bool rfid_hex_to_uid(const char *hex, uint8_t *uid, uint8_t *uid_len)
+{
+    if (!hex || !uid || !uid_len) {
+        return false;
+    }
+    size_t len = strlen(hex);
+    if (len == 0 || len % 2 != 0 || len / 2 > RFID_UID_MAX_BYTES) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i += 2) {
+        if (!isxdigit((unsigned char)hex[i]) || !isxdigit((unsigned char)hex[i + 1])) {
+            return false;
+        }
+        char byte_str[3] = { hex[i], hex[i + 1], '\0' };
+        uid[i / 2] = (uint8_t)strtoul(byte_str, NULL, 16);
+    }
+    *uid_len = (uint8_t)(len / 2);
+    return true;
+}
+
+/**
+ * @brief Assign an RFID UID given as a hex string (task JSON format) to a task.
+ *
+ * @param rfid_uid The RFID UID string (hex characters, no spaces).
+ * @param task_id The task ID to assign to the RFID UID.
+ * @return esp_err_t ESP_OK on success, otherwise an error code.
+ */
+esp_err_t assign_rfid_to_task(const char *rfid_uid, uint8_t task_id)
+{
+    uint8_t uid[RFID_UID_MAX_BYTES];
+    uint8_t uid_len;
+    if (!rfid_hex_to_uid(rfid_uid, uid, &uid_len)) {
+        ESP_LOGE(TAG, "Invalid RFID UID string '%s'", rfid_uid ? rfid_uid : "");
+        return ESP_ERR_INVALID_ARG;
+    }
+    return assign_rfid_uid_to_task(uid, uid_len, task_id);
+}
+
+/**
+ * @brief Retrieve the task ID assigned to an RFID UID given as a hex string.
+ *
+ * @return int The task ID if found, or -1 if not found or on error.
+ */
+int get_task_id_by_rfid(const char *rfid_uid)
+{
+    uint8_t uid[RFID_UID_MAX_BYTES];
+    uint8_t uid_len;
+    if (!rfid_hex_to_uid(rfid_uid, uid, &uid_len)) {
+        return -1;
+    }
+    return get_task_id_by_rfid_uid(uid, uid_len);
+}
+
+size_t rfid_map_count(void)
+{
+    return index_count;
+}
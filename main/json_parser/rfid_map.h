@@ -0,0 +1,42 @@
+#ifndef RFID_MAP_H
+#define RFID_MAP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#define RFID_MAP_NAMESPACE "mapping"   // NVS namespace for RFID mapping
+#define RFID_UID_MAX_BYTES 10          // same as RC522_PICC_UID_SIZE_MAX
+#define RFID_MAP_MAX_ENTRIES 512       // maximum number of mapped tags
+#define RFID_MAP_CHUNK_ENTRIES 32      // entries per "RM<n>" blob in NVS
+
+// One UID-to-task mapping, raw UID bytes as read by the RC522.
+typedef struct {
+    uint8_t uid_len;
+    uint8_t uid[RFID_UID_MAX_BYTES];
+    uint8_t task_id;
+} rfid_map_entry_t;
+
+// Loads the RFID index into RAM. Must be called once after the NVS partition
+// is initialized and before any other rfid_map function.
+esp_err_t rfid_map_init(void);
+
+// Maps a raw UID to a task ID, replacing an existing mapping for the same UID.
+// Updates the RAM index and writes one NVS chunk.
+esp_err_t assign_rfid_uid_to_task(const uint8_t *uid, uint8_t uid_len, uint8_t task_id);
+
+// Looks up a raw UID in the RAM index (binary search, no flash access).
+// Returns the task ID, or -1 if the UID is not mapped.
+int get_task_id_by_rfid_uid(const uint8_t *uid, uint8_t uid_len);
+
+// Hex string variants (e.g. "AAB4B512") used by the task JSON format.
+esp_err_t assign_rfid_to_task(const char *rfid_uid, uint8_t task_id);
+int get_task_id_by_rfid(const char *rfid_uid);
+
+// Converts a hex string without spaces to UID bytes. Returns false if the
+// string is not an even number of hex digits or is too long.
+bool rfid_hex_to_uid(const char *hex, uint8_t *uid, uint8_t *uid_len);
+
+size_t rfid_map_count(void);
+
+#endif // RFID_MAP_H
@@ -0,0 +1,403 @@
+#include "storage.h"
+#include "json_parser.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "STORAGE";
+
+typedef struct {
+    char namespace_name[NVS_NS_NAME_MAX_SIZE];
+    nvs_open_mode_t open_mode;
+    nvs_handle_t handle;
+    bool dirty;
+} session_namespace_t;
+
+#define STORAGE_CHANGE_KINDS 3       // values of storage_change_t
+#define STORAGE_CHANGE_MAX_ID 255    // record IDs are uint8_t
+
+static SemaphoreHandle_t storage_mutex = NULL;
+static portMUX_TYPE storage_mutex_init_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Session state, only touched by the task holding storage_mutex.
+static TaskHandle_t session_owner = NULL;
+static int session_depth = 0;
+static session_namespace_t session_namespaces[STORAGE_SESSION_MAX_NAMESPACES];
+static int session_namespace_count = 0;
+// Changes notified during the session, one bit per record ID, sent after the last commit.
+static uint32_t session_changes[STORAGE_CHANGE_KINDS][(STORAGE_CHANGE_MAX_ID + 1) / 32];
+static bool session_changed = false;
+
+static storage_stats_t stats;
+
+typedef struct {
+    storage_listener_fn fn;
+    void *ctx;
+} storage_listener_t;
+
+// Registered once at start-up and never removed, so notifying needs no lock.
+static storage_listener_t listeners[STORAGE_MAX_LISTENERS];
+static volatile int listener_count = 0;
+
+void storage_lock(void)
+{
+    if (storage_mutex == NULL) {
+        SemaphoreHandle_t mutex = xSemaphoreCreateRecursiveMutex();
+        taskENTER_CRITICAL(&storage_mutex_init_lock);
+        if (storage_mutex == NULL) {
+            storage_mutex = mutex;
+            mutex = NULL;
+        }
+        taskEXIT_CRITICAL(&storage_mutex_init_lock);
+        if (mutex != NULL) {
+            vSemaphoreDelete(mutex);
+        }
+    }
+    xSemaphoreTakeRecursive(storage_mutex, portMAX_DELAY);
+}
+
+void storage_unlock(void)
+{
+    xSemaphoreGiveRecursive(storage_mutex);
+}
+
+static bool in_own_session(void)
+{
+    return session_depth > 0 && session_owner == xTaskGetCurrentTaskHandle();
+}
+
+static session_namespace_t *find_session_handle(nvs_handle_t handle)
+{
+    for (int i = 0; i < session_namespace_count; i++) {
+        if (session_namespaces[i].handle == handle) {
+            return &session_namespaces[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Open a namespace of the application NVS partition.
+ *
+ * Takes the storage lock; it is released by the matching storage_close().
+ * If opening fails the lock is released before returning, so no close is needed.
+ * Inside a session the session's handle for the namespace is returned: a read-only
+ * open reuses any handle of the namespace, a read-write open only a read-write one.
+ */
+esp_err_t storage_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    storage_lock();
+    if (!in_own_session()) {
+        esp_err_t err = nvs_open_from_partition(NVS_PARTITION, namespace_name, open_mode, out_handle);
+        if (err != ESP_OK) {
+            *out_handle = 0;
+            storage_unlock();
+        }
+        return err;
+    }
+
+    for (int i = 0; i < session_namespace_count; i++) {
+        if (strncmp(session_namespaces[i].namespace_name, namespace_name, NVS_NS_NAME_MAX_SIZE) == 0 &&
+            (open_mode == NVS_READONLY || session_namespaces[i].open_mode == NVS_READWRITE)) {
+            *out_handle = session_namespaces[i].handle;
+            return ESP_OK;
+        }
+    }
+    if (session_namespace_count >= STORAGE_SESSION_MAX_NAMESPACES) {
+        ESP_LOGE(TAG, "Too many namespaces in one session");
+        *out_handle = 0;
+        storage_unlock();
+        return ESP_ERR_NO_MEM;
+    }
+
+    session_namespace_t *ns = &session_namespaces[session_namespace_count];
+    esp_err_t err = nvs_open_from_partition(NVS_PARTITION, namespace_name, open_mode, &ns->handle);
+    if (err != ESP_OK) {
+        *out_handle = 0;
+        storage_unlock();
+        return err;
+    }
+    strncpy(ns->namespace_name, namespace_name, NVS_NS_NAME_MAX_SIZE - 1);
+    ns->namespace_name[NVS_NS_NAME_MAX_SIZE - 1] = '\0';
+    ns->open_mode = open_mode;
+    ns->dirty = false;
+    session_namespace_count++;
+    *out_handle = ns->handle;
+    return ESP_OK;
+}
+
+/**
+ * @brief Commit changes made through a handle from storage_open().
+ *
+ * Inside a session the commit is deferred to storage_session_end().
+ */
+esp_err_t storage_commit(nvs_handle_t handle)
+{
+    stats.commits_requested++;
+    if (in_own_session()) {
+        session_namespace_t *ns = find_session_handle(handle);
+        if (ns != NULL) {
+            ns->dirty = true;
+            return ESP_OK;
+        }
+    }
+    stats.commits_performed++;
+    return nvs_commit(handle);
+}
+
+/**
+ * @brief Close a handle from storage_open() and release the storage lock.
+ *
+ * Session handles stay open until storage_session_end().
+ */
+void storage_close(nvs_handle_t handle)
+{
+    if (!(in_own_session() && find_session_handle(handle) != NULL)) {
+        nvs_close(handle);
+    }
+    storage_unlock();
+}
+
+/**
+ * @brief Start batching storage writes of the calling task.
+ *
+ * Sessions can be nested; only the outermost storage_session_end() commits.
+ */
+esp_err_t storage_session_begin(void)
+{
+    storage_lock();
+    if (session_depth == 0) {
+        session_owner = xTaskGetCurrentTaskHandle();
+        session_namespace_count = 0;
+    }
+    session_depth++;
+    return ESP_OK;
+}
+
+/**
+ * @brief Send the changes queued during a session to the listeners.
+ */
+static void notify_changes(uint32_t changes[STORAGE_CHANGE_KINDS][(STORAGE_CHANGE_MAX_ID + 1) / 32])
+{
+    for (int kind = 0; kind < STORAGE_CHANGE_KINDS; kind++) {
+        for (int word = 0; word < (STORAGE_CHANGE_MAX_ID + 1) / 32; word++) {
+            for (uint32_t bits = changes[kind][word]; bits != 0; bits &= bits - 1) {
+                storage_notify_change((storage_change_t)kind, word * 32 + __builtin_ctz(bits));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Commit every namespace written in the session once and close its handles.
+ *
+ * Change notifications made during the session are sent afterwards, once the storage
+ * lock is released.
+ *
+ * @return ESP_OK, or the first commit error.
+ */
+esp_err_t storage_session_end(void)
+{
+    if (!in_own_session()) {
+        ESP_LOGE(TAG, "storage_session_end called without an active session");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t result = ESP_OK;
+    bool changed = false;
+    uint32_t changes[STORAGE_CHANGE_KINDS][(STORAGE_CHANGE_MAX_ID + 1) / 32];
+    session_depth--;
+    if (session_depth == 0) {
+        for (int i = 0; i < session_namespace_count; i++) {
+            if (session_namespaces[i].dirty) {
+                stats.commits_performed++;
+                esp_err_t err = nvs_commit(session_namespaces[i].handle);
+                if (err != ESP_OK && result == ESP_OK) {
+                    ESP_LOGE(TAG, "Commit of namespace '%s' failed: %s",
+                             session_namespaces[i].namespace_name, esp_err_to_name(err));
+                    result = err;
+                }
+            }
+            nvs_close(session_namespaces[i].handle);
+        }
+        session_namespace_count = 0;
+        changed = session_changed;
+        if (changed) {
+            memcpy(changes, session_changes, sizeof(changes));
+            memset(session_changes, 0, sizeof(session_changes));
+            session_changed = false;
+        }
+        session_owner = NULL;
+        stats.sessions++;
+        ESP_LOGI(TAG, "Session finished, %u flash commit(s) saved so far", (unsigned)storage_commits_saved());
+    }
+    storage_unlock();
+    if (changed) {
+        notify_changes(changes);
+    }
+    return result;
+}
+
+/**
+ * @brief 32-bit FNV-1a hash used as a record content fingerprint.
+ */
+uint32_t storage_fingerprint(const void *data, size_t len)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Writes data under key unless the stored fingerprint already matches it.
+ *
+ * The fingerprint is erased before the data is written and stored again only after
+ * the data write succeeded, so a stored fingerprint always describes the record.
+ */
+static esp_err_t set_if_changed(nvs_handle_t handle, const char *key, const void *data, size_t len,
+                                bool is_str, bool *written)
+{
+    if (written) {
+        *written = false;
+    }
+    char fp_key[16];
+    if (strlen(key) > sizeof(fp_key) - 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    fp_key[0] = STORAGE_FINGERPRINT_PREFIX;
+    strcpy(fp_key + 1, key);
+
+    uint32_t fingerprint = storage_fingerprint(data, len);
+    uint32_t stored = 0;
+    if (nvs_get_u32(handle, fp_key, &stored) == ESP_OK && stored == fingerprint) {
+        storage_lock();
+        stats.writes_skipped++;
+        storage_unlock();
+        ESP_LOGD(TAG, "Record %s unchanged, write skipped", key);
+        return ESP_OK;
+    }
+
+    // Drop the old fingerprint first: if a later write fails, no fingerprint is left
+    // that could match old content and skip the write that should restore it.
+    esp_err_t err = nvs_erase_key(handle, fp_key);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+    err = is_str ? nvs_set_str(handle, key, (const char *)data)
+                 : nvs_set_blob(handle, key, data, len);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (written) {
+        *written = true;
+    }
+    err = nvs_set_u32(handle, fp_key, fingerprint);
+    if (err != ESP_OK) {
+        // The record is stored; without a fingerprint its next store is simply not skipped.
+        ESP_LOGW(TAG, "Fingerprint of %s not stored: %s", key, esp_err_to_name(err));
+    }
+    return ESP_OK;
+}
+
+esp_err_t storage_set_blob_if_changed(nvs_handle_t handle, const char *key, const void *data, size_t len, bool *written)
+{
+    if (!key || !data) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return set_if_changed(handle, key, data, len, false, written);
+}
+
+esp_err_t storage_set_str_if_changed(nvs_handle_t handle, const char *key, const char *str, bool *written)
+{
+    if (!key || !str) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return set_if_changed(handle, key, str, strlen(str), true, written);
+}
+
+/**
+ * @brief Returns true when the defaults for this generation have not been applied yet.
+ */
+bool storage_provisioning_needed(uint32_t generation)
+{
+    nvs_handle_t handle;
+    if (storage_open(STORAGE_META_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        return true;  // namespace does not exist yet - first boot
+    }
+    uint32_t stored = 0;
+    esp_err_t err = nvs_get_u32(handle, "prov_gen", &stored);
+    storage_close(handle);
+    return err != ESP_OK || stored != generation;
+}
+
+/**
+ * @brief Records that the defaults for this generation are in NVS.
+ */
+esp_err_t storage_set_provisioned(uint32_t generation)
+{
+    nvs_handle_t handle;
+    esp_err_t err = storage_open(STORAGE_META_NAMESPACE, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error opening NVS namespace '%s': %s", STORAGE_META_NAMESPACE, esp_err_to_name(err));
+        return err;
+    }
+    err = nvs_set_u32(handle, "prov_gen", generation);
+    if (err == ESP_OK) {
+        err = storage_commit(handle);
+    }
+    storage_close(handle);
+    return err;
+}
+
+esp_err_t storage_add_listener(storage_listener_fn listener, void *ctx)
+{
+    if (listener == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    storage_lock();
+    esp_err_t err = ESP_ERR_NO_MEM;
+    if (listener_count < STORAGE_MAX_LISTENERS) {
+        listeners[listener_count].fn = listener;
+        listeners[listener_count].ctx = ctx;
+        listener_count++;
+        err = ESP_OK;
+    }
+    storage_unlock();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "No room for another storage listener");
+    }
+    return err;
+}
+
+void storage_notify_change(storage_change_t change, int id)
+{
+    if (in_own_session() && id >= 0 && id <= STORAGE_CHANGE_MAX_ID && (int)change < STORAGE_CHANGE_KINDS) {
+        // Sent by storage_session_end(), after the commit and outside the lock.
+        session_changes[change][id / 32] |= 1u << (id % 32);
+        session_changed = true;
+        return;
+    }
+    int count = listener_count;
+    for (int i = 0; i < count; i++) {
+        listeners[i].fn(change, id, listeners[i].ctx);
+    }
+}
+
+void storage_get_stats(storage_stats_t *out)
+{
+    if (!out) {
+        return;
+    }
+    storage_lock();
+    *out = stats;
+    storage_unlock();
+}
+
+uint32_t storage_commits_saved(void)
+{
+    return stats.commits_requested - stats.commits_performed;
+}
@@ -0,0 +1,85 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "nvs.h"
+
+#define STORAGE_SESSION_MAX_NAMESPACES 8  // handles one session can hold open (read-only and read-write apart)
+#define STORAGE_META_NAMESPACE "Storage"     // bookkeeping owned by the storage layer
+#define STORAGE_FINGERPRINT_PREFIX '#'       // fingerprint of record "X" lives under "#X"
+#define STORAGE_MAX_LISTENERS 4               // change listeners storage_add_listener() accepts
+
+// Kind of record a change notification refers to.
+typedef enum {
+    STORAGE_CHANGE_REMINDER,
+    STORAGE_CHANGE_TASK,
+    STORAGE_CHANGE_TIMETABLE,
+} storage_change_t;
+
+// Called after a record was written or erased. Runs in the task that made the change,
+// so listeners must not block (give a notification or a semaphore and return).
+typedef void (*storage_listener_fn)(storage_change_t change, int id, void *ctx);
+
+typedef struct {
+    uint32_t sessions;            // completed sessions
+    uint32_t commits_requested;   // storage_commit() calls made by the store functions
+    uint32_t commits_performed;   // nvs_commit() calls that actually reached flash
+    uint32_t writes_skipped;      // record writes skipped because the content was unchanged
+} storage_stats_t;
+
+/*
+ * All access to the NVS partition goes through storage_open/storage_commit/storage_close.
+ * Outside a session they behave like nvs_open_from_partition/nvs_commit/nvs_close.
+ *
+ * Between storage_session_begin() and storage_session_end() the calling task keeps
+ * one handle per namespace open, storage_commit() only marks the namespace dirty,
+ * and storage_session_end() commits every dirty namespace once. Other tasks block in
+ * storage_open() until the session ends, so they never see a half-applied batch.
+ */
+esp_err_t storage_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle);
+esp_err_t storage_commit(nvs_handle_t handle);
+void storage_close(nvs_handle_t handle);
+
+esp_err_t storage_session_begin(void);
+esp_err_t storage_session_end(void);
+
+// Recursive lock shared by the storage layer. Modules that keep RAM state in sync
+// with NVS (reminder table, RFID index) hold it while they touch that state.
+void storage_lock(void);
+void storage_unlock(void);
+
+/*
+ * Skip-if-unchanged writes. Each record keeps a 32-bit fingerprint of its encoded
+ * content next to it (key "#<key>", so <key> may be at most 14 characters). When the
+ * new content hashes to the stored fingerprint nothing is written and *written is set
+ * to false, so the caller can skip its commit as well. Whoever erases a record must
+ * also erase its fingerprint.
+ */
+uint32_t storage_fingerprint(const void *data, size_t len);
+esp_err_t storage_set_blob_if_changed(nvs_handle_t handle, const char *key, const void *data, size_t len, bool *written);
+esp_err_t storage_set_str_if_changed(nvs_handle_t handle, const char *key, const char *str, bool *written);
+
+/*
+ * Provisioning generation. Defaults are applied only when the generation recorded
+ * in NVS differs from the one the firmware was built with.
+ */
+bool storage_provisioning_needed(uint32_t generation);
+esp_err_t storage_set_provisioned(uint32_t generation);
+
+/*
+ * Change notification. The store functions call storage_notify_change() after a
+ * record really changed (skipped writes notify nobody), once they released the storage
+ * lock. Inside a session the change is queued and sent by the outermost
+ * storage_session_end(), after the commit and outside the lock. Lets RAM consumers
+ * such as the alarm scheduler sleep instead of polling.
+ */
+esp_err_t storage_add_listener(storage_listener_fn listener, void *ctx);
+void storage_notify_change(storage_change_t change, int id);
+
+void storage_get_stats(storage_stats_t *stats);
+// Number of flash commits avoided by batching in sessions.
+uint32_t storage_commits_saved(void);
+
+#endif // STORAGE_H
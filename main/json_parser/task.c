@@ -1,5 +1,5 @@
 #include "task.h"
-#include "json_parser.h"  // Contains cJSON and esp logging includes
+#include "json_parser.h"  // Contains esp logging and NVS includes
 
 // Use a dedicated tag for logging.
 static const char *TAG = "TASK_NVS";
@@ -9,8 +9,11 @@ static const char *TAG = "TASK_NVS";
  * @brief Create default task(s) and store them in NVS.
  *
  * Creates default tasks without RFID_UID (empty string) and stores them.
+ * All tasks are attempted even if one fails.
+ *
+ * @return ESP_OK if every task was stored, otherwise the error of the last failure.
  */
-void set_default_tasks(void)
+esp_err_t set_default_tasks(void)
 {
     const char *localTAG = "DEFAULT_TASKS";
     // Create three default tasks.
@@ -18,8 +21,8 @@ void set_default_tasks(void)
     memset(&t1, 0, sizeof(t1));
     memset(&t2, 0, sizeof(t2));
     memset(&t3, 0, sizeof(t3));
-    char *json_str;
     esp_err_t err;
+    esp_err_t result = ESP_OK;
 
      // Default Task 1 using JSON
     const char *t1_json = "{"
@@ -59,8 +62,10 @@ void set_default_tasks(void)
     err = store_task_json(t1_json, true);
     if(err == ESP_OK)
         ESP_LOGI(localTAG, "Stored default task 1 successfully.");
-    else
+    else {
         ESP_LOGE(localTAG, "Failed to store default task 1: %s", esp_err_to_name(err));
+        result = err;
+    }
 
 
     // Default Task 2
@@ -84,16 +89,12 @@ void set_default_tasks(void)
         }
     }
 
-    json_str = task_to_json(&t2);
-    if (json_str != NULL) {
-        err = store_task_json(json_str, true);
-        if(err == ESP_OK)
-            ESP_LOGI(localTAG, "Stored default task 2 successfully.");
-        else
-            ESP_LOGE(localTAG, "Failed to store default task 2: %s", esp_err_to_name(err));
-        free(json_str);
-    } else {
-        ESP_LOGE(localTAG, "Failed to generate JSON for default task 2.");
+    err = store_task(&t2, true);
+    if(err == ESP_OK)
+        ESP_LOGI(localTAG, "Stored default task 2 successfully.");
+    else {
+        ESP_LOGE(localTAG, "Failed to store default task 2: %s", esp_err_to_name(err));
+        result = err;
     }
 
 
@@ -135,14 +136,121 @@ void set_default_tasks(void)
     err = store_task_json(t3_json, true);
     if(err == ESP_OK)
         ESP_LOGI(localTAG, "Stored default task 3 (personal task) successfully.");
-    else
+    else {
         ESP_LOGE(localTAG, "Failed to store default task 3: %s", esp_err_to_name(err));
+        result = err;
+    }
 
+    return result;
+}
 
+/**
+ * @brief Decodes one element of "Options" (must be an object).
+ */
+static bool parse_task_option(json_stream_t *js, task_option_t *option, int index)
+{
+    if (json_stream_peek(js) != JSON_STREAM_OBJECT) {
+        ESP_LOGE(TAG, "Missing or invalid 'display_text' in option %d", index);
+        return false;
+    }
+    json_stream_object_begin(js);
+
+    enum { SEEN_TEXT = 1, SEEN_TIMESLOTS = 2, SEEN_PRIORITY = 4, SEEN_DAYS = 8 };
+    uint8_t seen = 0;
+    char key[JSON_STREAM_KEY_MAX];
+    int value;
+    // if "Timeslots" is not present, count is 0
+    option->timeslot_count = 0;
+
+    while (json_stream_next_key(js, key, sizeof(key))) {
+        if (!(seen & SEEN_TEXT) && json_stream_key_equals(key, "display_text")) {
+            seen |= SEEN_TEXT;
+            if (json_stream_peek(js) != JSON_STREAM_STRING ||
+                !json_stream_read_string(js, option->display_text, sizeof(option->display_text))) {
+                ESP_LOGE(TAG, "Missing or invalid 'display_text' in option %d", index);
+                return false;
+            }
+        } else if (!(seen & SEEN_TIMESLOTS) && json_stream_key_equals(key, "Timeslots")) {
+            seen |= SEEN_TIMESLOTS;
+            if (json_stream_peek(js) != JSON_STREAM_ARRAY) {
+                json_stream_skip(js);
+                continue;
+            }
+            // Timeslots beyond MAX_TASK_TIMESLOTS are dropped
+            json_stream_array_begin(js);
+            int count = 0;
+            while (json_stream_next_element(js)) {
+                if (count >= MAX_TASK_TIMESLOTS) {
+                    json_stream_skip(js);
+                } else if (json_stream_peek(js) == JSON_STREAM_NUMBER && json_stream_read_int(js, &value)) {
+                    option->timeslots[count] = (uint8_t)value;
+                } else {
+                    ESP_LOGE(TAG, "Invalid timeslot in option %d index %d", index, count);
+                    return false;
+                }
+                count++;
+            }
+            option->timeslot_count = (uint8_t)(count > MAX_TASK_TIMESLOTS ? MAX_TASK_TIMESLOTS : count);
+        } else if (!(seen & SEEN_PRIORITY) && json_stream_key_equals(key, "priority")) {
+            seen |= SEEN_PRIORITY;
+            if (json_stream_peek(js) != JSON_STREAM_NUMBER || !json_stream_read_int(js, &value)) {
+                ESP_LOGE(TAG, "Missing or invalid 'priority' in option %d", index);
+                return false;
+            }
+            option->priority = (int8_t)value;
+        } else if (!(seen & SEEN_DAYS) && json_stream_key_equals(key, "days_till_em")) {
+            seen |= SEEN_DAYS;
+            if (json_stream_peek(js) != JSON_STREAM_NUMBER || !json_stream_read_int(js, &value)) {
+                ESP_LOGE(TAG, "Missing or invalid 'days_till_em' in option %d", index);
+                return false;
+            }
+            option->days_till_em = (int8_t)value;
+        } else {
+            json_stream_skip(js);
+        }
+    }
+    if (js->error) {
+        return false;
+    }
+    if (!(seen & SEEN_TEXT)) {
+        ESP_LOGE(TAG, "Missing or invalid 'display_text' in option %d", index);
+        return false;
+    }
+    if (!(seen & SEEN_PRIORITY)) {
+        ESP_LOGE(TAG, "Missing or invalid 'priority' in option %d", index);
+        return false;
+    }
+    if (!(seen & SEEN_DAYS)) {
+        ESP_LOGE(TAG, "Missing or invalid 'days_till_em' in option %d", index);
+        return false;
+    }
+    return true;
+}
 
-
-
-
+/**
+ * @brief Decodes the "Options" array, which must hold exactly TASK_MAX_OPTIONS options.
+ */
+static bool parse_task_options(json_stream_t *js, task_t *task)
+{
+    if (json_stream_peek(js) != JSON_STREAM_ARRAY) {
+        ESP_LOGE(TAG, "'Options' must be an array of exactly %d items", TASK_MAX_OPTIONS);
+        return false;
+    }
+    json_stream_array_begin(js);
+    int count = 0;
+    while (json_stream_next_element(js)) {
+        if (count >= TASK_MAX_OPTIONS) {
+            json_stream_skip(js);
+        } else if (!parse_task_option(js, &task->Options[count], count)) {
+            return false;
+        }
+        count++;
+    }
+    if (js->error || count != TASK_MAX_OPTIONS) {
+        ESP_LOGE(TAG, "'Options' must be an array of exactly %d items", TASK_MAX_OPTIONS);
+        return false;
+    }
+    return true;
 }
 
 /**
@@ -166,6 +274,11 @@ void set_default_tasks(void)
  *       { ... }
  *   ]
  * }
+ *
+ * The document is decoded in one pass with json_stream, straight into task, without
+ * heap allocation. Keys are matched case-insensitively and the first occurrence wins,
+ * as with cJSON_GetObjectItem; parse_task_json_dom in host/json_dom.c is the cJSON
+ * reference.
  */
 bool parse_task_json(const char *json_str, task_t *task)
 {
@@ -173,130 +286,140 @@ bool parse_task_json(const char *json_str, task_t *task)
         ESP_LOGE(TAG, "Invalid input to parse_task_json");
         return false;
     }
-    cJSON *root = cJSON_Parse(json_str);
-    if (!root) {
+    json_stream_t js;
+    json_stream_init(&js, json_str);
+    if (!json_stream_object_begin(&js)) {
         ESP_LOGE(TAG, "Failed to parse task JSON string");
         return false;
     }
 
-    // Parse "Type"
-    cJSON *type = cJSON_GetObjectItem(root, "Type");
-    if (cJSON_IsNumber(type))
-        task->Type = (uint8_t)type->valueint;
-    else {
+    enum { SEEN_TYPE = 1, SEEN_NAME = 2, SEEN_ID = 4, SEEN_RFID = 8, SEEN_OPTIONS = 16 };
+    uint8_t seen = 0;
+    char key[JSON_STREAM_KEY_MAX];
+    int value;
+    task->RFID_UID[0] = '\0';
+
+    while (json_stream_next_key(&js, key, sizeof(key))) {
+        if (!(seen & SEEN_TYPE) && json_stream_key_equals(key, "Type")) {
+            seen |= SEEN_TYPE;
+            if (json_stream_peek(&js) != JSON_STREAM_NUMBER || !json_stream_read_int(&js, &value)) {
+                ESP_LOGE(TAG, "Missing or invalid 'Type'");
+                return false;
+            }
+            task->Type = (uint8_t)value;
+        } else if (!(seen & SEEN_NAME) && json_stream_key_equals(key, "Name")) {
+            seen |= SEEN_NAME;
+            if (json_stream_peek(&js) != JSON_STREAM_STRING ||
+                !json_stream_read_string(&js, task->Name, sizeof(task->Name))) {
+                ESP_LOGE(TAG, "Missing or invalid 'Name'");
+                return false;
+            }
+        } else if (!(seen & SEEN_ID) && json_stream_key_equals(key, "ID")) {
+            seen |= SEEN_ID;
+            if (json_stream_peek(&js) != JSON_STREAM_NUMBER || !json_stream_read_int(&js, &value)) {
+                ESP_LOGE(TAG, "Missing or invalid 'ID'");
+                return false;
+            }
+            task->ID = (uint8_t)value;
+        } else if (!(seen & SEEN_RFID) && json_stream_key_equals(key, "RFID_UID")) {
+            seen |= SEEN_RFID;
+            // If not a string, RFID_UID stays empty
+            if (json_stream_peek(&js) == JSON_STREAM_STRING) {
+                json_stream_read_string(&js, task->RFID_UID, sizeof(task->RFID_UID));
+            } else {
+                json_stream_skip(&js);
+            }
+        } else if (!(seen & SEEN_OPTIONS) && json_stream_key_equals(key, "Options")) {
+            seen |= SEEN_OPTIONS;
+            if (!parse_task_options(&js, task)) {
+                return false;
+            }
+        } else {
+            json_stream_skip(&js);
+        }
+    }
+    if (js.error) {
+        ESP_LOGE(TAG, "Failed to parse task JSON string");
+        return false;
+    }
+    if (!(seen & SEEN_TYPE)) {
         ESP_LOGE(TAG, "Missing or invalid 'Type'");
-        cJSON_Delete(root);
         return false;
     }
-
-    // Parse "Name"
-    cJSON *name = cJSON_GetObjectItem(root, "Name");
-    if (cJSON_IsString(name)) {
-        strncpy(task->Name, name->valuestring, MAX_TASK_NAME_LEN);
-        task->Name[MAX_TASK_NAME_LEN] = '\0';
-    } else {
+    if (!(seen & SEEN_NAME)) {
         ESP_LOGE(TAG, "Missing or invalid 'Name'");
-        cJSON_Delete(root);
         return false;
     }
-
-    // Parse "ID"
-    cJSON *id = cJSON_GetObjectItem(root, "ID");
-    if (cJSON_IsNumber(id))
-        task->ID = (uint8_t)id->valueint;
-    else {
+    if (!(seen & SEEN_ID)) {
         ESP_LOGE(TAG, "Missing or invalid 'ID'");
-        cJSON_Delete(root);
         return false;
     }
-
-    // Parse "RFID_UID"
-    cJSON *rfid = cJSON_GetObjectItem(root, "RFID_UID");
-    if (cJSON_IsString(rfid)) {
-        strncpy(task->RFID_UID, rfid->valuestring, MAX_RFID_UID_LEN);
-        task->RFID_UID[MAX_RFID_UID_LEN] = '\0';
-    } else {
-        // If missing, set to empty string
-        task->RFID_UID[0] = '\0';
-    }
-
-    // Parse "Options" array. Expect exactly 4.
-    cJSON *options = cJSON_GetObjectItem(root, "Options");
-    if (!cJSON_IsArray(options) || (cJSON_GetArraySize(options) != TASK_MAX_OPTIONS)) {
+    if (!(seen & SEEN_OPTIONS)) {
         ESP_LOGE(TAG, "'Options' must be an array of exactly %d items", TASK_MAX_OPTIONS);
-        cJSON_Delete(root);
         return false;
     }
+    return true;
+}
 
+/**
+ * @brief Write the JSON representation of a task to a json_writer.
+ *
+ * Produces the same text cJSON_PrintUnformatted did for the old cJSON tree,
+ * so fingerprints of stored JSON stay valid.
+ */
+void task_write_json(json_writer_t *w, const task_t *task)
+{
+    json_write_object_begin(w);
+    json_write_key(w, "Type");
+    json_write_int(w, task->Type);
+    json_write_key(w, "Name");
+    json_write_string(w, task->Name);
+    json_write_key(w, "ID");
+    json_write_int(w, task->ID);
+    json_write_key(w, "RFID_UID");
+    json_write_string(w, task->RFID_UID);
+
+    json_write_key(w, "Options");
+    json_write_array_begin(w);
     for (int i = 0; i < TASK_MAX_OPTIONS; i++) {
-        cJSON *option = cJSON_GetArrayItem(options, i);
-        if (!option) {
-            ESP_LOGE(TAG, "Missing option at index %d", i);
-            cJSON_Delete(root);
-            return false;
-        }
-
-        // Parse "display_text"
-        cJSON *disp = cJSON_GetObjectItem(option, "display_text");
-        if (cJSON_IsString(disp)) {
-            strncpy(task->Options[i].display_text, disp->valuestring, MAX_OPTION_DISPLAY_LEN);
-            task->Options[i].display_text[MAX_OPTION_DISPLAY_LEN] = '\0';
-        } else {
-            ESP_LOGE(TAG, "Missing or invalid 'display_text' in option %d", i);
-            cJSON_Delete(root);
-            return false;
-        }
-
-        // Parse "Timeslots" array (can be empty)
-        cJSON *ts_array = cJSON_GetObjectItem(option, "Timeslots");
-        if (ts_array && cJSON_IsArray(ts_array)) {
-            int ts_count = cJSON_GetArraySize(ts_array);
-            if (ts_count > MAX_TASK_TIMESLOTS)
-                ts_count = MAX_TASK_TIMESLOTS;
-            task->Options[i].timeslot_count = (uint8_t)ts_count;
-            for (int j = 0; j < ts_count; j++) {
-                cJSON *ts_item = cJSON_GetArrayItem(ts_array, j);
-                if (cJSON_IsNumber(ts_item))
-                    task->Options[i].timeslots[j] = (uint8_t)ts_item->valueint;
-                else {
-                    ESP_LOGE(TAG, "Invalid timeslot in option %d index %d", i, j);
-                    cJSON_Delete(root);
-                    return false;
-                }
-            }
-        } else {
-            // if not present, set count to 0.
-            task->Options[i].timeslot_count = 0;
-        }
-
-        // Parse "priority"
-        cJSON *priority = cJSON_GetObjectItem(option, "priority");
-        if (cJSON_IsNumber(priority))
-            task->Options[i].priority = (int8_t)priority->valueint;
-        else {
-            ESP_LOGE(TAG, "Missing or invalid 'priority' in option %d", i);
-            cJSON_Delete(root);
-            return false;
-        }
-
-        // Parse "days_till_em"
-        cJSON *days = cJSON_GetObjectItem(option, "days_till_em");
-        if (cJSON_IsNumber(days))
-            task->Options[i].days_till_em = (int8_t)days->valueint;
-        else {
-            ESP_LOGE(TAG, "Missing or invalid 'days_till_em' in option %d", i);
-            cJSON_Delete(root);
-            return false;
+        const task_option_t *option = &task->Options[i];
+        json_write_object_begin(w);
+        json_write_key(w, "display_text");
+        json_write_string(w, option->display_text);
+        json_write_key(w, "Timeslots");
+        json_write_array_begin(w);
+        for (int j = 0; j < option->timeslot_count && j < MAX_TASK_TIMESLOTS; j++) {
+            json_write_int(w, option->timeslots[j]);
         }
-    }
+        json_write_array_end(w);
+        json_write_key(w, "priority");
+        json_write_int(w, option->priority);
+        json_write_key(w, "days_till_em");
+        json_write_int(w, option->days_till_em);
+        json_write_object_end(w);
+    }
+    json_write_array_end(w);
+    json_write_object_end(w);
+}
 
-    cJSON_Delete(root);
-    return true;
+/**
+ * @brief Serialize a task into a caller buffer (snprintf semantics).
+ *
+ * @return Length of the full JSON text. Call with buf = NULL to get the exact size.
+ */
+size_t task_to_json_buf(const task_t *task, char *buf, size_t size)
+{
+    json_writer_t w;
+    json_writer_init_buffer(&w, buf, size);
+    task_write_json(&w, task);
+    return json_writer_finish(&w);
 }
 
 /**
  * @brief Convert a task structure to its JSON representation.
- * The returned JSON string must be freed by the caller.
+ *
+ * The exact length is computed first, so the string is one allocation of the
+ * right size. The returned string must be freed by the caller using free().
  */
 char *task_to_json(const task_t *task)
 {
@@ -304,167 +427,75 @@ char *task_to_json(const task_t *task)
         ESP_LOGE(TAG, "Invalid task pointer in task_to_json");
         return NULL;
     }
-    cJSON *root = cJSON_CreateObject();
-    if (!root) {
-        ESP_LOGE(TAG, "Failed to create JSON root");
-        return NULL;
-    }
-
-    if (!cJSON_AddNumberToObject(root, "Type", task->Type)) {
-        ESP_LOGE(TAG, "Failed to add 'Type'");
-        cJSON_Delete(root);
-        return NULL;
-    }
-
-    if (!cJSON_AddStringToObject(root, "Name", task->Name)) {
-        ESP_LOGE(TAG, "Failed to add 'Name'");
-        cJSON_Delete(root);
-        return NULL;
-    }
-
-    if (!cJSON_AddNumberToObject(root, "ID", task->ID)) {
-        ESP_LOGE(TAG, "Failed to add 'ID'");
-        cJSON_Delete(root);
-        return NULL;
-    }
-
-    if (!cJSON_AddStringToObject(root, "RFID_UID", task->RFID_UID)) {
-        ESP_LOGE(TAG, "Failed to add 'RFID_UID'");
-        cJSON_Delete(root);
-        return NULL;
-    }
-
-    // Create Options array
-    cJSON *options = cJSON_CreateArray();
-    if (!options) {
-        ESP_LOGE(TAG, "Failed to create Options array");
-        cJSON_Delete(root);
-        return NULL;
-    }
-    cJSON_AddItemToObject(root, "Options", options);
-
-    for (int i = 0; i < TASK_MAX_OPTIONS; i++) {
-        cJSON *option = cJSON_CreateObject();
-        if (!option) {
-            ESP_LOGE(TAG, "Failed to create option object at index %d", i);
-            cJSON_Delete(root);
-            return NULL;
-        }
-        cJSON_AddItemToArray(options, option);
-
-        if (!cJSON_AddStringToObject(option, "display_text", task->Options[i].display_text)) {
-            ESP_LOGE(TAG, "Failed to add 'display_text' for option %d", i);
-            cJSON_Delete(root);
-            return NULL;
-        }
-
-        // Create Timeslots array
-        cJSON *ts_array = cJSON_CreateArray();
-        if (!ts_array) {
-            ESP_LOGE(TAG, "Failed to create Timeslots array for option %d", i);
-            cJSON_Delete(root);
-            return NULL;
-        }
-        cJSON_AddItemToObject(option, "Timeslots", ts_array);
-        for (int j = 0; j < task->Options[i].timeslot_count; j++) {
-            cJSON *ts_item = cJSON_CreateNumber(task->Options[i].timeslots[j]);
-            if (!ts_item) {
-                ESP_LOGE(TAG, "Failed to create timeslot number for option %d index %d", i, j);
-                cJSON_Delete(root);
-                return NULL;
-            }
-            cJSON_AddItemToArray(ts_array, ts_item);
-        }
-
-        if (!cJSON_AddNumberToObject(option, "priority", task->Options[i].priority)) {
-            ESP_LOGE(TAG, "Failed to add 'priority' for option %d", i);
-            cJSON_Delete(root);
-            return NULL;
-        }
-
-        if (!cJSON_AddNumberToObject(option, "days_till_em", task->Options[i].days_till_em)) {
-            ESP_LOGE(TAG, "Failed to add 'days_till_em' for option %d", i);
-            cJSON_Delete(root);
-            return NULL;
-        }
-    }
-
-    char *json_str = cJSON_PrintUnformatted(root);
+    size_t len = task_to_json_buf(task, NULL, 0);
+    char *json_str = malloc(len + 1);
     if (!json_str) {
-        ESP_LOGE(TAG, "Failed to print task JSON string");
-        cJSON_Delete(root);
+        ESP_LOGE(TAG, "Failed to allocate %u bytes for task JSON string", (unsigned)(len + 1));
         return NULL;
     }
-
-    cJSON_Delete(root);
+    task_to_json_buf(task, json_str, len + 1);
     return json_str;
 }
 
 /**
- * @brief Stores a task JSON string in NVS.
- *
- * Opens namespace "Jtask" and uses as key  "T<ID>".
- * If rfid_uid is not empty, it calls assign_rfid_to_task.
+ * @brief Writes the task record and its RFID mapping (see store_task).
  */
-esp_err_t store_task_json(const char *json_str, bool override_task)
+static esp_err_t write_task(const task_t *task, bool override_task)
 {
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION,"Jtask", NVS_READWRITE, &nvs_handle);
+    esp_err_t err = storage_open(TASK_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error opening NVS namespace 'Jtask': %s", esp_err_to_name(err));
+        ESP_LOGE(TAG, "Error opening NVS namespace '%s': %s", TASK_NAMESPACE, esp_err_to_name(err));
         return err;
     }
 
-    task_t task;
-    if (!parse_task_json(json_str, &task)) {
-        ESP_LOGE(TAG, "Failed to parse task JSON");
-        nvs_close(nvs_handle);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    char key[32];
-    char RFID_UID[17];
-    uint8_t rfid_key_found = 0;
-    snprintf(key, sizeof(key), "T%d", task.ID);
-
-    if (task.RFID_UID[0] != '\0') {
-
-        strncpy(RFID_UID, task.RFID_UID, 16);
-        RFID_UID[16] = '\0';
-        rfid_key_found = 1;
-
-    } else {
-    }
+    char key[16];
+    snprintf(key, sizeof(key), "T%d", task->ID);
 
     size_t required_size = 0;
-    err = nvs_get_str(nvs_handle, key, NULL, &required_size);
+    err = nvs_get_blob(nvs_handle, key, NULL, &required_size);
     if (err == ESP_OK) {
         if (!override_task) {
             ESP_LOGW(TAG, "Key %s already exists and override is disabled", key);
-            nvs_close(nvs_handle);
+            storage_close(nvs_handle);
             return ESP_ERR_NVS_INVALID_STATE;
         }
     } else if (err != ESP_ERR_NVS_NOT_FOUND) {
         ESP_LOGE(TAG, "Error checking key %s: %s", key, esp_err_to_name(err));
-        nvs_close(nvs_handle);
+        storage_close(nvs_handle);
         return err;
     }
 
-    err = nvs_set_str(nvs_handle, key, json_str);
+    task_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.version = TASK_RECORD_VERSION;
+    record.task = *task;
+
+    bool written = false;
+    err = storage_set_blob_if_changed(nvs_handle, key, &record, sizeof(record), &written);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error writing JSON to NVS key %s: %s", key, esp_err_to_name(err));
-        nvs_close(nvs_handle);
+        ESP_LOGE(TAG, "Error writing task record to NVS key %s: %s", key, esp_err_to_name(err));
+        storage_close(nvs_handle);
         return err;
     }
 
-    err = nvs_commit(nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error committing NVS changes for key %s: %s", key, esp_err_to_name(err));
-    } else {
+    if (written) {
+        err = storage_commit(nvs_handle);
+        storage_close(nvs_handle);
+        cache_invalidate_task(task->ID);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Error committing NVS changes for key %s: %s", key, esp_err_to_name(err));
+            return err;
+        }
         ESP_LOGI(TAG, "Successfully stored task under key %s", key);
+        storage_notify_change(STORAGE_CHANGE_TASK, task->ID);
+    } else {
+        storage_close(nvs_handle);
+        ESP_LOGI(TAG, "Task under key %s is unchanged, write skipped", key);
     }
-    if (rfid_key_found) {
-        err = assign_rfid_to_task(RFID_UID, task.ID);
+
+    if (task->RFID_UID[0] != '\0') {
+        err = assign_rfid_to_task(task->RFID_UID, task->ID);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "Failed to assign RFID to task: %s", esp_err_to_name(err));
         }
@@ -472,158 +503,166 @@ esp_err_t store_task_json(const char *json_str, bool override_task)
             ESP_LOGI(TAG, "Assigned RFID to task successfully");
         }
     }
-    nvs_close(nvs_handle);
     return err;
 }
 
 /**
- * @brief Assign an RFID UID to a task.
- *
- * Loads the current mapping blob from NVS, updates or inserts the mapping
- * for the provided RFID UID with the specified task ID, and writes the blob back.
+ * @brief Stores a task as a binary record in NVS.
  *
- * @param rfid_uid The RFID UID string (16 hex characters).
- * @param task_id The task ID to assign to the RFID UID.
- * @return esp_err_t ESP_OK on success, otherwise an error code.
+ * Opens namespace "Task" and writes a task_record_t blob under key "T<ID>".
+ * If the task has an RFID_UID, it calls assign_rfid_to_task. Both writes run
+ * in one storage session, so other tasks see either none or both of them.
  */
-esp_err_t assign_rfid_to_task(const char *rfid_uid, uint8_t task_id)
+esp_err_t store_task(const task_t *task, bool override_task)
 {
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION,RFID_MAP_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace for RFID mapping: %s", esp_err_to_name(err));
-        return err;
-    }
-
-    rfid_mapping_t mapping;
-    size_t required_size = sizeof(mapping);
-
-    // Try to read the blob. If not found, initialize mapping.
-    err = nvs_get_blob(nvs_handle, RFID_MAP_NVS_KEY, &mapping, &required_size);
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        memset(&mapping, 0, sizeof(mapping));
-    } else if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to get RFID mapping blob: %s", esp_err_to_name(err));
-        nvs_close(nvs_handle);
-        return err;
-    }
-
-    // Search for an existing entry with this RFID UID.
-    bool found = false;
-    for (int i = 0; i < mapping.count; i++) {
-        if (strncmp(mapping.entries[i].rfid_uid, rfid_uid, 16) == 0) {
-            mapping.entries[i].task_id = task_id;
-            found = true;
-            break;
-        }
+    if (!task) {
+        ESP_LOGE(TAG, "Invalid task pointer in store_task");
+        return ESP_ERR_INVALID_ARG;
     }
 
-    // If not found and there is room, add it.
-    if (!found) {
-        if (mapping.count < MAX_RFID_MAPPINGS) {
-            strncpy(mapping.entries[mapping.count].rfid_uid, rfid_uid, 16);
-            mapping.entries[mapping.count].rfid_uid[16] = '\0';
-            mapping.entries[mapping.count].task_id = task_id;
-            mapping.count++;
-        } else {
-            ESP_LOGE(TAG, "RFID mapping is full");
-            nvs_close(nvs_handle);
-            return ESP_ERR_NO_MEM;
-        }
-    }
+    storage_session_begin();
+    esp_err_t err = write_task(task, override_task);
+    esp_err_t commit_err = storage_session_end();
+    return (err != ESP_OK) ? err : commit_err;
+}
 
-    // Write the mapping blob back.
-    err = nvs_set_blob(nvs_handle, RFID_MAP_NVS_KEY, &mapping, sizeof(mapping));
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to write RFID mapping blob: %s", esp_err_to_name(err));
-        nvs_close(nvs_handle);
-        return err;
+/**
+ * @brief Parses a task JSON string and stores it as a binary record.
+ *
+ * JSON is only the import format; the task is kept in NVS as a task_record_t.
+ */
+esp_err_t store_task_json(const char *json_str, bool override_task)
+{
+    task_t task;
+    if (!parse_task_json(json_str, &task)) {
+        ESP_LOGE(TAG, "Failed to parse task JSON");
+        return ESP_ERR_INVALID_ARG;
     }
-    err = nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
-    return err;
+    return store_task(&task, override_task);
 }
 
 /**
- * @brief Retrieve the task ID assigned to a given RFID UID.
+ * @brief Converts a task stored by an older firmware (JSON string in "Jtask")
+ *        into a binary record and removes the old string.
  *
- * Opens the mapping blob from NVS and searches for the provided RFID UID.
- *
- * @param rfid_uid The RFID UID string.
- * @return int The task ID if found, or -1 if not found or on error.
+ * @return ESP_OK and a filled task if a legacy entry existed, ESP_ERR_NVS_NOT_FOUND otherwise.
  */
-int get_task_id_by_rfid(const char *rfid_uid)
+static esp_err_t migrate_legacy_task(int id, task_t *task)
 {
+    char key[16];
+    snprintf(key, sizeof(key), "T%d", id);
+    // Probe read-only: opening read-write would create the namespace on every
+    // load miss of a device that never had legacy tasks.
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION,RFID_MAP_NAMESPACE, NVS_READONLY, &nvs_handle);
+    esp_err_t err = storage_open(TASK_LEGACY_NAMESPACE, NVS_READONLY, &nvs_handle);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace for RFID mapping: %s", esp_err_to_name(err));
-        return -1;
+        return ESP_ERR_NVS_NOT_FOUND;
     }
 
-    rfid_mapping_t mapping;
-    size_t required_size = sizeof(mapping);
-    err = nvs_get_blob(nvs_handle, RFID_MAP_NVS_KEY, &mapping, &required_size);
-    nvs_close(nvs_handle);
-
+    size_t required_size = 0;
+    err = nvs_get_str(nvs_handle, key, NULL, &required_size);
     if (err != ESP_OK) {
-        ESP_LOGW(TAG, "RFID mapping blob not found");
-        return -1;
+        storage_close(nvs_handle);
+        return ESP_ERR_NVS_NOT_FOUND;
     }
 
-    for (int i = 0; i < mapping.count; i++) {
-        if (strncmp(mapping.entries[i].rfid_uid, rfid_uid, 16) == 0) {
-            return mapping.entries[i].task_id;
-        }
+    char *json_str = malloc(required_size);
+    if (!json_str) {
+        ESP_LOGE(TAG, "Failed to allocate memory for legacy task JSON");
+        storage_close(nvs_handle);
+        return ESP_ERR_NO_MEM;
+    }
+    err = nvs_get_str(nvs_handle, key, json_str, &required_size);
+    storage_close(nvs_handle);
+    bool parsed = (err == ESP_OK) && parse_task_json(json_str, task);
+    free(json_str);
+    if (!parsed) {
+        ESP_LOGE(TAG, "Legacy task %s could not be read", key);
+        return ESP_ERR_NVS_NOT_FOUND;
     }
-    return -1; // Not found.
-}
 
+    // The legacy string stays until the binary record is stored, so a failed
+    // migration is retried on the next load.
+    err = store_task(task, true);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to store legacy task %s as binary record: %s", key, esp_err_to_name(err));
+        return ESP_OK;
+    }
+    err = storage_open(TASK_LEGACY_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (err == ESP_OK) {
+        nvs_erase_key(nvs_handle, key);
+        err = storage_commit(nvs_handle);
+        storage_close(nvs_handle);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Migrated legacy task %s, but the JSON string was not removed: %s", key, esp_err_to_name(err));
+    } else {
+        ESP_LOGI(TAG, "Migrated legacy JSON task %s to binary record", key);
+    }
+    return ESP_OK;
+}
 
 /**
- * @brief Retrieves the task JSON string from NVS by ID.
+ * @brief Loads a binary task record from NVS by ID.
  *
- * This function looks for key "T<ID>".
+ * Reads the task_record_t blob stored under "T<ID>" with a single nvs_get_blob
+ * and checks its version. No JSON parsing or heap allocation is involved.
  */
-char *retrieve_task_json(int id)
+esp_err_t load_task(int id, task_t *task)
 {
-    char key[32];
+    if (!task) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    char key[16];
     snprintf(key, sizeof(key), "T%d", id);
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION,"Jtask", NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error opening NVS namespace 'Jtask': %s", esp_err_to_name(err));
-        return NULL;
+    esp_err_t err = storage_open(TASK_NAMESPACE, NVS_READONLY, &nvs_handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        // Namespace not created yet - a legacy JSON task may still exist.
+        return migrate_legacy_task(id, task);
+    } else if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error opening NVS namespace '%s': %s", TASK_NAMESPACE, esp_err_to_name(err));
+        return err;
     }
 
-    size_t required_size = 0;
-    err = nvs_get_str(nvs_handle, key, NULL, &required_size);
+    task_record_t record;
+    size_t required_size = sizeof(record);
+    err = nvs_get_blob(nvs_handle, key, &record, &required_size);
+    storage_close(nvs_handle);
+
     if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "Task with key %s not found", key);
-        nvs_close(nvs_handle);
-        return NULL;
+        return migrate_legacy_task(id, task);
     } else if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error reading key %s: %s", key, esp_err_to_name(err));
-        nvs_close(nvs_handle);
-        return NULL;
+        return err;
     }
-
-    char *json_str = malloc(required_size);
-    if (!json_str) {
-        ESP_LOGE(TAG, "Failed to allocate memory for task JSON");
-        nvs_close(nvs_handle);
-        return NULL;
+    if (required_size != sizeof(record) || record.version != TASK_RECORD_VERSION) {
+        ESP_LOGE(TAG, "Task record %s has unsupported version %d (size %d)",
+                 key, record.version, (int)required_size);
+        return ESP_ERR_INVALID_VERSION;
     }
 
-    err = nvs_get_str(nvs_handle, key, json_str, &required_size);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Error retrieving task JSON for key %s: %s", key, esp_err_to_name(err));
-        free(json_str);
-        nvs_close(nvs_handle);
+    *task = record.task;
+    return ESP_OK;
+}
+
+/**
+ * @brief Retrieves a task from NVS by ID and returns it as a JSON string.
+ *
+ * The task is stored in binary form; JSON is produced only for export.
+ */
+char *retrieve_task_json(int id)
+{
+    task_t task;
+    esp_err_t err = load_task(id, &task);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGW(TAG, "Task with key T%d not found", id);
+        return NULL;
+    } else if (err != ESP_OK) {
         return NULL;
     }
-    nvs_close(nvs_handle);
-    return json_str;
+    return task_to_json(&task);
 }
 
 
@@ -642,24 +681,21 @@ void log_task(int id)
 }
 
 
+/**
+ * @brief Load a task by ID into a newly allocated task_t.
+ *
+ * The task comes from the object cache, so repeated lookups do not touch NVS.
+ * The returned task must be freed by the caller.
+ */
 task_t *get_task_by_id(int id) {
-    char *json_str = retrieve_task_json(id);
-    if (!json_str) {
-        return NULL;
-    }
-
     task_t *task = malloc(sizeof(task_t));
     if (!task) {
-        free(json_str);
         return NULL;
     }
 
-    if (!parse_task_json(json_str, task)) {
-        free(json_str);
+    if (cache_get_task(id, task) != ESP_OK) {
         free(task);
         return NULL;
     }
-
-    free(json_str);
     return task;
-}
\ No newline at end of file
+}
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "json_writer.h"
 
 #define MAX_TASK_NAME_LEN         32
 #define MAX_RFID_UID_LEN          17
@@ -11,9 +12,9 @@
 #define TASK_MAX_OPTIONS          4
 #define MAX_TASK_TIMESLOTS        8  // maximum number of timeslots per option
 
-#define RFID_MAP_NVS_KEY "RFID_MAP" // NVS key for RFID UID-to-task ID mapping
-#define RFID_MAP_NAMESPACE "mapping"  // NVS namespace for RFID mapping
-#define MAX_RFID_MAPPINGS 16
+#define TASK_NAMESPACE "Task"          // NVS namespace for binary task records
+#define TASK_LEGACY_NAMESPACE "Jtask"  // NVS namespace of the old JSON task strings
+#define TASK_RECORD_VERSION 1          // bump when the task_t layout changes
 
 typedef struct {
     char display_text[MAX_OPTION_DISPLAY_LEN + 1];    // plus null terminator
@@ -31,45 +32,53 @@ typedef struct {
     task_option_t Options[TASK_MAX_OPTIONS];  // always exactly 4 options
 } task_t;
 
+// Fixed-layout record stored as a blob under "T<ID>" in TASK_NAMESPACE.
+// task_t only contains byte-sized members, so the layout has no padding.
 typedef struct {
-    char rfid_uid[17]; // 16 hex characters + null terminator
-    uint8_t task_id;   // Task ID mapped to this RFID UID
-} rfid_entry_t;
+    uint8_t version;       // TASK_RECORD_VERSION
+    uint8_t reserved[3];
+    task_t task;
+} task_record_t;
 
-typedef struct {
-    uint8_t count;                   // Number of valid entries in the array.
-    rfid_entry_t entries[MAX_RFID_MAPPINGS];
-} rfid_mapping_t;
-
-// Parses a JSON string into a task_t structure.
+// Parses a JSON string into a task_t structure (streaming, no heap allocation).
 // Returns true on success, false on error.
 bool parse_task_json(const char *json_str, task_t *task);
 
-// Converts a task_t structure to a JSON string.
+// Converts a task_t structure to a JSON string (one allocation of the exact size).
 // The returned string must be freed by the caller.
 char *task_to_json(const task_t *task);
 
-// Stores the task JSON string in NVS under namespace "Jtask".
-// The key is either the RFID_UID if non-empty, or "T<ID>" if RFID_UID is empty.
+// Writes the task JSON into buf with snprintf semantics and returns the full length.
+// With buf = NULL nothing is written and the exact length is returned.
+size_t task_to_json_buf(const task_t *task, char *buf, size_t size);
+
+// Writes the task JSON to any json_writer (buffer or chunked sink).
+void task_write_json(json_writer_t *w, const task_t *task);
+
+// Stores a task as a binary task_record_t under "T<ID>" in namespace "Task".
+// If RFID_UID is non-empty, the UID is also mapped to the task ID.
+// If a value already exists and override_task is false, it returns an error.
+esp_err_t store_task(const task_t *task, bool override_task);
+
+// Loads the binary task record "T<ID>" into task (one blob read, no heap use).
+// Returns ESP_ERR_NVS_NOT_FOUND if the task does not exist.
+esp_err_t load_task(int id, task_t *task);
+
+// Parses the task JSON string and stores it with store_task().
 // If a value already exists and override_task is false, it returns an error.
 esp_err_t store_task_json(const char *json_str, bool override_task);
 
-// Retrieves the task JSON string from NVS by ID (searching key "T<ID>").
+// Loads task "T<ID>" and converts it to a JSON string.
 // The returned string must be freed by the caller.
 char *retrieve_task_json(int id);
 
-int get_task_id_by_rfid(const char *rfid_uid);
-
 task_t *get_task_by_id(int id);
 
 
-esp_err_t assign_rfid_to_task(const char *rfid_uid, uint8_t task_id);
-
-
 // Retrieves and logs a task (by ID) stored in NVS.
 void log_task(int id);
 
 // Creates default task(s) and stores them in NVS (without assigning any RFID_UID).
-void set_default_tasks(void);
+esp_err_t set_default_tasks(void);
 
 #endif // TASKS_H
\ No newline at end of file
@@ -8,9 +8,12 @@ static const char *TAG = "TT_NVS";
  *
  * This function creates three default timetables, modifies them to default values, converts
  * them to JSON strings, and stores each under the key "TTX" (where X is the timetable's ID)
- * in the NVS namespace "Jtimetable". Existing entries are overridden.
+ * in the NVS namespace "Jtimetable". Existing entries are overridden; entries whose
+ * content did not change are not rewritten. All timetables are attempted even if one fails.
+ *
+ * @return ESP_OK if every timetable was stored, otherwise the error of the last failure.
  */
-void set_default_timetables(void)
+esp_err_t set_default_timetables(void)
 {
     const char *TAG = "DEFAULT_TIMETABLES";
     timetable_t tt0, tt1, tt2, tt3;
@@ -59,6 +62,7 @@ void set_default_timetables(void)
 
     char *json_str;
     esp_err_t err;
+    esp_err_t result = ESP_OK;
 
     // Convert and store timetable 0
     json_str = timetable_to_json(&tt0);
@@ -68,10 +72,12 @@ void set_default_timetables(void)
             ESP_LOGI(TAG, "Stored default timetable 1 successfully.");
         } else {
             ESP_LOGE(TAG, "Failed to store default timetable 1: %s", esp_err_to_name(err));
+            result = err;
         }
         free(json_str);
     } else {
         ESP_LOGE(TAG, "Failed to generate JSON for default timetable 1.");
+        result = ESP_ERR_NO_MEM;
     }
 
 
@@ -83,10 +89,12 @@ void set_default_timetables(void)
             ESP_LOGI(TAG, "Stored default timetable 1 successfully.");
         } else {
             ESP_LOGE(TAG, "Failed to store default timetable 1: %s", esp_err_to_name(err));
+            result = err;
         }
         free(json_str);
     } else {
         ESP_LOGE(TAG, "Failed to generate JSON for default timetable 1.");
+        result = ESP_ERR_NO_MEM;
     }
 
     // Convert and store timetable 2
@@ -97,10 +105,12 @@ void set_default_timetables(void)
             ESP_LOGI(TAG, "Stored default timetable 2 successfully.");
         } else {
             ESP_LOGE(TAG, "Failed to store default timetable 2: %s", esp_err_to_name(err));
+            result = err;
         }
         free(json_str);
     } else {
         ESP_LOGE(TAG, "Failed to generate JSON for default timetable 2.");
+        result = ESP_ERR_NO_MEM;
     }
 
     // Convert and store timetable 3
@@ -111,11 +121,14 @@ void set_default_timetables(void)
             ESP_LOGI(TAG, "Stored default timetable 3 successfully.");
         } else {
             ESP_LOGE(TAG, "Failed to store default timetable 3: %s", esp_err_to_name(err));
+            result = err;
         }
         free(json_str);
     } else {
         ESP_LOGE(TAG, "Failed to generate JSON for default timetable 3.");
+        result = ESP_ERR_NO_MEM;
     }
+    return result;
 }
 
 /**
@@ -133,7 +146,7 @@ char *retrieve_timetable_json(int id)
     snprintf(key, sizeof(key), "TT%d", id);
 
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION,"Jtimetable", NVS_READONLY, &nvs_handle);
+    esp_err_t err = storage_open("Jtimetable", NVS_READONLY, &nvs_handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error opening NVS namespace 'Jtimetable': %s", esp_err_to_name(err));
         return NULL;
@@ -143,18 +156,18 @@ char *retrieve_timetable_json(int id)
     err = nvs_get_str(nvs_handle, key, NULL, &required_size);
     if (err == ESP_ERR_NVS_NOT_FOUND) {
         ESP_LOGW(TAG, "Timetable with key %s not found", key);
-        nvs_close(nvs_handle);
+        storage_close(nvs_handle);
         return NULL;
     } else if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error retrieving size for key %s: %s", key, esp_err_to_name(err));
-        nvs_close(nvs_handle);
+        storage_close(nvs_handle);
         return NULL;
     }
 
     char *json_str = malloc(required_size);
     if (!json_str) {
         ESP_LOGE(TAG, "Failed to allocate memory for timetable JSON");
-        nvs_close(nvs_handle);
+        storage_close(nvs_handle);
         return NULL;
     }
 
@@ -162,14 +175,38 @@ char *retrieve_timetable_json(int id)
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error reading timetable JSON for key %s: %s", key, esp_err_to_name(err));
         free(json_str);
-        nvs_close(nvs_handle);
+        storage_close(nvs_handle);
         return NULL;
     }
 
-    nvs_close(nvs_handle);
+    storage_close(nvs_handle);
     return json_str;
 }
 
+/**
+ * @brief Load a timetable from NVS and parse it into a timetable_t.
+ *
+ * Most callers should use cache_get_timetable(), which keeps decoded
+ * timetables in RAM and only calls this on a cache miss.
+ *
+ * @param id        The timetable ID.
+ * @param timetable Pointer to the timetable_t to fill.
+ * @return ESP_OK on success, ESP_ERR_NVS_NOT_FOUND if missing, ESP_ERR_INVALID_ARG if it does not parse.
+ */
+esp_err_t load_timetable(int id, timetable_t *timetable)
+{
+    if (!timetable) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    char *json_str = retrieve_timetable_json(id);
+    if (json_str == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    bool res = parse_timetable_json(json_str, timetable);
+    free(json_str);
+    return res ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
 /**
  * @brief Retrieve and log a timetable stored in NVS.
  *
@@ -206,7 +243,7 @@ esp_err_t store_timetable_json(const char *json_str, bool override_timetable)
 {
     const char *TAG = "TT_NVS";
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open_from_partition(NVS_PARTITION,"Jtimetable", NVS_READWRITE, &nvs_handle);
+    esp_err_t err = storage_open("Jtimetable", NVS_READWRITE, &nvs_handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error opening NVS namespace 'Jtimetable': %s", esp_err_to_name(err));
         return err;
@@ -216,7 +253,7 @@ esp_err_t store_timetable_json(const char *json_str, bool override_timetable)
     timetable_t timetable;
     if (!parse_timetable_json(json_str, &timetable)) {
         ESP_LOGE(TAG, "Failed to parse timetable JSON.");
-        nvs_close(nvs_handle);
+        storage_close(nvs_handle);
         return ESP_ERR_INVALID_ARG;
     }
 
@@ -231,40 +268,124 @@ esp_err_t store_timetable_json(const char *json_str, bool override_timetable)
         // Key exists.
         if (!override_timetable) {
             ESP_LOGW(TAG, "Key %s already exists and override is disabled.", key);
-            nvs_close(nvs_handle);
+            storage_close(nvs_handle);
             return ESP_ERR_NVS_INVALID_STATE;
         }
     } else if (err != ESP_ERR_NVS_NOT_FOUND) {
         ESP_LOGE(TAG, "Error checking for key %s: %s", key, esp_err_to_name(err));
-        nvs_close(nvs_handle);
+        storage_close(nvs_handle);
         return err;
     }
 
-    // Write the JSON string under the key.
-    err = nvs_set_str(nvs_handle, key, json_str);
+    // Write the JSON string under the key, unless the same content is already stored.
+    bool written = false;
+    err = storage_set_str_if_changed(nvs_handle, key, json_str, &written);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error writing JSON to NVS under key %s: %s", key, esp_err_to_name(err));
-        nvs_close(nvs_handle);
+        storage_close(nvs_handle);
         return err;
     }
+    if (!written) {
+        ESP_LOGI(TAG, "Timetable under key %s is unchanged, write skipped", key);
+        storage_close(nvs_handle);
+        return ESP_OK;
+    }
 
     // Commit the change.
-    err = nvs_commit(nvs_handle);
+    err = storage_commit(nvs_handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error committing NVS changes for key %s: %s", key, esp_err_to_name(err));
     } else {
         ESP_LOGI(TAG, "Successfully stored timetable under key %s", key);
     }
+    cache_invalidate_timetable(timetable.ID);
 
-    nvs_close(nvs_handle);
+    storage_close(nvs_handle);
+    if (err == ESP_OK) {
+        storage_notify_change(STORAGE_CHANGE_TIMETABLE, timetable.ID);
+    }
     return err;
 }
 
+/**
+ * @brief Decodes one element of "Times_active" (an object with Start_time and End_time).
+ */
+static bool parse_timeslot(json_stream_t *js, timeslot_t *slot)
+{
+    if (json_stream_peek(js) != JSON_STREAM_OBJECT) {
+        return false;
+    }
+    json_stream_object_begin(js);
+    bool have_start = false, have_end = false, have_days = false;
+    char key[JSON_STREAM_KEY_MAX];
+    int value;
+    slot->Days = TIMETABLE_EVERY_DAY;
+    while (json_stream_next_key(js, key, sizeof(key))) {
+        if (!have_start && json_stream_key_equals(key, "Start_time")) {
+            have_start = true;
+            if (json_stream_peek(js) != JSON_STREAM_NUMBER || !json_stream_read_int(js, &value)) {
+                return false;
+            }
+            slot->Start_time = (uint16_t)value;
+        } else if (!have_end && json_stream_key_equals(key, "End_time")) {
+            have_end = true;
+            if (json_stream_peek(js) != JSON_STREAM_NUMBER || !json_stream_read_int(js, &value)) {
+                return false;
+            }
+            slot->End_time = (uint16_t)value;
+        } else if (!have_days && json_stream_key_equals(key, "Days")) {
+            have_days = true;
+            if (json_stream_peek(js) != JSON_STREAM_NUMBER || !json_stream_read_int(js, &value)) {
+                return false;
+            }
+            slot->Days = (uint8_t)(value & 0x7F);
+        } else {
+            json_stream_skip(js);
+        }
+    }
+    return !js->error && have_start && have_end;
+}
+
+/**
+ * @brief Decodes one element of "Exceptions" (an object with Date and optional Active).
+ */
+static bool parse_exception(json_stream_t *js, timetable_exception_t *exception)
+{
+    if (json_stream_peek(js) != JSON_STREAM_OBJECT) {
+        return false;
+    }
+    json_stream_object_begin(js);
+    bool have_date = false, have_active = false;
+    char key[JSON_STREAM_KEY_MAX];
+    int value;
+    exception->Active = 0;
+    while (json_stream_next_key(js, key, sizeof(key))) {
+        if (!have_date && json_stream_key_equals(key, "Date")) {
+            have_date = true;
+            if (json_stream_peek(js) != JSON_STREAM_NUMBER || !json_stream_read_int(js, &value)) {
+                return false;
+            }
+            exception->Date = (uint32_t)value;
+        } else if (!have_active && json_stream_key_equals(key, "Active")) {
+            have_active = true;
+            if (json_stream_peek(js) != JSON_STREAM_NUMBER || !json_stream_read_int(js, &value)) {
+                return false;
+            }
+            exception->Active = value != 0;
+        } else {
+            json_stream_skip(js);
+        }
+    }
+    return !js->error && have_date;
+}
+
 /**
  * @brief Parse a timetable JSON string and fill the timetable structure.
  *
  * This function parses a JSON text representing a timetable configuration and
  * stores the values in a timetable_t struct. On error, it logs the reason and returns false.
+ * The text is decoded in one pass with json_stream, without heap allocation; the rules
+ * are the same as in the cJSON version, parse_timetable_json_dom in host/json_dom.c.
  *
  * @param json_str The JSON string.
  * @param timetable Pointer to the timetable_t struct to fill.
@@ -280,87 +401,172 @@ bool parse_timetable_json(const char *json_str, timetable_t *timetable)
         return false;
     }
 
-    // Parse the JSON string.
-    cJSON *root = cJSON_Parse(json_str);
-    if (!root) {
+    json_stream_t js;
+    json_stream_init(&js, json_str);
+    if (!json_stream_object_begin(&js)) {
         ESP_LOGE(TAG, "Failed to parse JSON string");
         return false;
     }
 
-    // Get the "Type" field.
-    cJSON *type = cJSON_GetObjectItem(root, "Type");
-    if (cJSON_IsNumber(type))
-        timetable->Type = (uint8_t)type->valueint;
-    else {
+    enum { SEEN_TYPE = 1, SEEN_NAME = 2, SEEN_ID = 4, SEEN_TIMES = 8, SEEN_EXCEPTIONS = 16 };
+    uint8_t seen = 0;
+    char key[JSON_STREAM_KEY_MAX];
+    int value;
+    timetable->exception_count = 0;
+
+    while (json_stream_next_key(&js, key, sizeof(key))) {
+        if (!(seen & SEEN_TYPE) && json_stream_key_equals(key, "Type")) {
+            seen |= SEEN_TYPE;
+            if (json_stream_peek(&js) != JSON_STREAM_NUMBER || !json_stream_read_int(&js, &value)) {
+                ESP_LOGE(TAG, "Invalid or missing 'Type' field in JSON");
+                return false;
+            }
+            timetable->Type = (uint8_t)value;
+        } else if (!(seen & SEEN_NAME) && json_stream_key_equals(key, "Name")) {
+            seen |= SEEN_NAME;
+            if (json_stream_peek(&js) != JSON_STREAM_STRING ||
+                !json_stream_read_string(&js, timetable->Name, sizeof(timetable->Name))) {
+                ESP_LOGE(TAG, "Invalid or missing 'Name' field in JSON");
+                return false;
+            }
+        } else if (!(seen & SEEN_ID) && json_stream_key_equals(key, "ID")) {
+            seen |= SEEN_ID;
+            if (json_stream_peek(&js) != JSON_STREAM_NUMBER || !json_stream_read_int(&js, &value)) {
+                ESP_LOGE(TAG, "Invalid or missing 'ID' field in JSON");
+                return false;
+            }
+            timetable->ID = (uint8_t)value;
+        } else if (!(seen & SEEN_TIMES) && json_stream_key_equals(key, "Times_active")) {
+            seen |= SEEN_TIMES;
+            if (json_stream_peek(&js) != JSON_STREAM_ARRAY) {
+                ESP_LOGE(TAG, "Invalid or missing 'Times_active' array in JSON");
+                return false;
+            }
+            // Timeslots beyond MAX_TIMESLOTS are dropped
+            json_stream_array_begin(&js);
+            int count = 0;
+            while (json_stream_next_element(&js)) {
+                if (count >= MAX_TIMESLOTS) {
+                    json_stream_skip(&js);
+                } else if (!parse_timeslot(&js, &timetable->Times_active[count])) {
+                    ESP_LOGE(TAG, "Invalid or missing 'Start_time' or 'End_time' in timeslot %d", count);
+                    return false;
+                }
+                count++;
+            }
+            timetable->times_count = (uint8_t)(count > MAX_TIMESLOTS ? MAX_TIMESLOTS : count);
+        } else if (!(seen & SEEN_EXCEPTIONS) && json_stream_key_equals(key, "Exceptions")) {
+            // Optional; exceptions beyond MAX_TIMETABLE_EXCEPTIONS are dropped
+            seen |= SEEN_EXCEPTIONS;
+            if (json_stream_peek(&js) != JSON_STREAM_ARRAY) {
+                ESP_LOGE(TAG, "Invalid 'Exceptions' array in JSON");
+                return false;
+            }
+            json_stream_array_begin(&js);
+            int count = 0;
+            while (json_stream_next_element(&js)) {
+                if (count >= MAX_TIMETABLE_EXCEPTIONS) {
+                    json_stream_skip(&js);
+                } else if (!parse_exception(&js, &timetable->Exceptions[count])) {
+                    ESP_LOGE(TAG, "Invalid or missing 'Date' in exception %d", count);
+                    return false;
+                }
+                count++;
+            }
+            timetable->exception_count = (uint8_t)(count > MAX_TIMETABLE_EXCEPTIONS ? MAX_TIMETABLE_EXCEPTIONS : count);
+        } else {
+            json_stream_skip(&js);
+        }
+    }
+    if (js.error) {
+        ESP_LOGE(TAG, "Failed to parse JSON string");
+        return false;
+    }
+    if (!(seen & SEEN_TYPE)) {
         ESP_LOGE(TAG, "Invalid or missing 'Type' field in JSON");
-        cJSON_Delete(root);
         return false;
     }
-
-    // Get the "Name" field.
-    cJSON *name = cJSON_GetObjectItem(root, "Name");
-    if (cJSON_IsString(name)) {
-        strncpy(timetable->Name, name->valuestring, MAX_NAME_LEN);
-        timetable->Name[MAX_NAME_LEN] = '\0';  // Ensure null termination.
-    } else {
+    if (!(seen & SEEN_NAME)) {
         ESP_LOGE(TAG, "Invalid or missing 'Name' field in JSON");
-        cJSON_Delete(root);
         return false;
     }
-
-    // Get the "ID" field.
-    cJSON *id = cJSON_GetObjectItem(root, "ID");
-    if (cJSON_IsNumber(id))
-        timetable->ID = (uint8_t)id->valueint;
-    else {
+    if (!(seen & SEEN_ID)) {
         ESP_LOGE(TAG, "Invalid or missing 'ID' field in JSON");
-        cJSON_Delete(root);
         return false;
     }
-
-    // Get the "Times_active" array.
-    cJSON *times_active = cJSON_GetObjectItem(root, "Times_active");
-    if (cJSON_IsArray(times_active)) {
-        int slot_count = cJSON_GetArraySize(times_active);
-        if (slot_count > MAX_TIMESLOTS)
-            slot_count = MAX_TIMESLOTS;
-        timetable->times_count = (uint8_t)slot_count;
-
-        // Iterate through each timeslot object.
-        for (int i = 0; i < slot_count; i++) {
-            cJSON *slot = cJSON_GetArrayItem(times_active, i);
-            if (slot) {
-                cJSON *start_time = cJSON_GetObjectItem(slot, "Start_time");
-                cJSON *end_time = cJSON_GetObjectItem(slot, "End_time");
-                if (cJSON_IsNumber(start_time) && cJSON_IsNumber(end_time)) {
-                    timetable->Times_active[i].Start_time = (uint16_t)start_time->valueint;
-                    timetable->Times_active[i].End_time = (uint16_t)end_time->valueint;
-                } else {
-                    ESP_LOGE(TAG, "Invalid or missing 'Start_time' or 'End_time' in timeslot %d", i);
-                    cJSON_Delete(root);
-                    return false;
-                }
-            } else {
-                ESP_LOGE(TAG, "Missing timeslot at index %d", i);
-                cJSON_Delete(root);
-                return false;
-            }
-        }
-    } else {
+    if (!(seen & SEEN_TIMES)) {
         ESP_LOGE(TAG, "Invalid or missing 'Times_active' array in JSON");
-        cJSON_Delete(root);
         return false;
     }
-
-    cJSON_Delete(root);
     return true;
 }
 
+/**
+ * @brief Write the JSON representation of a timetable to a json_writer.
+ *
+ * Produces the same text cJSON_PrintUnformatted did for the old cJSON tree,
+ * so fingerprints of stored timetables stay valid. "Days" and "Exceptions" are
+ * only written when set, so daily timetables keep their old text.
+ */
+void timetable_write_json(json_writer_t *w, const timetable_t *timetable)
+{
+    json_write_object_begin(w);
+    json_write_key(w, "Type");
+    json_write_int(w, timetable->Type);
+    json_write_key(w, "Name");
+    json_write_string(w, timetable->Name);
+    json_write_key(w, "ID");
+    json_write_int(w, timetable->ID);
+
+    json_write_key(w, "Times_active");
+    json_write_array_begin(w);
+    for (int i = 0; i < timetable->times_count && i < MAX_TIMESLOTS; i++) {
+        json_write_object_begin(w);
+        json_write_key(w, "Start_time");
+        json_write_int(w, timetable->Times_active[i].Start_time);
+        json_write_key(w, "End_time");
+        json_write_int(w, timetable->Times_active[i].End_time);
+        if (timetable->Times_active[i].Days != TIMETABLE_EVERY_DAY) {
+            json_write_key(w, "Days");
+            json_write_int(w, timetable->Times_active[i].Days);
+        }
+        json_write_object_end(w);
+    }
+    json_write_array_end(w);
+    if (timetable->exception_count > 0) {
+        json_write_key(w, "Exceptions");
+        json_write_array_begin(w);
+        for (int i = 0; i < timetable->exception_count && i < MAX_TIMETABLE_EXCEPTIONS; i++) {
+            json_write_object_begin(w);
+            json_write_key(w, "Date");
+            json_write_int(w, (int)timetable->Exceptions[i].Date);
+            json_write_key(w, "Active");
+            json_write_int(w, timetable->Exceptions[i].Active);
+            json_write_object_end(w);
+        }
+        json_write_array_end(w);
+    }
+    json_write_object_end(w);
+}
+
+/**
+ * @brief Serialize a timetable into a caller buffer (snprintf semantics).
+ *
+ * @return Length of the full JSON text. Call with buf = NULL to get the exact size.
+ */
+size_t timetable_to_json_buf(const timetable_t *timetable, char *buf, size_t size)
+{
+    json_writer_t w;
+    json_writer_init_buffer(&w, buf, size);
+    timetable_write_json(&w, timetable);
+    return json_writer_finish(&w);
+}
+
 /**
  * @brief Convert a timetable structure to its JSON representation.
  *
- * This function creates a JSON string from the given timetable_t struct.
- * The returned string must be freed by the caller using free().
+ * This function creates a JSON string from the given timetable_t struct, using one
+ * allocation of the exact size. The returned string must be freed by the caller using free().
  *
  * @param timetable Pointer to the timetable_t struct.
  * @return char* JSON string on success, or NULL on failure.
@@ -373,70 +579,264 @@ char *timetable_to_json(const timetable_t *timetable)
         return NULL;
     }
 
-    cJSON *root = cJSON_CreateObject();
-    if (!root) {
-        ESP_LOGE(TAG, "Failed to create JSON root object");
+    size_t len = timetable_to_json_buf(timetable, NULL, 0);
+    char *json_str = malloc(len + 1);
+    if (!json_str) {
+        ESP_LOGE(TAG, "Failed to allocate %u bytes for timetable JSON", (unsigned)(len + 1));
         return NULL;
     }
+    timetable_to_json_buf(timetable, json_str, len + 1);
+    return json_str;
+}
 
-    // Add fields to JSON.
-    if (!cJSON_AddNumberToObject(root, "Type", timetable->Type)) {
-        ESP_LOGE(TAG, "Failed to add 'Type' to JSON");
-        cJSON_Delete(root);
-        return NULL;
+/**
+ * @brief First minute of the day whose HHMM value is >= hhmm.
+ *
+ * Matches the HHMM integer comparisons exactly, also for values with minutes
+ * above 59 (1175 behaves like 1200).
+ */
+static int hhmm_ceil_minute(uint16_t hhmm)
+{
+    int minute = (hhmm / 100) * 60 + ((hhmm % 100) < 60 ? hhmm % 100 : 60);
+    return minute < TIMETABLE_MINUTES_PER_DAY ? minute : TIMETABLE_MINUTES_PER_DAY;
+}
+
+/**
+ * @brief Sets bits [from, to) of the mask.
+ */
+static void mask_set_range(timetable_mask_t *mask, int from, int to)
+{
+    while (from < to) {
+        int word = from / 32;
+        int bit = from % 32;
+        int count = (to - from < 32 - bit) ? to - from : 32 - bit;
+        uint32_t bits = (count == 32) ? UINT32_MAX : ((1u << count) - 1u);
+        mask->bits[word] |= bits << bit;
+        from += count;
     }
+}
 
-    if (!cJSON_AddStringToObject(root, "Name", timetable->Name)) {
-        ESP_LOGE(TAG, "Failed to add 'Name' to JSON");
-        cJSON_Delete(root);
-        return NULL;
+/**
+ * @brief Index of the first bit in [from, to) that differs from state, or -1.
+ */
+static int mask_find_flip(const timetable_mask_t *mask, int from, int to, bool state)
+{
+    uint32_t invert = state ? UINT32_MAX : 0;
+    while (from < to) {
+        int word = from / 32;
+        uint32_t bits = (mask->bits[word] ^ invert) & (UINT32_MAX << (from % 32));
+        if (bits != 0) {
+            int found = word * 32 + __builtin_ctz(bits);
+            return found < to ? found : -1;
+        }
+        from = (word + 1) * 32;
     }
+    return -1;
+}
 
-    if (!cJSON_AddNumberToObject(root, "ID", timetable->ID)) {
-        ESP_LOGE(TAG, "Failed to add 'ID' to JSON");
-        cJSON_Delete(root);
-        return NULL;
+static inline bool slot_runs_on(const timeslot_t *slot, int wday)
+{
+    return slot->Days == TIMETABLE_EVERY_DAY || ((slot->Days >> wday) & 1u);
+}
+
+/**
+ * @brief Builds the minute mask of one weekday (0 = Sunday).
+ *
+ * Slots that start on the day cover [Start, End) or, for overnight slots, [Start, 24:00);
+ * overnight slots that started the day before contribute their [00:00, End) tail.
+ */
+static void compile_weekday_mask(const timetable_t *timetable, int wday, timetable_mask_t *mask)
+{
+    memset(mask, 0, sizeof(*mask));
+    int prev_wday = (wday + 6) % 7;
+    int count = timetable->times_count < MAX_TIMESLOTS ? timetable->times_count : MAX_TIMESLOTS;
+    for (int i = 0; i < count; i++) {
+        const timeslot_t *slot = &timetable->Times_active[i];
+        int start = hhmm_ceil_minute(slot->Start_time);
+        int end = hhmm_ceil_minute(slot->End_time);
+        if (start <= end) {
+            if (slot_runs_on(slot, wday)) {
+                mask_set_range(mask, start, end);
+            }
+        } else {
+            if (slot_runs_on(slot, wday)) {
+                mask_set_range(mask, start, TIMETABLE_MINUTES_PER_DAY);
+            }
+            if (slot_runs_on(slot, prev_wday)) {
+                mask_set_range(mask, 0, end);
+            }
+        }
     }
+}
 
-    // Create and add the "Times_active" array.
-    cJSON *times_active = cJSON_CreateArray();
-    if (!times_active) {
-        ESP_LOGE(TAG, "Failed to create 'Times_active' array");
-        cJSON_Delete(root);
-        return NULL;
+/**
+ * @brief Compiles a timetable into its weekly schedule.
+ *
+ * Each weekday is rendered into a minute mask and the state changes are collected
+ * with a word-wise find-first-set scan, so the edge list
+ * comes out sorted and merged (adjacent or overlapping slots leave no edge behind).
+ */
+void timetable_compile_schedule(const timetable_t *timetable, timetable_schedule_t *schedule)
+{
+    memset(schedule, 0, sizeof(*schedule));
+    timetable_mask_t mask;
+    bool state = false;
+    for (int wday = 0; wday < 7; wday++) {
+        compile_weekday_mask(timetable, wday, &mask);
+        int from = 0;
+        if (wday == 0) {
+            state = schedule->initial = timetable_mask_test(&mask, 0);
+            from = 1;
+        }
+        int found;
+        while ((found = mask_find_flip(&mask, from, TIMETABLE_MINUTES_PER_DAY, state)) >= 0 &&
+               schedule->edge_count < TIMETABLE_MAX_EDGES) {
+            schedule->edges[schedule->edge_count++] = (uint16_t)(wday * TIMETABLE_MINUTES_PER_DAY + found);
+            state = !state;
+            from = found + 1;
+        }
     }
-    cJSON_AddItemToObject(root, "Times_active", times_active);
+    schedule->exception_count = timetable->exception_count < MAX_TIMETABLE_EXCEPTIONS ?
+                                timetable->exception_count : MAX_TIMETABLE_EXCEPTIONS;
+    memcpy(schedule->exceptions, timetable->Exceptions,
+           schedule->exception_count * sizeof(timetable_exception_t));
+}
 
-    for (int i = 0; i < timetable->times_count; i++) {
-        cJSON *slot = cJSON_CreateObject();
-        if (!slot) {
-            ESP_LOGE(TAG, "Failed to create timeslot object at index %d", i);
-            cJSON_Delete(root);
-            return NULL;
+static inline int minute_of_week(const struct tm *local)
+{
+    return local->tm_wday * TIMETABLE_MINUTES_PER_DAY + local->tm_hour * 60 + local->tm_min;
+}
+
+/**
+ * @brief Number of edges <= minute (binary search).
+ */
+static int edges_up_to(const timetable_schedule_t *schedule, int minute)
+{
+    int lo = 0, hi = schedule->edge_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (schedule->edges[mid] <= minute) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
-        cJSON_AddItemToArray(times_active, slot);
+    }
+    return lo;
+}
 
-        if (!cJSON_AddNumberToObject(slot, "Start_time", timetable->Times_active[i].Start_time)) {
-            ESP_LOGE(TAG, "Failed to add 'Start_time' for timeslot %d", i);
-            cJSON_Delete(root);
-            return NULL;
+/**
+ * @brief Minutes from minute of the week until the weekly state next changes, or -1.
+ */
+static int weekly_next_change(const timetable_schedule_t *schedule, int minute)
+{
+    int idx = edges_up_to(schedule, minute);
+    if (idx < schedule->edge_count) {
+        return schedule->edges[idx] - minute;
+    }
+    if (schedule->edge_count % 2 != 0) {
+        // The week ends in the opposite state of Sunday 00:00.
+        return TIMETABLE_MINUTES_PER_WEEK - minute;
+    }
+    if (schedule->edge_count > 0) {
+        return schedule->edges[0] + TIMETABLE_MINUTES_PER_WEEK - minute;
+    }
+    return -1;
+}
+
+/**
+ * @brief Looks up the exception for the local date, if any.
+ */
+static const timetable_exception_t *find_exception(const timetable_schedule_t *schedule, const struct tm *local)
+{
+    uint32_t date = (uint32_t)(local->tm_year + 1900) * 10000u + (uint32_t)(local->tm_mon + 1) * 100u + (uint32_t)local->tm_mday;
+    for (int i = 0; i < schedule->exception_count; i++) {
+        if (schedule->exceptions[i].Date == date) {
+            return &schedule->exceptions[i];
         }
+    }
+    return NULL;
+}
 
-        if (!cJSON_AddNumberToObject(slot, "End_time", timetable->Times_active[i].End_time)) {
-            ESP_LOGE(TAG, "Failed to add 'End_time' for timeslot %d", i);
-            cJSON_Delete(root);
-            return NULL;
+bool timetable_schedule_is_active(const timetable_schedule_t *schedule, const struct tm *local)
+{
+    if (schedule->exception_count > 0) {
+        const timetable_exception_t *exception = find_exception(schedule, local);
+        if (exception != NULL) {
+            return exception->Active;
         }
     }
+    return schedule->initial ^ (edges_up_to(schedule, minute_of_week(local)) & 1);
+}
 
-    // Convert the cJSON object to a string.
-    char *json_str = cJSON_PrintUnformatted(root);
-    if (!json_str) {
-        ESP_LOGE(TAG, "Failed to print JSON string");
-        cJSON_Delete(root);
-        return NULL;
+/**
+ * @brief Local wall-clock time the given number of minutes after the minute of local.
+ *
+ * Goes through mktime() so that a DST switch in between moves the result by the
+ * offset change; a wall time that repeats at the end of DST resolves to its first
+ * occurrence after t.
+ */
+static time_t local_minutes_after(time_t t, const struct tm *local, int minutes)
+{
+    struct tm target = *local;
+    target.tm_sec = 0;
+    target.tm_min += minutes;
+    target.tm_isdst = -1;
+    time_t result = mktime(&target);
+    if (result <= t) {
+        target = *local;
+        target.tm_sec = 0;
+        target.tm_min += minutes;
+        target.tm_isdst = 0;
+        result = mktime(&target);
+    }
+    if (result == (time_t)-1 || result <= t) {
+        result = t - local->tm_sec + (time_t)minutes * 60;
     }
+    return result;
+}
 
-    cJSON_Delete(root);
-    return json_str;
-}
\ No newline at end of file
+/**
+ * @brief Next state change after t.
+ *
+ * Without exceptions this is one weekly lookup. With exceptions, the midnights that
+ * start and end each exception date are candidates as well, and candidates that turn out not
+ * to change the state are skipped; the walk is bounded, so the result is at worst an
+ * early (harmless) re-evaluation point.
+ */
+time_t timetable_schedule_next_change(const timetable_schedule_t *schedule, time_t t, const struct tm *local)
+{
+    bool state = timetable_schedule_is_active(schedule, local);
+    time_t cursor = t;
+    struct tm cursor_tm = *local;
+    time_t candidate = TIMETABLE_NO_CHANGE;
+    for (int step = 0; step < 2 * MAX_TIMETABLE_EXCEPTIONS + 2; step++) {
+        candidate = TIMETABLE_NO_CHANGE;
+        int minutes = weekly_next_change(schedule, minute_of_week(&cursor_tm));
+        if (minutes >= 0) {
+            candidate = local_minutes_after(cursor, &cursor_tm, minutes);
+        }
+        for (int i = 0; i < schedule->exception_count; i++) {
+            // The exception date starts and ends at local midnight.
+            uint32_t date = schedule->exceptions[i].Date;
+            struct tm day_tm = { .tm_year = (int)(date / 10000) - 1900, .tm_mon = (int)(date / 100 % 100) - 1,
+                                 .tm_mday = (int)(date % 100), .tm_isdst = -1 };
+            for (int bound = 0; bound < 2; bound++) {
+                struct tm midnight_tm = day_tm;
+                midnight_tm.tm_mday += bound;
+                time_t midnight = mktime(&midnight_tm);
+                if (midnight > cursor && (candidate == TIMETABLE_NO_CHANGE || midnight < candidate)) {
+                    candidate = midnight;
+                }
+            }
+        }
+        if (candidate == TIMETABLE_NO_CHANGE) {
+            return TIMETABLE_NO_CHANGE;
+        }
+        localtime_r(&candidate, &cursor_tm);
+        if (timetable_schedule_is_active(schedule, &cursor_tm) != state) {
+            return candidate;
+        }
+        cursor = candidate;
+    }
+    return candidate;
+}
@@ -3,32 +3,97 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <time.h>
+#include "esp_err.h"
+#include "json_writer.h"
 
 #define MAX_TIMESLOTS 8
 #define MAX_NAME_LEN 32
 
+#define MAX_TIMETABLE_EXCEPTIONS 4
+#define TIMETABLE_EVERY_DAY 0  // Days value of a slot that applies to all weekdays
+
 typedef struct {
-    uint16_t Start_time;  // values 0–2400
+    uint16_t Start_time;  // values 0–2400; Start_time > End_time runs past midnight
     uint16_t End_time;
+    uint8_t Days;         // weekdays the slot starts on, bit 0 = Sunday (tm_wday); 0 = every day
 } timeslot_t;
 
+// A calendar date on which the timetable is forced on or off for the whole day.
+typedef struct {
+    uint32_t Date;        // YYYYMMDD, local time
+    uint8_t Active;
+} timetable_exception_t;
+
 typedef struct {
     uint8_t Type;  // less than 256
     char Name[MAX_NAME_LEN + 1]; // plus null terminator
     uint8_t ID;
     uint8_t times_count;  // number of active times in Times_active
     timeslot_t Times_active[MAX_TIMESLOTS];
+    uint8_t exception_count;
+    timetable_exception_t Exceptions[MAX_TIMETABLE_EXCEPTIONS];
 } timetable_t;
 
-void set_default_timetables(void);
+#define TIMETABLE_MINUTES_PER_DAY 1440
+#define TIMETABLE_MASK_WORDS ((TIMETABLE_MINUTES_PER_DAY + 31) / 32)
+
+#define TIMETABLE_MINUTES_PER_WEEK (7 * TIMETABLE_MINUTES_PER_DAY)
+// Each slot adds at most two state changes per day, overnight slots included.
+#define TIMETABLE_MAX_EDGES (MAX_TIMESLOTS * 7 * 2)
+#define TIMETABLE_NO_CHANGE ((time_t)-1)
+
+// One day of a timetable compiled to one bit per minute (bit set = active).
+// Building block of timetable_schedule_t.
+typedef struct {
+    uint32_t bits[TIMETABLE_MASK_WORDS];
+} timetable_mask_t;
+
+/*
+ * A timetable compiled to its weekly recurrence: the sorted minutes of the week
+ * (0 = Sunday 00:00) at which it switches between active and inactive, plus the
+ * date exceptions. Answers is_active and next_change with a binary search.
+ */
+typedef struct {
+    bool initial;                              // state at Sunday 00:00
+    uint8_t exception_count;
+    uint16_t edge_count;
+    uint16_t edges[TIMETABLE_MAX_EDGES];       // ascending, never 0
+    timetable_exception_t exceptions[MAX_TIMETABLE_EXCEPTIONS];
+} timetable_schedule_t;
+
+esp_err_t set_default_timetables(void);
 char *retrieve_timetable_json(int id);
+// Loads timetable "TT<ID>" from NVS and parses it into timetable.
+// Returns ESP_ERR_NVS_NOT_FOUND if the timetable does not exist.
+esp_err_t load_timetable(int id, timetable_t *timetable);
 void log_timetable(int id);
 
 esp_err_t store_timetable_json(const char *json_str, bool override_timetable);
 
+// Streaming decoder, no heap allocation.
 bool parse_timetable_json(const char *json_str, timetable_t *timetable);
 
+// Converts a timetable to a JSON string (one allocation of the exact size), caller frees.
 char *timetable_to_json(const timetable_t *timetable);
+// Writes the timetable JSON into buf with snprintf semantics and returns the full length.
+// With buf = NULL nothing is written and the exact length is returned.
+size_t timetable_to_json_buf(const timetable_t *timetable, char *buf, size_t size);
+// Writes the timetable JSON to any json_writer (buffer or chunked sink).
+void timetable_write_json(json_writer_t *w, const timetable_t *timetable);
+
+// Whether minute (0..1439) of a compiled day mask is active.
+static inline bool timetable_mask_test(const timetable_mask_t *mask, int minute)
+{
+    return (mask->bits[minute / 32] >> (minute % 32)) & 1u;
+}
 
+// Compiles weekday masks, overnight slots and date exceptions into a weekly schedule.
+void timetable_compile_schedule(const timetable_t *timetable, timetable_schedule_t *schedule);
+// Whether the schedule is active at the given local time.
+bool timetable_schedule_is_active(const timetable_schedule_t *schedule, const struct tm *local);
+// First minute start after t (local time local) at which the state differs from the
+// state at t, or TIMETABLE_NO_CHANGE if it never changes.
+time_t timetable_schedule_next_change(const timetable_schedule_t *schedule, time_t t, const struct tm *local);
 
 #endif // TIMETABLE_H
\ No newline at end of file
@@ -9,11 +9,13 @@
 
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 
 #include "ulp_main.h"
 #include "display.h"
+#include "display_compositor.h"
 #include "rfid.h"
 #include "json_parser.h"
 #include "nvs_config.h"
@@ -22,6 +24,7 @@
 #include "led.h"
 #include "buttons.h"
 #include "alarm_execution.h"
+#include "clock_service.h"
 
 #define INTERUPT_PIN_LP 0
 #define BUTTON1_PIN_LP 4
@@ -48,8 +51,6 @@ QueueHandle_t interruptQueue;
 QueueHandle_t buttonControlQueue; //queue for button control commands
 QueueHandle_t chirpQueue; //queue for chirp commands - based on play_chirp function
 uint8_t button_control_active = 0; //flag for button - commands will be sent into the queue, only if this flag is set
-//DISPLAY MUTEX
-SemaphoreHandle_t display_mutex = NULL;
 
 TaskHandle_t wifiTimeSyncTaskHandle = NULL;
 TaskHandle_t rfid_tag_recieved_task_handle = NULL;
@@ -99,51 +100,48 @@ void init_ulp_program_and_gpio(void)
 /**
  * @brief Task created when a PICC is detected.
  *
- * This task retrieves the task associated with the given RFID key from NVS,
- * parses the task JSON into a task_t structure, and displays it. THen it listens for user input.
+ * This task loads the task record associated with the given RFID key from NVS
+ * and displays it. THen it listens for user input.
  *
- * The RFID key is expected to be the key in NVS where the task JSON is stored.
+ * The raw UID is looked up in the RAM-resident RFID index to find the task ID.
  *
- * @param param Pointer to a string containing the RFID key.
+ * @param param Pointer to a heap copy of the card's rc522_picc_uid_t, freed by this task.
  */
 void task_RFID_tag_recieved(void *param)
 {
-    char *rfid_key = (char *)param;
+    rc522_picc_uid_t *rfid_uid = (rc522_picc_uid_t *)param;
     int reminder_id = 0;
     bool exit_task = false;
-    int task_id = get_task_id_by_rfid(rfid_key);
+    int task_id = get_task_id_by_rfid_uid(rfid_uid->value, rfid_uid->length);
+    free(rfid_uid);  // free the copy made in the event handler
     if (task_id < 0)
     {
         ESP_LOGE(TAG, "No task ID found for RFID key");
+        rfid_tag_recieved_task_handle = NULL;
         vTaskDelete(NULL);
         return;
     }
-    char *task_json = retrieve_task_json(task_id);
-    free(rfid_key);  // free the copy made in the event handler
 
-    if (task_json != NULL)
+    task_t task_buffer;
+    esp_err_t load_err = load_task(task_id, &task_buffer);
+    if (load_err != ESP_ERR_NVS_NOT_FOUND)
     {
-        task_t task_buffer;
         type1_reminder_t reminder_buffer;
-        if (!parse_task_json(task_json, &task_buffer))
+        if (load_err != ESP_OK)
         {
-            ESP_LOGE(TAG, "Failed to parse task JSON for RFID key");
+            ESP_LOGE(TAG, "Failed to load task record for RFID key");
         }
         else
         {
-            ESP_LOGI(TAG, "RFID task parsed successfully - loading display");
+            ESP_LOGI(TAG, "RFID task loaded successfully - loading display");
             if (task_buffer.Type == 1)
             {
-                //take mutex
-                if(xSemaphoreTake(display_mutex, 2000/portTICK_PERIOD_MS)){
-                    uint8_t wifi_status = get_wifi_status();
-                    uint8_t time_status = get_time_validity();
-                    // Assuming wifi_status and time_status as 0 for "OK"
-                    if(u8g2_ptr != NULL) {
-                        display_task_type1(wifi_status, time_status, &task_buffer, *u8g2_ptr);
-                    } else {
-                        ESP_LOGE(TAG, "Display is not initialized");
-                    }
+                //post the options screen; it covers a running notification until removed
+                display_content_t content = { .layout = DISPLAY_LAYOUT_TASK, .selected = -1 };
+                for (int i = 0; i < TASK_MAX_OPTIONS; i++) {
+                    snprintf(content.lines[i], DISPLAY_LINE_LEN, "%s", task_buffer.Options[i].display_text);
+                }
+                if(display_show(DISPLAY_SCREEN_TASK, DISPLAY_PRIORITY_USER, 0, &content) == ESP_OK){
                     // Wait for user input
                     //clear button queue
                     button_control_t button_control;
@@ -158,8 +156,6 @@ void task_RFID_tag_recieved(void *param)
                     if (xQueueReceive(buttonControlQueue, &button_control, xTicksToWait) == pdTRUE)
                     {
                         ESP_LOGI(TAG, "Button %d pressed with command %d", button_control.button_id, button_control.command);
-                        wifi_status = get_wifi_status();
-                        time_status = get_time_validity();
                         switch (button_control.command) {
                             case 1:
                                 ESP_LOGI(TAG, "Button %d short press while in task display mode", button_control.button_id);
@@ -170,8 +166,7 @@ void task_RFID_tag_recieved(void *param)
                                 {
                                     ESP_LOGI(TAG, "Reminder stored with option %d successfully with ID %d",reminder_buffer.Task_Option_Selected, reminder_id);
                                     SEND_CHIRP(chirpQueue, 1);
-                                    display_message(u8g2_ptr,get_wifi_status(),get_time_validity(),"","reminder stored", "succesfully","",1);
-                                    vTaskDelay(2000 / portTICK_PERIOD_MS);
+                                    display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS, "", "reminder stored", "succesfully", "");
                                     //get_reminder_by_id(reminder_id, &reminder_buffer);
                                     //log_type1_reminder(&reminder_buffer);
                                 }
@@ -183,7 +178,7 @@ void task_RFID_tag_recieved(void *param)
                                     //display message
                                     if (reminder_id == -1)
                                     {
-                                        display_message(u8g2_ptr, wifi_status, time_status, "Reminder exists", "long press but1", "to add another", "", 1);
+                                        display_show_message(DISPLAY_SCREEN_TASK, DISPLAY_PRIORITY_USER, 0, "Reminder exists", "long press but1", "to add another", "");
                                         // Wait for user input
                                         if (xQueueReceive(buttonControlQueue, &button_control, xTicksToWait) == pdTRUE)
                                         {
@@ -199,14 +194,12 @@ void task_RFID_tag_recieved(void *param)
                                                     SEND_CHIRP(chirpQueue, 1);
                                                     //get_reminder_by_id(reminder_id, &reminder_buffer);
                                                     //log_type1_reminder(&reminder_buffer);
-                                                    display_message(u8g2_ptr,get_wifi_status(),get_time_validity(),"","reminder stored", "succesfully","",1);
-                                                    vTaskDelay(2000 / portTICK_PERIOD_MS);
+                                                    display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS, "", "reminder stored", "succesfully", "");
                                                 }
                                                 else
                                                 {
                                                     ESP_LOGE(TAG, "Failed to store reminder");
-                                                    display_message(u8g2_ptr, wifi_status, time_status, "Failed to store", "reminder", "", "", 1);
-                                                    vTaskDelay(2000 / portTICK_PERIOD_MS);
+                                                    display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS, "Failed to store", "reminder", "", "");
                                                 }
                                             }
                                             else if (button_control.command == 100)
@@ -219,8 +212,7 @@ void task_RFID_tag_recieved(void *param)
                                         }
                                     }
                                     else{
-                                    display_message(u8g2_ptr, wifi_status, time_status, "Failed to store", "reminder", "", "", 1);
-                                    vTaskDelay(2000 / portTICK_PERIOD_MS);
+                                    display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS, "Failed to store", "reminder", "", "");
                                     }
                                 }
 
@@ -228,7 +220,7 @@ void task_RFID_tag_recieved(void *param)
                             case 2:
                                 ESP_LOGI(TAG, "Button %d long press while in task display mode" , button_control.button_id);
                                 uint8_t additional_option = 0;
-                                display_message(u8g2_ptr, wifi_status, time_status,"Reminder options:", "Press button X", "to set reminder",  "with value of butt.X", 1);
+                                display_show_message(DISPLAY_SCREEN_TASK, DISPLAY_PRIORITY_USER, 0, "Reminder options:", "Press button X", "to set reminder",  "with value of butt.X");
                                 //LONG PRESS MEANS ADITIONAL OPTIONS MENU - SHOW ADITIONAL OPTIONS MENU
                                 if (xQueueReceive(buttonControlQueue, &button_control, xTicksToWait) == pdTRUE)
                                 {
@@ -275,8 +267,7 @@ void task_RFID_tag_recieved(void *param)
                                     {
                                         ESP_LOGI(TAG, "Reminder stored with option %d, additonal option %d | successfully with ID %d",reminder_buffer.Task_Option_Selected,reminder_buffer.Task_Additional_Option_Selected, reminder_id);
                                         SEND_CHIRP(chirpQueue, 1);
-                                        display_message(u8g2_ptr,get_wifi_status(),get_time_validity(),"","reminder stored", "succesfully","",1);
-                                        vTaskDelay(2000 / portTICK_PERIOD_MS);
+                                        display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS, "", "reminder stored", "succesfully", "");
 
                                         //get_reminder_by_id(reminder_id, &reminder_buffer);
                                         //log_type1_reminder(&reminder_buffer);
@@ -284,13 +275,10 @@ void task_RFID_tag_recieved(void *param)
                                     else
                                     {
                                         ESP_LOGE(TAG, "Failed to store reminder");
-                                        //get wifi status and time status
-                                        wifi_status = get_wifi_status();
-                                        time_status = get_time_validity();
                                         //display message
                                         if (reminder_id == -1)
                                         {
-                                            display_message(u8g2_ptr, wifi_status, time_status, "Reminder exists", "long press but1", "to add another", "", 1);
+                                            display_show_message(DISPLAY_SCREEN_TASK, DISPLAY_PRIORITY_USER, 0, "Reminder exists", "long press but1", "to add another", "");
                                             // Wait for user input
                                             if (xQueueReceive(buttonControlQueue, &button_control, xTicksToWait) == pdTRUE)
                                             {
@@ -304,16 +292,14 @@ void task_RFID_tag_recieved(void *param)
                                                     {
                                                         ESP_LOGI(TAG, "Reminder stored with option %d successfully with ID %d",reminder_buffer.Task_Option_Selected, reminder_id);
                                                         SEND_CHIRP(chirpQueue, 1);
-                                                        display_message(u8g2_ptr,get_wifi_status(),get_time_validity(),"","reminder stored", "succesfully","",1);
-                                                        vTaskDelay(2000 / portTICK_PERIOD_MS);
+                                                        display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS, "", "reminder stored", "succesfully", "");
                                                         //get_reminder_by_id(reminder_id, &reminder_buffer);
                                                         //log_type1_reminder(&reminder_buffer);
                                                     }
                                                     else
                                                     {
                                                         ESP_LOGE(TAG, "Failed to store reminder");
-                                                        display_message(u8g2_ptr, wifi_status, time_status, "Failed to store", "reminder", "", "", 1);
-                                                        vTaskDelay(2000 / portTICK_PERIOD_MS);
+                                                        display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS, "Failed to store", "reminder", "", "");
                                                     }
                                                 }
                                                 else if (button_control.command == 100)
@@ -326,8 +312,7 @@ void task_RFID_tag_recieved(void *param)
                                             }
                                         }
                                         else{
-                                        display_message(u8g2_ptr, wifi_status, time_status, "Failed to store", "reminder", "", "", 1);
-                                        vTaskDelay(2000 / portTICK_PERIOD_MS);
+                                        display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS, "Failed to store", "reminder", "", "");
                                         }
                                     }
                                 }
@@ -345,13 +330,13 @@ void task_RFID_tag_recieved(void *param)
                         ESP_LOGI(TAG, "No button press detected during task display mode == timeout");
                     }
 
-                    //give mutex
-                    xSemaphoreGive(display_mutex);
+                    //take the task screen down; a confirmation stays for its own time
+                    display_remove(DISPLAY_SCREEN_TASK);
                     button_control_active = 0;
                 }
                 else
                 {
-                    ESP_LOGW(TAG, "RFID_TASK-Failed to take display mutex");
+                    ESP_LOGW(TAG, "RFID_TASK-Failed to post the task screen");
                 }
 
 
@@ -361,11 +346,10 @@ void task_RFID_tag_recieved(void *param)
                 ESP_LOGI(TAG, "Task is not type 1, not displayed");
             }
         }
-        free(task_json);
     }
     else
     {
-        ESP_LOGE(TAG, "No task JSON retrieved for RFID key");
+        ESP_LOGE(TAG, "No task record found for RFID key");
     }
     ESP_LOGI(TAG, "RFID task task_RFID_tag_recieved finished");
     rfid_tag_recieved_task_handle = NULL;
@@ -427,13 +411,15 @@ void on_RFID_state_changed(void *arg, esp_event_base_t base, int32_t event_id, v
             ESP_LOGE(TAG, "Failed to convert UID to string");
             return;
         }
-        //use buffer as a key for the task directly
-        char *rfid_key = strdup(buffer);
-        if (rfid_key == NULL)
+        ESP_LOGI(TAG, "UID: %s", buffer);
+        //pass a copy of the raw UID to the task, it is looked up in the RFID index
+        rc522_picc_uid_t *rfid_uid = malloc(sizeof(rc522_picc_uid_t));
+        if (rfid_uid == NULL)
         {
             ESP_LOGE(TAG, "Failed to allocate memory for RFID key");
             return;
         }
+        *rfid_uid = picc->uid;
         SEND_CHIRP(chirpQueue, 5);
         //if there is a task already running, delete it
         if (rfid_tag_recieved_task_handle != NULL)
@@ -442,7 +428,7 @@ void on_RFID_state_changed(void *arg, esp_event_base_t base, int32_t event_id, v
             shutdown_rfid_tag_recieved_task(rfid_tag_recieved_task_handle);
         }
         vTaskDelay(20 / portTICK_PERIOD_MS);
-        xTaskCreate(task_RFID_tag_recieved, "task_RFID_tag_recieved", 4096, rfid_key, 1, &rfid_tag_recieved_task_handle);
+        xTaskCreate(task_RFID_tag_recieved, "task_RFID_tag_recieved", 4096, rfid_uid, 1, &rfid_tag_recieved_task_handle);
 
 
 
@@ -470,8 +456,10 @@ void task_update_tick(void *params)
     {
         // Wait until the next cycle.
         vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        // Publishes minute and day rollovers (time validity, idle clock date).
+        clock_service_tick();
 
-        // Update the display
+        // Restart the time sync when needed (the compositor draws the status bar)
         wifi_status = get_wifi_status();
         time_status = get_time_validity();
         if(time_status == 1)
@@ -516,23 +504,6 @@ void task_update_tick(void *params)
             }
 
         }
-        //take mutex
-       if(xSemaphoreTake(display_mutex, 10/portTICK_PERIOD_MS)){
-            if (u8g2_ptr != NULL)
-            {
-                display_idle_clock_screen(&u8g2, wifi_status, time_status);
-            }
-            else
-            {
-                ESP_LOGE(TAG, "Display is not initialized");
-            }
-            //release mutex
-            xSemaphoreGive(display_mutex);
-        }
-        else
-        {
-            ESP_LOGW(TAG, "UPDATE_TASK-Failed to take display mutex");
-        }
     }
 }
 
@@ -551,7 +522,8 @@ void task_update_tick(void *params)
        Button 1: Down
        Button 2: Confirm (enter detail view)
        Button 3: Back (exit detail view or exit the menu)
-   - Uses the buttonControlQueue. Takes the display_mutex before drawing.
+   - Uses the buttonControlQueue. Shows the MENU screen on the display compositor,
+     posting it again only when its content changed.
 */
 void task_show_running_reminders_menu(void *params)
 {
@@ -563,207 +535,205 @@ void task_show_running_reminders_menu(void *params)
     button_control_t btn;
     // Set the button control active flag to 1 to allow button control commands.
     button_control_active = 1;
-    uint8_t wifi_status = 0, time_status = 0; // Example status values
-    // Wait for the display mutex. and hold it for the duration of the task.
-    if(xSemaphoreTake(display_mutex, 1000/portTICK_PERIOD_MS)) {
-
-        while (1) {
-            // Get the current number of reminders.
-            size_t total = get_num_of_reminders();
-            // Allocate an array to hold the reminders, if any.
-            type1_reminder_t *reminders = NULL;
-            if (total > 0) {
-                reminders = malloc(total * sizeof(type1_reminder_t));
-                if (reminders) {
-                    total = get_all_type1_reminders(reminders, total);
-                } else {
-                    ESP_LOGE(TAG_RM, "Memory allocation failed for reminders");
-                    total = 0;
-                }
+    display_content_t content, shown_content;
+    bool shown = false;
+
+    while (1) {
+        // Get the current number of reminders.
+        size_t total = get_num_of_reminders();
+        // Allocate an array to hold the reminders, if any.
+        type1_reminder_t *reminders = NULL;
+        if (total > 0) {
+            reminders = malloc(total * sizeof(type1_reminder_t));
+            if (reminders) {
+                total = get_all_type1_reminders(reminders, total);
+            } else {
+                ESP_LOGE(TAG_RM, "Memory allocation failed for reminders");
+                total = 0;
             }
+        }
 
-            // Ensure current_index is within bounds.
-            if (total == 0) {
-                current_index = 0;
-            } else if (current_index >= (int)total) {
-                current_index = total - 1;
-            }
+        // Ensure current_index is within bounds.
+        if (total == 0) {
+            current_index = 0;
+        } else if (current_index >= (int)total) {
+            current_index = total - 1;
+        }
 
-            // Draw the menu.
-            u8g2_ClearBuffer(u8g2_ptr);
-            wifi_status = get_wifi_status();
-            time_status = get_time_validity();
-            render_top_info_bar(u8g2_ptr, wifi_status, time_status);
+        // Build the menu.
+        bool have_content = true;
+        if (!detail_mode) {
+            // List mode: show up to 4 reminders per page.
+            //if 0 reminders, display message
+            if (total == 0) {
+                display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS,
+                                     "No reminders", "", "", "");
+                // Free the reminders array.
+                if (reminders) {
+                    free(reminders);
+                    reminders = NULL;
+                }
+                vTaskDelay(2000 / portTICK_PERIOD_MS);
+                ESP_LOGI(TAG_RM, "Exiting reminders menu.");
+                button_control_active = 0;
+                display_remove(DISPLAY_SCREEN_MENU);
+                vTaskDelete(NULL);
 
-            if (!detail_mode) {
-                // List mode: show up to 4 reminders per page.
-                //if 0 reminders, display message
-                if (total == 0) {
-                    display_message(u8g2_ptr, wifi_status, time_status, "No reminders", "", "", "", 1);
-                    u8g2_SendBuffer(u8g2_ptr);
-                    // Free the reminders array.
-                    if (reminders) {
-                        free(reminders);
-                        reminders = NULL;
+            }
+            page_start = (current_index / items_per_page) * items_per_page;
+            content = (display_content_t){ .layout = DISPLAY_LAYOUT_LIST, .selected = -1 };
+            for (int row = 0; row < items_per_page; row++) {
+                int idx = page_start + row;
+                if (idx < (int)total && reminders != NULL) {
+                    task_t task;
+                    const char *opt_text = "N/A";
+                    if (cache_get_task(reminders[idx].Task_ID, &task) == ESP_OK &&
+                        reminders[idx].Task_Option_Selected < TASK_MAX_OPTIONS) {
+                        opt_text = task.Options[reminders[idx].Task_Option_Selected].display_text;
                     }
-                    vTaskDelay(2000 / portTICK_PERIOD_MS);
-                    ESP_LOGI(TAG_RM, "Exiting reminders menu.");
-                    button_control_active = 0;
-                    xSemaphoreGive(display_mutex);
-                    vTaskDelete(NULL);
-
+                    snprintf(content.lines[row], DISPLAY_LINE_LEN, "%d: %s", reminders[idx].Reminder_ID, opt_text);
                 }
-                page_start = (current_index / items_per_page) * items_per_page;
-                for (int row = 0; row < items_per_page; row++) {
-                    int idx = page_start + row;
-                    char buf[40] = "";
-                    int y;
-                    if (idx < (int)total && reminders != NULL) {
-                        task_t *task = get_task_by_id(reminders[idx].Task_ID);
-                        const char *opt_text = "N/A";
-                        if (task != NULL) {
-                            opt_text = task->Options[reminders[idx].Task_Option_Selected].display_text;
-                            free(task);
-                        }
-                        snprintf(buf, sizeof(buf), "%d: %s", reminders[idx].Reminder_ID, opt_text);
-                    }
-                    // Set vertical position.
-                    switch (row) {
-                        case 0: y = 22; break;
-                        case 1: y = 35; break;
-                        case 2: y = 47; break;
-                        case 3: y = 59; break;
-                        default: y = 22; break;
-                    }
-                    // Highlight current selection.
-                    if (idx == current_index && idx < (int)total) {
-                        u8g2_SetDrawColor(u8g2_ptr, 1);
-                        u8g2_DrawBox(u8g2_ptr, 0, y - 9, u8g2_GetDisplayWidth(u8g2_ptr), 12);
-                        u8g2_SetDrawColor(u8g2_ptr, 0);
-                        u8g2_DrawStr(u8g2_ptr, 2, y, buf);
-                        u8g2_SetDrawColor(u8g2_ptr, 1);
+                // Highlight current selection.
+                if (idx == current_index && idx < (int)total) {
+                    content.selected = row;
+                }
+            }
+        } else {
+            // Detail mode: show details for the selected reminder.
+            if (current_index < (int)total && reminders != NULL) {
+                type1_reminder_t *rem = &reminders[current_index];
+                task_t task_buffer;
+                task_t *task = NULL;
+                const char *opt_text = "N/A";
+                if (cache_get_task(rem->Task_ID, &task_buffer) == ESP_OK &&
+                    rem->Task_Option_Selected < TASK_MAX_OPTIONS) {
+                    task = &task_buffer;
+                    opt_text = task->Options[rem->Task_Option_Selected].display_text;
+                }
+                char line1[64], line2[64], line3[64], line4[64];
+                snprintf(line1, sizeof(line1), "%s", opt_text);
+                snprintf(line2, sizeof(line2), "Additional Opt: %d", rem->Task_Additional_Option_Selected);
+                char date_str[32];
+                {
+                    struct tm tm_buf;
+                    struct tm *tm_info = clock_service_localtime(rem->Time_Created, &tm_buf);
+                    if (tm_info) {
+                        snprintf(date_str, sizeof(date_str), "%02d,%02d,%04d", tm_info->tm_mday, tm_info->tm_mon + 1, tm_info->tm_year + 1900);
                     } else {
-                        u8g2_DrawStr(u8g2_ptr, 2, y, buf);
+                        strncpy(date_str, "00,00,0000", sizeof(date_str));
                     }
                 }
-                u8g2_SendBuffer(u8g2_ptr);
-            } else {
-                // Detail mode: show details for the selected reminder.
-                if (current_index < (int)total && reminders != NULL) {
-                    type1_reminder_t *rem = &reminders[current_index];
-                    task_t *task = get_task_by_id(rem->Task_ID);
-                    const char *opt_text = "N/A";
-                    if (task != NULL) {
-                        opt_text = task->Options[rem->Task_Option_Selected].display_text;
-                        free(task);
-                    }
-                    char line1[64], line2[64], line3[64], line4[64];
-                    snprintf(line1, sizeof(line1), "%s", opt_text);
-                    snprintf(line2, sizeof(line2), "Additional Opt: %d", rem->Task_Additional_Option_Selected);
-                    char date_str[32];
-                    {
-                        struct tm *tm_info = localtime(&rem->Time_Created);
-                        if (tm_info) {
-                            snprintf(date_str, sizeof(date_str), "%02d,%02d,%04d", tm_info->tm_mday, tm_info->tm_mon + 1, tm_info->tm_year + 1900);
-                        } else {
-                            strncpy(date_str, "00,00,0000", sizeof(date_str));
-                        }
-                    }
-                    snprintf(line3, sizeof(line3), "Date: %s", date_str);
-                    //dispoly timeslot ids in line 4
-                    if(task->Options[rem->Task_Option_Selected].timeslot_count > 0) {
-                        strcpy(line4, "Slots: ");
-                        char buf[10];
-                        for (int i = 0; i < task->Options[rem->Task_Option_Selected].timeslot_count; i++) {
-                            snprintf(buf, sizeof(buf), "%d ", task->Options[rem->Task_Option_Selected].timeslots[i]);
-                            strcat(line4, buf);
-                        }
-                    } else {
-                        strcpy(line4, "No timeslots");
+                snprintf(line3, sizeof(line3), "Date: %s", date_str);
+                //dispoly timeslot ids in line 4
+                if(task != NULL && task->Options[rem->Task_Option_Selected].timeslot_count > 0) {
+                    strcpy(line4, "Slots: ");
+                    char buf[10];
+                    for (int i = 0; i < task->Options[rem->Task_Option_Selected].timeslot_count; i++) {
+                        snprintf(buf, sizeof(buf), "%d ", task->Options[rem->Task_Option_Selected].timeslots[i]);
+                        strcat(line4, buf);
                     }
+                } else {
+                    strcpy(line4, "No timeslots");
+                }
 
 
-                    // Truncate each line to a maximum of 23 characters.
-                    if(strlen(line1) > 23) line1[23] = '\0';
-                    if(strlen(line2) > 23) line2[23] = '\0';
-                    if(strlen(line3) > 23) line3[23] = '\0';
-                    if(strlen(line4) > 23) line4[23] = '\0';
+                // Truncate each line to a maximum of 23 characters.
+                if(strlen(line1) > 23) line1[23] = '\0';
+                if(strlen(line2) > 23) line2[23] = '\0';
+                if(strlen(line3) > 23) line3[23] = '\0';
+                if(strlen(line4) > 23) line4[23] = '\0';
 
 
-                    display_message(u8g2_ptr, wifi_status, time_status, line1, line2, line3, line4, 1);
-                }
+                display_content_message(&content, line1, line2, line3, line4, true);
+            } else {
+                have_content = false;
+            }
+        }
+        // Post the screen only when it changed; the compositor redraws it by itself.
+        if (have_content && (!shown || memcmp(&content, &shown_content, sizeof(content)) != 0)) {
+            if (display_show(DISPLAY_SCREEN_MENU, DISPLAY_PRIORITY_USER, 0, &content) == ESP_OK) {
+                shown_content = content;
+                shown = true;
             }
+        }
 
 
 
 
 
-            // Wait for button input.
-            if (xQueueReceive(buttonControlQueue, &btn, pdMS_TO_TICKS(250)) == pdTRUE) {
-                if (!detail_mode) {
-                    // List mode navigation.
-                    switch (btn.button_id) {
-                        case 0: // Confirm - enter detail view.
-                            if (btn.command == 1){
-                                detail_mode = true;
-                            }
-                            break;
-                        case 1: // Up
-                            if (current_index > 0)
-                                current_index--;
-                            break;
-                        case 2: // Down
-                            if (current_index < 0) current_index = 0;
-                            if (current_index < (int)get_num_of_reminders() - 1)
-                                current_index++;
-                            break;
-                        case 3: // Back - exit menu task.
-                            ESP_LOGI(TAG_RM, "Exiting reminders menu.");
-                            button_control_active = 0;
-                            xSemaphoreGive(display_mutex);
-                            vTaskDelete(NULL);
-                            break;
-                        default:
-                            break;
-                    }
-                } else {
-                    // Detail mode navigation.
-                    // If button 0 long press, delete current reminder.
-                    if (btn.button_id == 0 && btn.command == 2) {
-                        esp_err_t del_err = delete_reminder(reminders[current_index].Reminder_ID);
-                        if (del_err == ESP_OK) {
-                            ESP_LOGI(TAG_RM, "Deleted reminder %d", reminders[current_index].Reminder_ID);
-                            SEND_CHIRP(chirpQueue,2);
-                            display_message(u8g2_ptr, wifi_status, time_status, "Reminder deleted", "", "", "", 1);
-                            vTaskDelay(2000 / portTICK_PERIOD_MS);
-                            if (current_index > 0) current_index--;
-                        } else {
-                            ESP_LOGE(TAG_RM, "Failed to delete reminder %d", reminders[current_index].Reminder_ID);
-                            display_message(u8g2_ptr, wifi_status, time_status, "Delete failed", "", "", "", 1);
-                            vTaskDelay(2000 / portTICK_PERIOD_MS);
+        // Wait for button input.
+        if (xQueueReceive(buttonControlQueue, &btn, pdMS_TO_TICKS(250)) == pdTRUE) {
+            if (!detail_mode) {
+                // List mode navigation.
+                switch (btn.button_id) {
+                    case 0: // Confirm - enter detail view.
+                        if (btn.command == 1){
+                            detail_mode = true;
                         }
-                        detail_mode = false; // exit detail view after deletion
-                    }
-                    // In detail mode, Back returns to list mode.
-                    else if (btn.button_id == 3) {
-                        detail_mode = false;
+                        break;
+                    case 1: // Up
+                        if (current_index > 0)
+                            current_index--;
+                        break;
+                    case 2: // Down
+                        if (current_index < 0) current_index = 0;
+                        if (current_index < (int)get_num_of_reminders() - 1)
+                            current_index++;
+                        break;
+                    case 3: // Back - exit menu task.
+                        ESP_LOGI(TAG_RM, "Exiting reminders menu.");
+                        button_control_active = 0;
+                        display_remove(DISPLAY_SCREEN_MENU);
+                        vTaskDelete(NULL);
+                        break;
+                    default:
+                        break;
+                }
+            } else {
+                // Detail mode navigation.
+                // If button 0 long press, delete current reminder.
+                if (btn.button_id == 0 && btn.command == 2) {
+                    esp_err_t del_err = delete_reminder(reminders[current_index].Reminder_ID);
+                    if (del_err == ESP_OK) {
+                        ESP_LOGI(TAG_RM, "Deleted reminder %d", reminders[current_index].Reminder_ID);
+                        SEND_CHIRP(chirpQueue,2);
+                        display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS,
+                                             "Reminder deleted", "", "", "");
+                        vTaskDelay(2000 / portTICK_PERIOD_MS);
+                        if (current_index > 0) current_index--;
+                    } else {
+                        ESP_LOGE(TAG_RM, "Failed to delete reminder %d", reminders[current_index].Reminder_ID);
+                        display_show_message(DISPLAY_SCREEN_MESSAGE, DISPLAY_PRIORITY_MESSAGE, DISPLAY_MESSAGE_MS,
+                                             "Delete failed", "", "", "");
+                        vTaskDelay(2000 / portTICK_PERIOD_MS);
                     }
+                    detail_mode = false; // exit detail view after deletion
+                }
+                // In detail mode, Back returns to list mode.
+                else if (btn.button_id == 3) {
+                    detail_mode = false;
                 }
-            }
-            // Free the reminders array.
-            if (reminders) {
-                free(reminders);
-                reminders = NULL;
             }
         }
-
-    }
-    else
-    {
-        ESP_LOGW(TAG_RM, "REMINDER_MENU_TASK-Failed to take display mutex");
+        // Free the reminders array.
+        if (reminders) {
+            free(reminders);
+            reminders = NULL;
+        }
     }
 }
 
+/*
+   Task: task_snooze_notification
+   Quick action of button 1. While a reminder notification is pending (on screen or
+   covered by another screen), snoozes the reminders it shows; otherwise does nothing.
+*/
+void task_snooze_notification(void *params)
+{
+    alarm_execution_snooze();
+    vTaskDelete(NULL);
+}
+
 void app_main(void)
 {
     //FOR TESTING
@@ -774,11 +744,10 @@ void app_main(void)
 
     interruptQueue = xQueueCreate(10, sizeof(int));
     buttonControlQueue = xQueueCreate(10, sizeof(button_control_t));
-    display_mutex = xSemaphoreCreateMutex();
     chirpQueue = xQueueCreate(10, sizeof(uint8_t));
     u8g2_ptr = &u8g2;
 
-    init_buttons(buttonControlQueue, task_show_running_reminders_menu, NULL, NULL, NULL);
+    init_buttons(buttonControlQueue, task_show_running_reminders_menu, task_snooze_notification, NULL, NULL);
     init_ulp_program_and_gpio();
     buzzer_init();
     init_led();
@@ -790,11 +759,13 @@ void app_main(void)
         ESP_LOGE(TAG, "Failed to initialize custom NVS partition: %s", esp_err_to_name(err));
         return;
     }
+    rfid_map_init(); //loads the RFID UID-to-task index into RAM
 
 
 
 
     init_ssd1306_display(&u8g2);
+    display_compositor_start(&u8g2); //the only task drawing from here on
     rfid_setup(on_RFID_state_changed);
 
 
@@ -804,19 +775,43 @@ void app_main(void)
 
 
 
-    set_default_timetables();
-    //log_timetable(1);
-    //log_timetable(2);
-    //log_timetable(3);
-    //log_timetable(0);
-
-    set_default_tasks();
+    //store defaults once per DEFAULTS_GENERATION, in one storage session - one commit per namespace;
+    //the generation is recorded after the session committed, in a commit of its own
+    int64_t provisioning_start = esp_timer_get_time();
+    if (storage_provisioning_needed(DEFAULTS_GENERATION))
+    {
+        storage_session_begin();
+        esp_err_t timetables_err = set_default_timetables();
+        //log_timetable(1);
+        //log_timetable(2);
+        //log_timetable(3);
+        //log_timetable(0);
+
+        esp_err_t tasks_err = set_default_tasks();
+        esp_err_t commit_err = storage_session_end();
+        esp_err_t err = timetables_err != ESP_OK ? timetables_err : tasks_err != ESP_OK ? tasks_err : commit_err;
+        // record the generation only once all defaults are committed, so a failure is retried on the next boot
+        if (err == ESP_OK)
+        {
+            err = storage_set_provisioned(DEFAULTS_GENERATION);
+        }
+        if (err != ESP_OK)
+        {
+            ESP_LOGE(TAG, "Storing the defaults failed (%s), generation %d not recorded", esp_err_to_name(err),
+                     DEFAULTS_GENERATION);
+        }
+    }
+    else
+    {
+        ESP_LOGI(TAG, "Defaults generation %d already provisioned", DEFAULTS_GENERATION);
+    }
+    ESP_LOGI(TAG, "Default provisioning took %lld us", esp_timer_get_time() - provisioning_start);
     //log_task(1);
     //log_task(2);
     //log_task(3);
 
     //alarm execution init
-    alarm_execution_init(chirpQueue,display_mutex,u8g2_ptr);
+    alarm_execution_init(chirpQueue);
     uint8_t led_value = 255;
     while (false)
     {
@@ -3,4 +3,8 @@
 
 #define NVS_PARTITION "MyNvs"
 
+// Bump whenever set_default_tasks()/set_default_timetables() change,
+// so the new defaults are written on the next boot.
+#define DEFAULTS_GENERATION 1
+
 #endif // CONFIG_H
\ No newline at end of file
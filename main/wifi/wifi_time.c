@@ -1,10 +1,14 @@
 #include "wifi_time.h"
+#include "clock_service.h"
 
 static esp_netif_t *esp_netif;
 
 // Global variable storing the last successful time sync (UNIX timestamp)
 static time_t last_time_sync = 0;
 
+// get_time_validity() result, recomputed on every minute tick and clock change.
+static volatile int time_validity = 1;
+
 // Global variable for WiFi status, initialized to "fail" until proven otherwise.
 static int wifi_status_var = WIFI_STATUS_DISCONNECTED_FAIL;
 // Flag to indicate if a connection was ever successful.
@@ -37,9 +41,25 @@ static void event_handler(void* arg, esp_event_base_t event_base,
     }
 }
 
+/**
+ * @brief Clock listener: recomputes the time validity once per minute and after a sync.
+ */
+static void on_clock_event(uint32_t events, const struct tm *local, void *ctx)
+{
+    time_t now = time(NULL);
+    //if year is less than 1990, time is not set
+    if (local->tm_year < 90) {
+        time_validity = 1;
+    } else {
+        time_validity = difftime(now, last_time_sync) < (TIME_VALIDITY_MINUTES * 60) ? 0 : 1;
+    }
+}
+
 esp_err_t wifi_init()
 {
     setenv("TZ", TIMEZONE, 1);
+    tzset();
+    clock_service_subscribe(CLOCK_EVENT_MINUTE | CLOCK_EVENT_SET, on_clock_event, NULL);
     esp_err_t ret = esp_netif_init();
     if (ret != ESP_OK) return ret;
     ret = esp_event_loop_create_default();
@@ -140,6 +160,9 @@ void update_time_sync_timestamp(void)
 {
     last_time_sync = time(NULL);
     ESP_LOGI(TAG, "Time sync timestamp updated");
+    // Refreshes the cached local time and tells the subscribers (the time validity
+    // below, the alarm scheduler) that the wall clock may have jumped.
+    clock_service_time_set();
 }
 
 
@@ -227,22 +250,14 @@ cleanup:
  * @brief Check if the system time is valid.
  *
  * Returns 0 if the last time sync was less than TIME_VALIDITY_MINUTES old,
- * otherwise returns 1 indicating the time sync is outdated.
+ * otherwise returns 1 indicating the time sync is outdated. The value is
+ * recomputed by the clock service on every minute tick and after each sync.
  *
  * @return int 0 if valid, 1 if outdated.
  */
 int get_time_validity(void)
 {
-    time_t now = time(NULL);
-    double diff_secs = difftime(now, last_time_sync);
-    //if year is less than 2000, time is not set
-    if (localtime(&now)->tm_year < 90) {
-        return 1;  // Time sync is outdated
-    }
-    if (diff_secs < (TIME_VALIDITY_MINUTES * 60)) {
-        return 0;  // Time sync is valid
-    }
-    return 1;      // Time sync is outdated
+    return time_validity;
 }
 
 /* get_wifi_status():